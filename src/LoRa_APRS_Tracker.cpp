@@ -27,6 +27,14 @@ ________________________________________________________________________________
 #include "boards_pinout.h"
 #include "button_utils.h"
 #include "power_utils.h"
+#include "heap_utils.h"
+#include "boot_utils.h"
+#include "hal_utils.h"
+#include "digi_utils.h"
+#include "filter_utils.h"
+#include "tdma_utils.h"
+#include "afc_utils.h"
+#include "telemetry_utils.h"
 #include "sleep_utils.h"
 #include "menu_utils.h"
 #include "lora_utils.h"
@@ -35,6 +43,7 @@ ________________________________________________________________________________
 #include "gps_utils.h"
 #include "bme_utils.h"
 #include "web_utils.h"
+#include "perf_utils.h"
 #include "ble_utils.h"
 #include "display.h"
 #include "utils.h"
@@ -54,6 +63,8 @@ String      versionDate             = "2024.10.03";
 uint8_t     myBeaconsIndex          = 0;
 int         myBeaconsSize           = Config.beacons.size();
 Beacon      *currentBeacon          = &Config.beacons[myBeaconsIndex];
+uint8_t     checkedBeaconIndex      = 255;      // callsign last checked for NOCALL
+int         nocallSkips             = 0;
 uint8_t     loraIndex               = 0;
 int         loraIndexSize           = Config.loraTypes.size();
 LoraType    *currentLoRaType        = &Config.loraTypes[loraIndex];
@@ -108,34 +119,61 @@ void setup() {
     #endif
 
     POWER_Utils::setup();
-    displaySetup();
+    BOOT_Utils::mark(BOOT_POWER);
+    // A beacon-only wake takes indexes, counters and the last beacon from RTC memory and skips screen, WiFi and BT
+    bool deepSleepWake = SLEEP_Utils::restoreDeepSleepState();
+
+    // Nothing below waits on its own: storage and the GPS UART go first while the panel rails settle, the splash is
+    // held as an overlay and the BLE stack comes up on core 0 while radio, messages and sensor start here
+    if (!deepSleepWake) {
+        STATION_Utils::loadIndex(0);
+        STATION_Utils::loadIndex(1);
+    }
+    STATION_Utils::nearTrackerInit();
+    BOOT_Utils::mark(BOOT_STORAGE);
+    GPS_Utils::setup();
+    BOOT_Utils::mark(BOOT_GPS);
+
+    if (deepSleepWake) {
+        GPS_Utils::wakeFromBackup();
+        displayWakeSetup();
+        displayState = false;
+    } else {
+        displaySetup();
+    }
     POWER_Utils::externalPinSetup();
+    if (!deepSleepWake) startupScreen(loraIndex, versionDate);
+    BOOT_Utils::mark(BOOT_DISPLAY);
 
-    STATION_Utils::loadIndex(0);
-    STATION_Utils::loadIndex(1);
-    STATION_Utils::nearTrackerInit();
-    startupScreen(loraIndex, versionDate);
+    if (!deepSleepWake) WIFI_Utils::checkIfWiFiAP();
+    WiFi.mode(WIFI_OFF);
+    logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "WiFi controller stopped");
+    BOOT_Utils::mark(BOOT_WIFI);
 
-    WIFI_Utils::checkIfWiFiAP();
+    bool bleStarting = !deepSleepWake && (Config.bluetooth.type == 0 || Config.bluetooth.type == 2);
+    if (bleStarting) BLE_Utils::beginSetup();
 
-    MSG_Utils::loadNumMessages();
-    GPS_Utils::setup();
+    if (!deepSleepWake) MSG_Utils::loadNumMessages();
+    BOOT_Utils::mark(BOOT_MESSAGES);
     currentLoRaType = &Config.loraTypes[loraIndex];
+    if (!deepSleepWake) AFC_Utils::loadOffset();
     LoRa_Utils::setup();
+    BOOT_Utils::mark(BOOT_LORA);
     BME_Utils::setup();
+    BOOT_Utils::mark(BOOT_SENSOR);
+    FILTER_Utils::compile(Config.receiveFilter);
+    TDMA_Utils::setup();
     
-    ackRequestNumber = random(1,999);
-
-    WiFi.mode(WIFI_OFF);
-    logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "WiFi controller stopped");
+    if (!deepSleepWake) ackRequestNumber = random(1,999);
 
-    if (Config.bluetooth.type == 0 || Config.bluetooth.type == 2) {
-        BLE_Utils::setup();
-    } else {
+    if (bleStarting) {
+        BLE_Utils::waitSetup();
+    } else if (!deepSleepWake) {
         #ifdef HAS_BT_CLASSIC
             BLUETOOTH_Utils::setup();
         #endif
     }
+    BOOT_Utils::mark(BOOT_BLUETOOTH);
 
     if (!Config.simplifiedTrackerMode) {
         #ifdef BUTTON_PIN
@@ -147,40 +185,64 @@ void setup() {
         KEYBOARD_Utils::setup();
     }
 
-    POWER_Utils::lowerCpuFrequency();
+    POWER_Utils::setupGovernor();
     logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Smart Beacon is: %s", Utils::getSmartBeaconState());
+    BOOT_Utils::mark(BOOT_DONE);
+    BOOT_Utils::logTimeline();
     logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Main", "Setup Done!");
     menuDisplay = 0;
 }
 
+// Tasks: the radio (LoRa_Utils) and the GPS UART reader (GPS_Utils) run on core 0 and hand frames and NMEA
+// sentences to loop() through typed queues; the BLE stack has its own tasks. UI, Bluetooth bridging and
+// housekeeping still share this loop on core 1: none of them block for long once radio and GPS are out, and
+// splitting them means locking the display and the station/message state they all touch.
 void loop() {
+    PERF_BEGIN(PERF_LOOP);
+    Utils::checkLoopLatency();
     currentBeacon = &Config.beacons[myBeaconsIndex];
     if (statusState) {
-        if (Config.validateConfigFile(currentBeacon->callsign)) {
-            KEYBOARD_Utils::rightArrow();
-            currentBeacon = &Config.beacons[myBeaconsIndex];
+        if (myBeaconsIndex != checkedBeaconIndex) {     // once per callsign, the warning is an overlay and must settle
+            checkedBeaconIndex = myBeaconsIndex;
+            if (!Config.validateConfigFile(currentBeacon->callsign)) {
+                nocallSkips = 0;
+            } else if (nocallSkips < myBeaconsSize - 1) {
+                nocallSkips++;
+                KEYBOARD_Utils::rightArrow();
+                currentBeacon = &Config.beacons[myBeaconsIndex];
+            }
         }
         miceActive = Config.validateMicE(currentBeacon->micE);
     }
+    PERF_BEGIN(PERF_BATTERY);
     POWER_Utils::batteryManager();
+    PERF_END(PERF_BATTERY);
 
+    PERF_BEGIN(PERF_SMARTBEACON);
     SMARTBEACON_Utils::checkValues(myBeaconsIndex);
     SMARTBEACON_Utils::checkState();
+    PERF_END(PERF_SMARTBEACON);
 
     if (!Config.simplifiedTrackerMode) {
         #ifdef BUTTON_PIN
+            PERF_BEGIN(PERF_BUTTON);
             userButton.tick();
+            PERF_END(PERF_BUTTON);
         #endif
     }
 
     Utils::checkDisplayEcoMode();
 
+    PERF_BEGIN(PERF_KEYBOARD);
     KEYBOARD_Utils::read();
     #ifdef TTGO_T_DECK_GPS
         KEYBOARD_Utils::mouseRead();
     #endif
+    PERF_END(PERF_KEYBOARD);
 
+    PERF_BEGIN(PERF_LORA_RX);
     ReceivedLoRaPacket packet = LoRa_Utils::receivePacket();
+    PERF_END(PERF_LORA_RX);
 
     if (Config.bluetooth.type == 0 || Config.bluetooth.type == 2) {
         BLE_Utils::sendToPhone(packet.text.substring(3));
@@ -191,11 +253,19 @@ void loop() {
     }
 
     MSG_Utils::checkReceivedMessage(packet);
+    DIGI_Utils::checkPending();
+    PERF_BEGIN(PERF_MSG_TX);
     MSG_Utils::processOutputBuffer();
     MSG_Utils::clean25SegBuffer();
+    PERF_END(PERF_MSG_TX);
+    TELEMETRY_Utils::checkDefinitions();
     MSG_Utils::ledNotification();
     Utils::checkFlashlight();
+    BME_Utils::checkSampler();
+    PERF_BEGIN(PERF_STATIONS);
     STATION_Utils::checkListenedTrackersByTimeAndDelete();
+    PERF_END(PERF_STATIONS);
+    HEAP_Utils::checkHeap();
     if (Config.bluetooth.type == 0 || Config.bluetooth.type == 2) {
         BLE_Utils::sendToLoRa();
     } else {
@@ -203,12 +273,15 @@ void loop() {
             BLUETOOTH_Utils::sendToLoRa();
         #endif
     }
-    lastTx = millis() - lastTxTime;
+    lastTx = HAL::now() - lastTxTime;
     if (gpsIsActive) {
+        PERF_BEGIN(PERF_GPS);
         GPS_Utils::getData();
         bool gps_time_update = gps.time.isUpdated();
         bool gps_loc_update  = gps.location.isUpdated();
+        if (gps_time_update) TDMA_Utils::syncTime();
         GPS_Utils::setDateFromData();
+        PERF_END(PERF_GPS);
 
         int currentSpeed = (int) gps.speed.kmph();
 
@@ -224,23 +297,33 @@ void loop() {
             STATION_Utils::checkStandingUpdateTime();
         }
         SMARTBEACON_Utils::checkFixedBeaconTime();
-        if (sendUpdate && gps_loc_update) STATION_Utils::sendBeacon(0);
+        if (Config.tdma.active) {
+            // Slotted: a pending beacon waits for our slot and goes out with the last fix
+            if (sendUpdate && gps.location.isValid() && gps.location.age() < 2000 && TDMA_Utils::isMySlot()) STATION_Utils::sendBeacon(0);
+        } else {
+            if (sendUpdate && gps_loc_update) STATION_Utils::sendBeacon(0);
+        }
         if (gps_time_update) SMARTBEACON_Utils::checkInterval(currentSpeed);
 
-        if (millis() - refreshDisplayTime >= 1000 || gps_time_update) {
+        if (millis() - refreshDisplayTime >= 1000 || gps_time_update || displayOverlayExpired()) {
             GPS_Utils::checkStartUpFrames();
             MENU_Utils::showOnScreen();
             refreshDisplayTime = millis();
         }
         SLEEP_Utils::checkIfGPSShouldSleep();
     } else {
-        if (millis() - lastGPSTime > txInterval) {
+        if (HAL::now() - lastGPSTime > txInterval) {
             SLEEP_Utils::gpsWakeUp();
         }
+        SLEEP_Utils::wakeBy(lastGPSTime + txInterval);
         STATION_Utils::checkStandingUpdateTime();
-        if (millis() - refreshDisplayTime >= 1000) {
+        if (millis() - refreshDisplayTime >= 1000 || displayOverlayExpired()) {
             MENU_Utils::showOnScreen();
             refreshDisplayTime = millis();
         }
     }
+    if (displayState) SLEEP_Utils::wakeBy(refreshDisplayTime + 1000);
+    PERF_END(PERF_LOOP);        // wall clock from here on is sleep or the idle tick, not work
+    SLEEP_Utils::checkDeepSleep();
+    SLEEP_Utils::checkLightSleep();
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <logger.h>
+#include "configuration.h"
+#include "link_utils.h"
+#include "hal_utils.h"
+#include "lora_utils.h"
+#include "afc_utils.h"
+
+
+extern Configuration        Config;
+extern LoraType             *currentLoRaType;
+extern logging::Logger      logger;
+
+struct AfcSample {
+    uint32_t    station;
+    int         freqError;
+};
+
+AfcSample   afcSamples[AFC_SAMPLES];
+uint8_t     afcSampleCount          = 0;
+uint8_t     afcSampleIndex          = 0;
+int32_t     afcOffsetPpb            = 0;        // our oscillator correction, parts per billion of the carrier
+int         afcLastMedian           = 0;
+uint32_t    afcUpdates              = 0;
+
+
+namespace AFC_Utils {
+
+    static int32_t getMaxOffsetPpb() {
+        return (int32_t)((int64_t)Config.afc.maxCorrection * 1000000000 / currentLoRaType->frequency);
+    }
+
+    static void saveOffset() {
+        if (HAL::writeLine("/afcOffset.txt", String(afcOffsetPpb))) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "AFC", "Oscillator correction saved to SPIFFS");
+        }
+    }
+
+    void loadOffset() {
+        if (!Config.afc.active) return;
+        String line;
+        if (!HAL::readLine("/afcOffset.txt", line)) return;
+        afcOffsetPpb = line.toInt();
+        int32_t maxOffset = getMaxOffsetPpb();
+        afcOffsetPpb = constrain(afcOffsetPpb, -maxOffset, maxOffset);
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "AFC", "Oscillator correction %+.2f ppm (%+d Hz)", getOffsetPpm(), getCorrection());
+    }
+
+    int getCorrection() {
+        if (!Config.afc.active) return 0;
+        return (int)((int64_t)afcOffsetPpb * currentLoRaType->frequency / 1000000000);
+    }
+
+    float getOffsetPpm() {
+        return afcOffsetPpb / 1000.0;
+    }
+
+    uint8_t getSampleCount() {
+        return afcSampleCount;
+    }
+
+    int getLastMedian() {
+        return afcLastMedian;
+    }
+
+    void reset() {
+        afcSampleCount  = 0;
+        afcSampleIndex  = 0;
+    }
+
+    void processPacket(const String& frame, const FrameHeader& header, float snr, int freqError) {
+        if (!Config.afc.active) return;
+        // Only infrastructure is trusted to sit on the channel frequency, and only frames well above the floor
+        if (snr < LINK_Utils::getRequiredSnr(currentLoRaType->spreadingFactor) + AFC_MIN_MARGIN) return;
+        int start, end;
+        if (!FRAME_Utils::getInfrastructureSender(frame, header, start, end)) return;
+
+        uint32_t station = 2166136261;      // FNV-1a
+        for (int i = start; i < end; i++) {
+            station ^= (uint8_t)frame[i];
+            station *= 16777619;
+        }
+        afcSamples[afcSampleIndex].station      = station;
+        afcSamples[afcSampleIndex].freqError    = freqError;
+        afcSampleIndex = (afcSampleIndex + 1) % AFC_SAMPLES;
+        if (afcSampleCount < AFC_SAMPLES) afcSampleCount++;
+        if (afcSampleCount < AFC_MIN_SAMPLES) return;
+
+        // A single station off frequency must not pull us along with it
+        int stations = 0;
+        for (int i = 0; i < afcSampleCount && stations < AFC_MIN_STATIONS; i++) {
+            bool seen = false;
+            for (int j = 0; j < i; j++) {
+                if (afcSamples[j].station == afcSamples[i].station) {
+                    seen = true;
+                    break;
+                }
+            }
+            if (!seen) stations++;
+        }
+        if (stations < AFC_MIN_STATIONS) return;
+
+        int errors[AFC_SAMPLES];
+        for (int i = 0; i < afcSampleCount; i++) {
+            int value = afcSamples[i].freqError;
+            int j = i;
+            for (; j > 0 && errors[j - 1] > value; j--) errors[j] = errors[j - 1];
+            errors[j] = value;
+        }
+        afcLastMedian = errors[afcSampleCount / 2];
+        if (abs(afcLastMedian) < AFC_DEADBAND) return;
+
+        // freqError is the received carrier relative to our LO: a positive median means we listen low, so tune up.
+        // Integrate half of it, the samples are relative to the frequency they were received on and start over
+        int32_t maxOffset   = getMaxOffsetPpb();
+        int32_t offset      = afcOffsetPpb + (int32_t)((int64_t)(afcLastMedian * AFC_GAIN) * 1000000000 / currentLoRaType->frequency);
+        offset              = constrain(offset, -maxOffset, maxOffset);
+        reset();
+        if (offset == afcOffsetPpb) return;
+        afcOffsetPpb = offset;
+        afcUpdates++;
+        LoRa_Utils::applyFrequencyCorrection();
+        saveOffset();
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "AFC", "Median error %+d Hz, oscillator correction %+.2f ppm (%+d Hz)", afcLastMedian, getOffsetPpm(), getCorrection());
+    }
+
+}
@@ -0,0 +1,27 @@
+#ifndef AFC_UTILS_H_
+#define AFC_UTILS_H_
+
+#include <Arduino.h>
+#include "frame_utils.h"
+
+#define AFC_SAMPLES             9
+#define AFC_MIN_SAMPLES         5
+#define AFC_MIN_STATIONS        2
+#define AFC_MIN_MARGIN          3.0     // dB above the demodulation floor, freqError is noise below that
+#define AFC_DEADBAND            100     // Hz
+#define AFC_GAIN                0.5
+
+
+namespace AFC_Utils {
+
+    void    loadOffset();
+    int     getCorrection();        // Hz to add to the current LoRa type frequency
+    float   getOffsetPpm();
+    void    processPacket(const String& frame, const FrameHeader& header, float snr, int freqError);
+    void    reset();
+    uint8_t getSampleCount();
+    int     getLastMedian();
+
+}
+
+#endif
@@ -0,0 +1,320 @@
+#include <string.h>
+#include <ctype.h>
+#include "ax25_codec.h"
+#include "kiss_protocol.h"
+
+/*
+ * TNC2 monitor format:     SOURCE>DESTIN,VIA,VIA*:payload
+ * AX.25 UI frame:          DESTIN SOURCE VIA VIA CONTROL PID payload
+ *
+ * Every address is six callsign characters shifted left by one and padded with spaces, followed by the SSID byte:
+ * reserved bits 0x60, SSID << 1, H bit (0x80, "has been digipeated", shown as '*' on VIA fields) and the extension
+ * bit (0x01) on the last address.
+ *
+ * The binary on-air formats keep the AX.25 address order and leave out CONTROL and PID, APRS only uses UI frames.
+ * Packed addresses take 5 bytes: the callsign in base 40 (space, 0-9, A-Z), big endian, then SSID in bits 0-3,
+ * H bit 0x40 and last address 0x80.
+ */
+
+namespace AX25_Utils {
+
+    struct Address {
+        char        callsign[6];
+        uint8_t     length;
+        uint8_t     ssid;
+        bool        digipeated;
+        bool        last;
+    };
+
+    struct Writer {
+        uint8_t*    data;
+        size_t      size;
+        size_t      length;
+        bool        escape;             // KISS transposes FEND and FESC
+
+        bool put(uint8_t value) {
+            if (escape && (value == FEND || value == FESC)) {
+                if (length + 2 > size) return false;
+                data[length++] = FESC;
+                data[length++] = (value == FEND) ? TFEND : TFESC;
+            } else {
+                if (length + 1 > size) return false;
+                data[length++] = value;
+            }
+            return true;
+        }
+    };
+
+    struct Reader {
+        const uint8_t*  position;
+        const uint8_t*  end;
+        bool            unescape;
+
+        bool available() const {
+            return position < end;
+        }
+
+        bool read(uint8_t& value) {
+            if (position >= end) return false;
+            value = *position++;
+            if (!unescape) return true;
+            if (value == FEND) return false;
+            if (value != FESC) return true;
+            if (position >= end) return false;
+            uint8_t transposed = *position++;
+            if (transposed == TFEND) {
+                value = FEND;
+            } else if (transposed == TFESC) {
+                value = FESC;
+            } else {
+                return false;
+            }
+            return true;
+        }
+    };
+
+    static bool append(char* frame, size_t size, size_t& length, char value) {
+        if (length >= size) return false;
+        frame[length++] = value;
+        return true;
+    }
+
+    static int packedCode(char character) {
+        if (character == ' ') return 0;
+        if (character >= '0' && character <= '9') return 1 + character - '0';
+        if (character >= 'A' && character <= 'Z') return 11 + character - 'A';
+        return -1;
+    }
+
+    static bool parseAddress(const char* text, size_t textLength, bool isRelay, bool isLast, Address& address) {
+        size_t callsignLength = 0;
+        while (callsignLength < textLength && isalnum((uint8_t)text[callsignLength])) callsignLength++;
+        if (callsignLength == 0 || callsignLength > 6) return false;
+
+        size_t i = callsignLength;
+        int ssid = 0;
+        if (i < textLength && text[i] == '-') {
+            size_t digits = 0;
+            for (i++; i < textLength && isdigit((uint8_t)text[i]) && digits < 2; i++, digits++) {
+                ssid = ssid * 10 + (text[i] - '0');
+            }
+            if (digits == 0 || ssid > 15) return false;
+        }
+        address.digipeated = false;
+        if (isRelay && i < textLength && text[i] == '*') {
+            address.digipeated = true;
+            i++;
+        }
+        if (i != textLength) return false;
+
+        memcpy(address.callsign, text, callsignLength);
+        address.length  = callsignLength;
+        address.ssid    = ssid;
+        address.last    = isLast;
+        return true;
+    }
+
+    static bool writeAddress(Writer& writer, const Address& address, bool packed) {
+        if (packed) {
+            uint32_t value = 0;
+            for (int i = 0; i < 6; i++) {
+                int code = packedCode(i < address.length ? address.callsign[i] : ' ');
+                if (code < 0) return false;
+                value = value * 40 + code;
+            }
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                if (!writer.put(value >> shift)) return false;
+            }
+            return writer.put(address.ssid | (address.digipeated ? 0x40 : 0) | (address.last ? 0x80 : 0));
+        }
+        for (int i = 0; i < 6; i++) {
+            if (!writer.put((uint8_t)((i < address.length ? address.callsign[i] : ' ') << 1))) return false;
+        }
+        return writer.put((address.ssid << 1) | 0b01100000 | (address.digipeated ? HAS_BEEN_DIGIPITED_MASK : 0) | (address.last ? IS_LAST_ADDRESS_POSITION_MASK : 0));
+    }
+
+    static bool readAddress(Reader& reader, bool packed, Address& address) {
+        uint8_t bytes[7];
+        int     count = packed ? 5 : 7;
+        for (int i = 0; i < count; i++) {
+            if (!reader.read(bytes[i])) return false;
+        }
+        address.length = 0;
+        if (packed) {
+            static const char alphabet[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+            uint32_t value = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+            char     characters[6];
+            for (int i = 5; i >= 0; i--, value /= 40) {
+                if (value % 40 >= sizeof(alphabet) - 1) return false;
+                characters[i] = alphabet[value % 40];
+            }
+            if (value != 0 || (bytes[4] & 0x30)) return false;
+            for (int i = 0; i < 6; i++) {
+                if (characters[i] != ' ') address.callsign[address.length++] = characters[i];
+            }
+            address.ssid        = bytes[4] & 0x0f;
+            address.digipeated  = bytes[4] & 0x40;
+            address.last        = bytes[4] & 0x80;
+        } else {
+            for (int i = 0; i < 6; i++) {
+                if (bytes[i] & 0x01) return false;              // extension bit set inside the callsign
+                char character = bytes[i] >> 1;
+                if (character == ' ') continue;
+                if (!isalnum((uint8_t)character)) return false;
+                address.callsign[address.length++] = character;
+            }
+            address.ssid        = (bytes[6] >> 1) & 0b1111;
+            address.digipeated  = bytes[6] & HAS_BEEN_DIGIPITED_MASK;
+            address.last        = bytes[6] & IS_LAST_ADDRESS_POSITION_MASK;
+        }
+        return address.length > 0;
+    }
+
+    static bool appendAddress(char* frame, size_t size, size_t& length, const Address& address, bool isRelay) {
+        for (int i = 0; i < address.length; i++) {
+            if (!append(frame, size, length, address.callsign[i])) return false;
+        }
+        if (address.ssid) {
+            if (!append(frame, size, length, '-')) return false;
+            if (address.ssid >= 10 && !append(frame, size, length, '1')) return false;
+            if (!append(frame, size, length, '0' + address.ssid % 10)) return false;
+        }
+        if (isRelay && address.digipeated) {
+            return append(frame, size, length, '*');
+        }
+        return true;
+    }
+
+    static bool encodeBody(const char* frame, size_t length, Writer& writer, bool packed, bool withControl) {
+        const char* colon   = (const char*)memchr(frame, ':', length);
+        if (colon == nullptr) return false;
+        const char* arrow   = (const char*)memchr(frame, '>', colon - frame);
+        if (arrow == nullptr) return false;
+
+        // AX.25 carries the destination first, it runs from '>' to the first ',' or ':'
+        const char* destination     = arrow + 1;
+        const char* destinationEnd  = destination;
+        while (destinationEnd < colon && *destinationEnd != ',') destinationEnd++;
+        Address address;
+        if (!parseAddress(destination, destinationEnd - destination, false, false, address) || !writeAddress(writer, address, packed)) return false;
+        if (!parseAddress(frame, arrow - frame, false, destinationEnd == colon, address) || !writeAddress(writer, address, packed)) return false;
+
+        int digipeaters = 0;
+        for (const char* via = destinationEnd; via < colon; ) {
+            via++;
+            const char* viaEnd = via;
+            while (viaEnd < colon && *viaEnd != ',') viaEnd++;
+            if (++digipeaters > AX25_MAX_DIGIPEATERS) return false;
+            if (!parseAddress(via, viaEnd - via, true, viaEnd == colon, address) || !writeAddress(writer, address, packed)) return false;
+            via = viaEnd;
+        }
+
+        if (withControl && (!writer.put(APRS_CONTROL_FIELD) || !writer.put(APRS_INFORMATION_FIELD))) return false;
+        for (const char* payload = colon + 1; payload < frame + length; payload++) {
+            if (!writer.put((uint8_t)*payload)) return false;
+        }
+        return true;
+    }
+
+    static size_t decodeBody(Reader& reader, char* frame, size_t size, bool packed, bool withControl) {
+        Address destination, source;
+        if (!readAddress(reader, packed, destination) || !readAddress(reader, packed, source)) return 0;
+
+        size_t frameLength = 0;
+        if (!appendAddress(frame, size, frameLength, source, false)) return 0;
+        if (!append(frame, size, frameLength, '>')) return 0;
+        if (!appendAddress(frame, size, frameLength, destination, false)) return 0;
+
+        bool isLast     = source.last;
+        int digipeaters = 0;
+        while (!isLast) {
+            Address via;
+            if (++digipeaters > AX25_MAX_DIGIPEATERS || !readAddress(reader, packed, via)) return 0;
+            if (!append(frame, size, frameLength, ',')) return 0;
+            if (!appendAddress(frame, size, frameLength, via, true)) return 0;
+            isLast = via.last;
+        }
+
+        uint8_t control, protocol;
+        if (withControl && (!reader.read(control) || !reader.read(protocol))) return 0;
+        if (!append(frame, size, frameLength, ':')) return 0;
+        while (reader.available()) {
+            uint8_t value;
+            if (!reader.read(value) || !append(frame, size, frameLength, (char)value)) return 0;
+        }
+        return frameLength;
+    }
+
+    size_t encodeKISS(const char* frame, size_t length, uint8_t* kiss, size_t size) {
+        if (size < 3) return 0;
+        kiss[0] = FEND;
+        kiss[1] = CMD_DATA;
+        Writer writer = {kiss, size - 1, 2, true};          // room for the closing FEND
+        if (!encodeBody(frame, length, writer, false, true)) return 0;
+        kiss[writer.length] = FEND;
+        return writer.length + 1;
+    }
+
+    size_t decodeKISS(const uint8_t* kiss, size_t length, char* frame, size_t size, bool& dataFrame) {
+        dataFrame = false;
+        if (length < 3 || kiss[0] != FEND || kiss[length - 1] != FEND) return 0;
+        dataFrame = kiss[1] == CMD_DATA;
+        if (!dataFrame) return 0;
+        Reader reader = {kiss + 2, kiss + length - 1, true};
+        return decodeBody(reader, frame, size, false, true);
+    }
+
+    size_t encodeBinary(const char* frame, size_t length, uint8_t* data, size_t size, bool packed) {
+        Writer writer = {data, size, 0, false};
+        return encodeBody(frame, length, writer, packed, false) ? writer.length : 0;
+    }
+
+    size_t decodeBinary(const uint8_t* data, size_t length, char* frame, size_t size, bool packed) {
+        Reader reader = {data, data + length, false};
+        return decodeBody(reader, frame, size, packed, false);
+    }
+
+    bool nextKISSFrame(const uint8_t* buffer, size_t length, size_t& offset, const uint8_t*& kiss, size_t& kissLength) {
+        while (offset < length && buffer[offset] != FEND) offset++;
+        while (offset < length) {
+            size_t end = offset + 1;
+            while (end < length && buffer[end] != FEND) end++;
+            if (end >= length) return false;
+            size_t start = offset;
+            offset = end;                   // a closing FEND may open the next frame as well
+            if (end - start > 1) {
+                kiss        = buffer + start;
+                kissLength  = end - start + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t encodeLoRaFrame(const char* frame, size_t length, uint8_t* data, size_t size, uint8_t framing) {
+        if (size < 3) return 0;
+        data[0] = 0x3c;
+        data[1] = 0xff;
+        size_t textLength = length < size - 3 ? length : size - 3;
+        size_t binaryLength = 0;
+        if (framing != LORA_FRAMING_TEXT) {
+            bool packed     = framing == LORA_FRAMING_PACKED;
+            binaryLength    = encodeBinary(frame, length, data + 3, size - 3, packed);
+            data[2]         = packed ? 0x04 : 0x03;
+            if (binaryLength >= textLength) binaryLength = 0;
+        }
+        if (binaryLength > 0) return binaryLength + 3;
+        data[2] = 0x01;
+        memcpy(data + 3, frame, textLength);
+        return textLength + 3;
+    }
+
+    size_t decodeLoRaFrame(const uint8_t* data, size_t length, char* frame, size_t size) {
+        if (length <= 3 || size <= 3 || data[0] != 0x3c || data[1] != 0xff || (data[2] != 0x03 && data[2] != 0x04)) return 0;
+        size_t tnc2Length = decodeBinary(data + 3, length - 3, frame + 3, size - 3, data[2] == 0x04);
+        if (tnc2Length == 0) return 0;
+        memcpy(frame, "\x3c\xff\x01", 3);
+        return tnc2Length + 3;
+    }
+
+}
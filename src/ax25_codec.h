@@ -0,0 +1,41 @@
+#ifndef AX25_CODEC_H_
+#define AX25_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// The frame codecs on plain buffers. Nothing here touches the Arduino core, so the native env tests it on the host.
+
+#define AX25_MAX_DIGIPEATERS    8
+#define AX25_MAX_FRAME_LENGTH   512         // TNC2 text or escaped KISS, the String wrappers use stack buffers of this size
+
+#define LORA_FRAMING_TEXT       0           // "\x3c\xff\x01" + TNC2 text, understood by every LoRa APRS station
+#define LORA_FRAMING_AX25       1           // "\x3c\xff\x03" + AX.25 addresses + payload
+#define LORA_FRAMING_PACKED     2           // "\x3c\xff\x04" + packed addresses + payload
+                                            // "\x3c\xff\x02" wraps any of them with Reed-Solomon parity, see fec_utils.h
+
+namespace AX25_Utils {
+
+    // TNC2 text to one KISS data frame and back in a single pass over caller buffers, nothing is allocated.
+    // Both return the written length, or 0 when the input is malformed (callsign, SSID over 15, digipeaters,
+    // escapes, a FEND inside the frame) or the output does not fit. decodeKISS() writes no terminator.
+    size_t          encodeKISS(const char* frame, size_t length, uint8_t* kiss, size_t size);
+    size_t          decodeKISS(const uint8_t* kiss, size_t length, char* frame, size_t size, bool& dataFrame);
+
+    // The same frame for the air: AX.25 (7 byte) or packed (5 byte) addresses followed by the payload, no KISS framing
+    size_t          encodeBinary(const char* frame, size_t length, uint8_t* data, size_t size, bool packed);
+    size_t          decodeBinary(const uint8_t* data, size_t length, char* frame, size_t size, bool packed);
+
+    // Steps through a buffer holding any number of FEND delimited frames, empty ones (FEND FEND) are skipped.
+    // kiss and kissLength cover the next complete frame including both FENDs, offset is left on its closing FEND
+    bool            nextKISSFrame(const uint8_t* buffer, size_t length, size_t& offset, const uint8_t*& kiss, size_t& kissLength);
+
+    // A TNC2 frame with its "\x3c\xff" + format byte prefix. The binary formats are only used when they come out
+    // shorter than the text, anything they cannot carry goes out as text, cut to size. Returns the frame length.
+    size_t          encodeLoRaFrame(const char* frame, size_t length, uint8_t* data, size_t size, uint8_t framing);
+    // A received 0x03/0x04 frame as "\x3c\xff\x01" + TNC2 text, 0 for text frames and malformed binary ones
+    size_t          decodeLoRaFrame(const uint8_t* data, size_t length, char* frame, size_t size);
+
+}
+
+#endif
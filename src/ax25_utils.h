@@ -2,12 +2,18 @@
 #define AX25_UTILS_H_
 
 #include <Arduino.h>
+#include "ax25_codec.h"
 
 namespace AX25_Utils {
 
+    bool            validateTNC2Frame(const String& frame);
+    bool            validateKISSFrame(const String& frame);
+
+    // "" when the frame is rejected. Unlike the KISS_TO_TNC2 code these replaced, decodeKISS() also returns "" for
+    // command frames (TXDELAY, persistence, ...) instead of passing the raw KISS bytes on as if they were TNC2 text.
     String          encodeKISS(const String& frame);
-    String          decodeKISS(const String& inputFrame, bool& dataFrame);
+    String          decodeKISS(const String& inputFrame, bool& dataFrame);     // first data frame of the buffer
 
 }
 
-#endif
\ No newline at end of file
+#endif
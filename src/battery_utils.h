@@ -6,7 +6,6 @@
 
 namespace BATTERY_Utils {
 
-    String  generateEncodedTelemetry(float voltage);
     String  getPercentVoltageBattery(float voltage);
     void    checkLowVoltageAndSleep(float voltage);
 
@@ -2,6 +2,9 @@
 #include "configuration.h"
 #include "ax25_utils.h"
 #include "lora_utils.h"
+#include "perf_utils.h"
+#include "heap_utils.h"
+#include "power_utils.h"
 #include "ble_utils.h"
 #include "display.h"
 #include "logger.h"
@@ -76,12 +79,15 @@ class MyCallbacks : public NimBLECharacteristicCallbacks {
                 if (character == (char)FEND && kissSerialBuffer.length() > 3) {
                     bool isDataFrame = false;
 
-                    BLEToLoRaPacket = AX25_Utils::decodeKISS(kissSerialBuffer, isDataFrame);
+                    String packet = AX25_Utils::decodeKISS(kissSerialBuffer, isDataFrame);
 
-                    if (isDataFrame) {
+                    if (isDataFrame && !packet.isEmpty()) {
+                        BLEToLoRaPacket = packet;
                         sendBleToLoRa = true;
-                        kissSerialBuffer = "";
+                    } else if (isDataFrame) {
+                        logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "BLE", "%s", "Malformed KISS data frame dropped");
                     }
+                    kissSerialBuffer = "";
                 }
             }
         }
@@ -135,10 +141,31 @@ namespace BLE_Utils {
         }
     }
 
+    static void setupTask(void *parameter) {
+        setup();
+        xTaskNotifyGive((TaskHandle_t)parameter);
+        vTaskDelete(NULL);
+    }
+
+    void beginSetup() {
+        TaskHandle_t caller = xTaskGetCurrentTaskHandle();
+        if (xTaskCreatePinnedToCore(setupTask, "bleSetup", 4096, caller, 1, NULL, 0) != pdPASS) {
+            setup();
+            xTaskNotifyGive(caller);
+        }
+    }
+
+    void waitSetup() {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
     void sendToLoRa() {
+        PERF_SCOPE(PERF_BT_TO_LORA);
+        HEAP_TRACK(HEAP_BLE);
         if (!sendBleToLoRa) {
             return;
         }
+        CPU_BOOST();
 
         if (!Config.acceptOwnFrameFromTNC && BLEToLoRaPacket.indexOf("::") == -1) {
             String sender = BLEToLoRaPacket.substring(0,BLEToLoRaPacket.indexOf(">"));
@@ -165,24 +192,21 @@ namespace BLE_Utils {
 
     void txToPhoneOverBLE(const String& frame) {
         if (Config.bluetooth.type == 0) { // AX25 KISS
-            const String kissEncoded = AX25_Utils::encodeKISS(frame);
-
-            const char* t = kissEncoded.c_str();
-            int length = kissEncoded.length();
+            uint8_t kiss[AX25_MAX_FRAME_LENGTH];
+            int length = AX25_Utils::encodeKISS(frame.c_str(), frame.length(), kiss, sizeof(kiss));
+            if (length == 0) {
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "BLE", "Not sent, no valid AX.25 frame: %s", frame.c_str());
+                return;
+            }
 
             const int CHUNK_SIZE = 64;
 
             for (int i = 0; i < length; i += CHUNK_SIZE) {
                 int chunkSize = (length - i < CHUNK_SIZE) ? (length - i) : CHUNK_SIZE;
-                
-                uint8_t* chunk = new uint8_t[chunkSize];
-                memcpy(chunk, t + i, chunkSize);
 
-                pCharacteristicTx->setValue(chunk, chunkSize);
+                pCharacteristicTx->setValue(kiss + i, chunkSize);
                 pCharacteristicTx->notify();
 
-                delete[] chunk;
-
                 delay(200);
             }
         } else { // TNC2
@@ -195,6 +219,8 @@ namespace BLE_Utils {
     }
 
     void sendToPhone(const String& packet) {
+        PERF_SCOPE(PERF_BT_TO_PHONE);
+        HEAP_TRACK(HEAP_BLE);
         if (!packet.isEmpty() && bluetoothConnected) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BLE Rx", "%s", packet.c_str());
             String receivedPacketString = "";
@@ -7,6 +7,9 @@ namespace BLE_Utils {
 
     void stop();
     void setup();
+    // NimBLE init on core 0 while setup() carries on; waitSetup() blocks the caller of beginSetup() until it is done
+    void beginSetup();
+    void waitSetup();
     void sendToLoRa();
     void txBLE(uint8_t p);
     void txToPhoneOverBLE(const String& frame);
@@ -1,9 +1,10 @@
 #include <TinyGPS++.h>
 #include <esp_bt.h>
 #include "bluetooth_utils.h"
+#include "ax25_utils.h"
 #include "configuration.h"
-#include "KISS_TO_TNC2.h"
 #include "lora_utils.h"
+#include "perf_utils.h"
 #include "display.h"
 #include "logger.h"
 
@@ -86,9 +87,9 @@ namespace BLUETOOTH_Utils {
         isNmea = serialReceived.indexOf("$G") != -1 || serialReceived.indexOf("$B") != -1;
         if (isNmea) useKiss = false;
         if (isNmea || serialReceived.isEmpty()) return;
-        if (validateKISSFrame(serialReceived)) {
+        if (AX25_Utils::validateKISSFrame(serialReceived)) {
             bool dataFrame;
-            String decodeKiss = decode_kiss(serialReceived, dataFrame);
+            String decodeKiss = AX25_Utils::decodeKISS(serialReceived, dataFrame);
             serialReceived.clear();
             serialReceived += decodeKiss;
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "It's a kiss frame. dataFrame: %d", dataFrame);
@@ -96,13 +97,14 @@ namespace BLUETOOTH_Utils {
         } else {
             useKiss = false;
         }
-        if (validateTNC2Frame(serialReceived)) {
+        if (AX25_Utils::validateTNC2Frame(serialReceived)) {
             shouldSendToLoRa = true;
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "Data received should be transmitted to RF => %s", serialReceived.c_str());
         }
     }
 
     void sendToLoRa() {
+        PERF_SCOPE(PERF_BT_TO_LORA);
         if (!shouldSendToLoRa) {
             return;
         }
@@ -114,10 +116,16 @@ namespace BLUETOOTH_Utils {
     }
 
     void sendPacket(const String& packet) {
+        PERF_SCOPE(PERF_BT_TO_PHONE);
         if (bluetoothActive && !packet.isEmpty()) {
             if (useKiss) {
                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BT RX Kiss", "%s", serialReceived.c_str());
-                SerialBT.println(encode_kiss(packet));
+                String kissFrame = AX25_Utils::encodeKISS(packet);
+                if (kissFrame.isEmpty()) {
+                    logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "BT", "Not sent, no valid AX.25 frame: %s", packet.c_str());
+                    return;
+                }
+                SerialBT.println(kissFrame);
             } else {
                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BT RX TNC2", "%s", serialReceived.c_str());
                 SerialBT.println(packet);
@@ -2,6 +2,9 @@
 #include <logger.h>
 #include "bme_utils.h"
 #include "configuration.h"
+#include "hal_utils.h"
+#include "sleep_utils.h"
+#include "telemetry_utils.h"
 #include "display.h"
 
 #define SEALEVELPRESSURE_HPA (1013.25)
@@ -11,9 +14,19 @@ extern Configuration    Config;
 extern logging::Logger  logger;
 extern TinyGPSPlus      gps;
 
-float newHum, newTemp, newPress, newGas;
+struct BmeSample {
+    float       temperature;        // raw sensor values, corrections are applied when a reading is served
+    float       humidity;
+    float       pressure;
+    float       gas;
+    uint32_t    time;
+};
 
-uint32_t    bmeLastReading      = -60000;
+BmeSample   bmeRing[BME_RING_SIZE];
+uint8_t     bmeRingHead         = 0;
+uint8_t     bmeRingCount        = 0;
+uint32_t    bmeSampleTime       = 0;
+uint32_t    bmeReadyTime        = 0;        // end of a running BME680 conversion, 0 when idle
 int         wxModuleType        = 0;
 uint8_t     wxModuleAddress     = 0x00;
 bool        wxModuleFound       = false;
@@ -32,21 +45,18 @@ Adafruit_BME680     bme680;
 namespace BME_Utils {    
 
     void getWxModuleAddres() {
-        uint8_t err, addr;
-        for(addr = 1; addr < 0x7F; addr++) {
+        const uint8_t addresses[] = {0x76, 0x77};      // all BME280/BMP280/BME680 strap options, no full bus scan
+        for (uint8_t addr : addresses) {
             #ifdef HELTEC_V3_GPS
                 Wire1.beginTransmission(addr);
-                err = Wire1.endTransmission();
+                uint8_t err = Wire1.endTransmission();
             #else
                 Wire.beginTransmission(addr);
-                err = Wire.endTransmission();
+                uint8_t err = Wire.endTransmission();
             #endif
             if (err == 0) {
-                //Serial.println(addr); this shows any connected board to I2C
-                if (addr == 0x76 || addr == 0x77) {
-                    wxModuleAddress = addr;
-                    return;
-                }
+                wxModuleAddress = addr;
+                return;
             }
         }
     }
@@ -88,20 +98,22 @@ namespace BME_Utils {
                 } else {
                     switch (wxModuleType) {
                         case 1:
-                            bme280.setSampling(Adafruit_BME280::MODE_FORCED,
+                            bme280.setSampling(Adafruit_BME280::MODE_NORMAL,     // converts on its own, reads never wait
                                         Adafruit_BME280::SAMPLING_X1,
                                         Adafruit_BME280::SAMPLING_X1,
                                         Adafruit_BME280::SAMPLING_X1,
-                                        Adafruit_BME280::FILTER_OFF
+                                        Adafruit_BME280::FILTER_OFF,
+                                        Adafruit_BME280::STANDBY_MS_1000
                                         );
                             logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "BME", " BME280 Module init done!");
                             break;
                         case 2:
-                            bmp280.setSampling(Adafruit_BMP280::MODE_FORCED,
+                            bmp280.setSampling(Adafruit_BMP280::MODE_NORMAL,
                                         Adafruit_BMP280::SAMPLING_X1,
                                         Adafruit_BMP280::SAMPLING_X1,
-                                        Adafruit_BMP280::FILTER_OFF
-                                        ); 
+                                        Adafruit_BMP280::FILTER_OFF,
+                                        Adafruit_BMP280::STANDBY_MS_1000
+                                        );
                             logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "BMP", " BMP280 Module init done!");
                             break;
                         case 3:
@@ -119,174 +131,133 @@ namespace BME_Utils {
         }
     }
 
-    const String generateTempString(const float bmeTemp, const uint8_t type) {
-        String strTemp;
-        if (type == 1) {    // OLED
-            strTemp = String((int)bmeTemp);
-        } else {
-            strTemp = String((int)((bmeTemp * 1.8) + 32));
-        }
-        switch (strTemp.length()) {
-            case 1:
-                if (type == 1) {
-                    return "  " + strTemp;
-                } else {
-                    return "00" + strTemp;
-                }
-            case 2:
-                if (type == 1) {
-                    return " " + strTemp;
-                } else {
-                    return "0" + strTemp;
-                }
-            case 3:
-                return strTemp;
-            default:
-                return "-999";
+    static void storeSample(float temperature, float humidity, float pressure, float gas) {
+        if (isnan(temperature) || isnan(pressure)) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "BME", "BME/BMP Module data failed");
+            return;
         }
+        BmeSample& sample   = bmeRing[bmeRingHead];
+        sample.temperature  = temperature;
+        sample.humidity     = humidity;
+        sample.pressure     = pressure;
+        sample.gas          = gas;
+        sample.time         = HAL::now();
+        bmeRingHead         = (bmeRingHead + 1) % BME_RING_SIZE;
+        if (bmeRingCount < BME_RING_SIZE) bmeRingCount++;
+
+        BmeReading reading;
+        getReading(reading);
+        TELEMETRY_Utils::publish(TELEMETRY_TEMPERATURE, reading.temperature);
+        TELEMETRY_Utils::publish(TELEMETRY_PRESSURE, reading.pressure);
+        TELEMETRY_Utils::publish(TELEMETRY_HUMIDITY, reading.humidity);     // NAN on a BMP280, not published
     }
 
-    const String generateHumString(const float bmeHum, const uint8_t type) {
-        String strHum = String((int)bmeHum);
-        switch (strHum.length()) {
-            case 1:
-                if (type == 1) {
-                    return " " + strHum;
-                } else {
-                    return "0" + strHum;
-                }
-            case 2:
-                return strHum;
-            case 3:
-                if ((int)bmeHum == 100) {
-                    if (type == 1) {
-                        return "  ";
-                    } else {
-                        return "00";
-                    }
-                } else {
-                    return "-99";
-                }
-            default:
-                return "-99";
+    void checkSampler() {
+        if (!wxModuleFound) return;
+        if (bmeReadyTime != 0) {                    // BME680 conversion with gas heater running
+            if ((int32_t)(HAL::now() - bmeReadyTime) < 0) {
+                SLEEP_Utils::wakeBy(bmeReadyTime);
+                return;
+            }
+            bmeReadyTime = 0;
+            #ifndef HELTEC_V3_GPS
+                if (bme680.endReading()) storeSample(bme680.temperature, bme680.humidity, bme680.pressure / 100.0F, bme680.gas_resistance / 1000.0);
+            #endif
+            return;
+        }
+        if (bmeSampleTime != 0 && HAL::now() - bmeSampleTime < (uint32_t)Config.bme.sampleInterval * 1000) {
+            SLEEP_Utils::wakeBy(bmeSampleTime + Config.bme.sampleInterval * 1000);
+            return;
+        }
+        bmeSampleTime = HAL::now();
+        switch (wxModuleType) {
+            case 1: // BME280
+                storeSample(bme280.readTemperature(), bme280.readHumidity(), bme280.readPressure() / 100.0F, NAN);
+                break;
+            case 2: // BMP280
+                storeSample(bmp280.readTemperature(), NAN, bmp280.readPressure() / 100.0F, NAN);
+                break;
+            case 3: // BME680
+                #ifndef HELTEC_V3_GPS
+                    bmeReadyTime = bme680.beginReading();
+                    if (bmeReadyTime == 0) logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "BME", "BME680 reading not started");
+                #endif
+                break;
         }
     }
 
-    const String generatePresString(const float bmePress, const uint8_t type) {
-        String strPress = String((int)bmePress);
-        String decPress = String(int((bmePress - int(bmePress)) * 10));
-        switch (strPress.length()) {
-            case 1:
-                if (type == 1) {
-                    return "000" + strPress;
-                } else {
-                    return "000" + strPress + decPress;
-                }
-            case 2:
-                if (type == 1) {
-                    return "00" + strPress;
-                } else {
-                    return "00" + strPress + decPress;
-                }
-            case 3:
-                if (type == 1) {
-                    return "0" + strPress;
-                } else {
-                    return "0" + strPress + decPress;
-                }
-            case 4:
-                if (type == 1) {
-                    return strPress;
-                } else {
-                    return strPress + decPress;
-                }
-            case 5:
-                return strPress;
-            default:
-                return "-99999";
+    static float median(float* values, uint8_t count) {
+        for (uint8_t i = 1; i < count; i++) {       // insertion sort, at most BME_RING_SIZE values
+            float value = values[i];
+            int   j     = i - 1;
+            for (; j >= 0 && values[j] > value; j--) values[j + 1] = values[j];
+            values[j + 1] = value;
         }
+        return (count % 2) ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2;
     }
 
-    const String readDataSensor(const uint8_t type) {
-        uint32_t lastReading = millis() - bmeLastReading;
-        if (lastReading > 60 * 1000) {
-            switch (wxModuleType) {
-                case 1: // BME280
-                    bme280.takeForcedMeasurement();
-                    newTemp     = bme280.readTemperature();
-                    newPress    = (bme280.readPressure() / 100.0F);
-                    newHum      = bme280.readHumidity();
-                    break;
-                case 2: // BMP280
-                    bmp280.takeForcedMeasurement();
-                    newTemp     = bmp280.readTemperature();
-                    newPress    = (bmp280.readPressure() / 100.0F);
-                    newHum      = 0;
-                    break;
-                case 3: // BME680
-                    #ifndef HELTEC_V3_GPS
-                        bme680.performReading();
-                        delay(50);
-                        if (bme680.endReading()) {
-                            newTemp     = bme680.temperature;
-                            newPress    = (bme680.pressure / 100.0F);
-                            newHum      = bme680.humidity;
-                            newGas      = bme680.gas_resistance / 1000.0; // in Kilo ohms
-                        }
-                    #endif
-                    break;
-            }
-            bmeLastReading = millis();
+    bool getReading(BmeReading& reading) {
+        if (bmeRingCount == 0) return false;
+        float temperature[BME_RING_SIZE], humidity[BME_RING_SIZE], pressure[BME_RING_SIZE], gas[BME_RING_SIZE];
+        reading.minTemperature = reading.maxTemperature = bmeRing[0].temperature;
+        for (uint8_t i = 0; i < bmeRingCount; i++) {
+            const BmeSample& sample = bmeRing[i];
+            temperature[i]  = sample.temperature;
+            humidity[i]     = sample.humidity;
+            pressure[i]     = sample.pressure;
+            gas[i]          = sample.gas;
+            if (sample.temperature < reading.minTemperature) reading.minTemperature = sample.temperature;
+            if (sample.temperature > reading.maxTemperature) reading.maxTemperature = sample.temperature;
         }
-        
-        String wx;
-        if (isnan(newTemp) || isnan(newHum) || isnan(newPress)) {
-            Serial.println("BME/BMP Module data failed");
-            if (type == 1) {
-                wx = " - C    - %    - hPa";
-            } else {
-                wx = ".../...g...t...";
-            }
-            return wx;
-        } else {
-            String tempStr = generateTempString(newTemp + Config.bme.temperatureCorrection, type);
-            String humStr;
-            if (wxModuleType == 1 || wxModuleType == 3) {
-                humStr  = generateHumString(newHum,type);
-            } else if (wxModuleType == 2) {
-                humStr  = "..";
-            }
-            String presStr = generatePresString(newPress + (gps.altitude.meters()/CORRECTION_FACTOR), type);
-            if (type == 1) {
-                if (wxModuleType == 1 || wxModuleType == 3) {
-                    wx = tempStr;
-                    wx += "C   ";
-                    wx += humStr;
-                    wx += "%   ";
-                    wx += presStr;
-                    wx += "hPa";
-                } else if (wxModuleType == 2) {
-                    wx = "T: ";
-                    wx += tempStr;
-                    wx += "C P: ";
-                    wx += presStr;
-                    wx += "hPa";
-                }
-            } else {
-                wx = ".../...g...t";
-                wx += tempStr;
-                wx += "h";
-                wx += humStr;
-                wx += "b";
-                wx += presStr;
-                if (wxModuleType == 3) {
-                    wx += "Gas: ";
-                    wx += String(newGas);
-                    wx += "Kohms";
-                }
-            }
-            return wx;
+        float seaLevel          = gps.altitude.meters() / CORRECTION_FACTOR;
+        reading.temperature     = median(temperature, bmeRingCount) + Config.bme.temperatureCorrection;
+        reading.humidity        = median(humidity, bmeRingCount);
+        reading.pressure        = median(pressure, bmeRingCount) + seaLevel;
+        reading.gas             = median(gas, bmeRingCount);
+        reading.minTemperature  += Config.bme.temperatureCorrection;
+        reading.maxTemperature  += Config.bme.temperatureCorrection;
+
+        const BmeSample& newest = bmeRing[(bmeRingHead + BME_RING_SIZE - 1) % BME_RING_SIZE];
+        const BmeSample& oldest = bmeRing[bmeRingCount < BME_RING_SIZE ? 0 : bmeRingHead];
+        uint32_t span           = newest.time - oldest.time;
+        reading.pressureTrend   = span > 0 ? (newest.pressure - oldest.pressure) * 3600000.0 / span : 0;
+        return true;
+    }
+
+    // The writers below fill caller buffers, type 0 is the APRS weather field and type 1 the OLED line
+    size_t writeTemp(char* buffer, size_t size, float temperature, uint8_t type) {
+        int value = (type == 1) ? (int)temperature : (int)((temperature * 1.8) + 32);
+        if (value < -99 || value > 999) return snprintf(buffer, size, "...");
+        return snprintf(buffer, size, (type == 1) ? "%3d" : "%03d", value);
+    }
+
+    size_t writeHum(char* buffer, size_t size, float humidity, uint8_t type) {
+        int value = (int)humidity;
+        if (isnan(humidity) || value < 0 || value > 100) return snprintf(buffer, size, "..");
+        if (type == 1) return snprintf(buffer, size, "%2d", value > 99 ? 99 : value);
+        return snprintf(buffer, size, "%02d", value % 100);        // 100% is h00
+    }
+
+    size_t writePres(char* buffer, size_t size, float pressure, uint8_t type) {
+        int value = (type == 1) ? (int)pressure : (int)(pressure * 10);
+        if (value < 0 || value > ((type == 1) ? 9999 : 99999)) return snprintf(buffer, size, (type == 1) ? "...." : ".....");
+        return snprintf(buffer, size, (type == 1) ? "%04d" : "%05d", value);
+    }
+
+    size_t writeDataSensor(char* buffer, size_t size, uint8_t type) {
+        BmeReading reading;
+        if (!getReading(reading)) return snprintf(buffer, size, (type == 1) ? " - C    - %%    - hPa" : ".../...g...t...");
+
+        char temperature[8], humidity[8], pressure[8];
+        writeTemp(temperature, sizeof(temperature), reading.temperature, type);
+        writeHum(humidity, sizeof(humidity), reading.humidity, type);
+        writePres(pressure, sizeof(pressure), reading.pressure, type);
+        if (type == 1) {
+            if (wxModuleType == 2) return snprintf(buffer, size, "T: %sC P: %shPa", temperature, pressure);
+            return snprintf(buffer, size, "%sC   %s%%   %shPa", temperature, humidity, pressure);
         }
+        if (wxModuleType == 3) return snprintf(buffer, size, ".../...g...t%sh%sb%sGas: %.2fKohms", temperature, humidity, pressure, reading.gas);
+        return snprintf(buffer, size, ".../...g...t%sh%sb%s", temperature, humidity, pressure);
     }
 
-}
\ No newline at end of file
+}
@@ -7,16 +7,31 @@
 #include <Adafruit_BME680.h>
 #include <Arduino.h>
 
- 
+#define BME_RING_SIZE   12      // samples behind the median, min/max and pressure trend
+
+struct BmeReading {
+    float   temperature;        // C with the configured correction, median of the ring
+    float   humidity;           // %, NAN on a BMP280
+    float   pressure;           // hPa reduced to sea level
+    float   gas;                // kOhm, BME680 only
+    float   minTemperature;
+    float   maxTemperature;
+    float   pressureTrend;      // hPa per hour across the ring
+};
+
+
 namespace BME_Utils {
 
-    void  getWxModuleAddres();
-    void  setup();
-    const String generateTempString(const float bmeTemp, const uint8_t type);
-    const String generateHumString(const float bmeHum, const uint8_t type);
-    const String generatePresString(const float bmePress, const uint8_t type);
-    const String readDataSensor(const uint8_t type);
+    void    getWxModuleAddres();
+    void    setup();
+    void    checkSampler();     // from loop(): one sample per bme.sampleInterval, never waits for a conversion
+    bool    getReading(BmeReading& reading);       // false until the first sample
+
+    size_t  writeTemp(char* buffer, size_t size, float temperature, uint8_t type);
+    size_t  writeHum(char* buffer, size_t size, float humidity, uint8_t type);
+    size_t  writePres(char* buffer, size_t size, float pressure, uint8_t type);
+    size_t  writeDataSensor(char* buffer, size_t size, uint8_t type);       // 0 = APRS weather, 1 = OLED
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,60 @@
+#include <logger.h>
+#include "boot_utils.h"
+#include "hal_utils.h"
+
+
+extern logging::Logger      logger;
+
+const char  *bootPhaseNames[BOOT_PHASES] = {"Power", "Storage", "GPS", "Display", "WiFi", "Messages", "LoRa", "Sensor", "Bluetooth", "Done"};
+
+uint32_t    bootPhaseTime[BOOT_PHASES];
+uint32_t    bootFirstRxTime         = 0;
+uint32_t    bootFirstBeaconTime     = 0;
+
+
+namespace BOOT_Utils {
+
+    void mark(uint8_t phase) {
+        if (phase >= BOOT_PHASES) return;
+        bootPhaseTime[phase] = HAL::now();
+    }
+
+    uint32_t getPhaseTime(uint8_t phase) {
+        return (phase < BOOT_PHASES) ? bootPhaseTime[phase] : 0;
+    }
+
+    void waitSince(uint8_t phase, uint32_t ms) {
+        uint32_t elapsed = HAL::now() - getPhaseTime(phase);
+        if (elapsed < ms) HAL::delay(ms - elapsed);
+    }
+
+    void logTimeline() {
+        uint32_t last = 0;
+        for (uint8_t i = 0; i < BOOT_PHASES; i++) {
+            if (bootPhaseTime[i] == 0) continue;    // skipped on this board or configuration
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Boot", "%-9s %5u ms (+%u)", bootPhaseNames[i], (unsigned int)bootPhaseTime[i], (unsigned int)(bootPhaseTime[i] - last));
+            last = bootPhaseTime[i];
+        }
+    }
+
+    void firstRx() {
+        if (bootFirstRxTime != 0) return;
+        bootFirstRxTime = HAL::now();
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Boot", "First Rx %u ms after power on", (unsigned int)bootFirstRxTime);
+    }
+
+    void firstBeacon() {
+        if (bootFirstBeaconTime != 0) return;
+        bootFirstBeaconTime = HAL::now();
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Boot", "First beacon %u ms after power on", (unsigned int)bootFirstBeaconTime);
+    }
+
+    uint32_t getFirstRxTime() {
+        return bootFirstRxTime;
+    }
+
+    uint32_t getFirstBeaconTime() {
+        return bootFirstBeaconTime;
+    }
+
+}
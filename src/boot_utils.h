@@ -0,0 +1,36 @@
+#ifndef BOOT_UTILS_H_
+#define BOOT_UTILS_H_
+
+#include <Arduino.h>
+
+// Boot phases in the order setup() runs them, each marked when it completes
+enum BootPhase {
+    BOOT_POWER,
+    BOOT_STORAGE,
+    BOOT_GPS,
+    BOOT_DISPLAY,
+    BOOT_WIFI,
+    BOOT_MESSAGES,
+    BOOT_LORA,
+    BOOT_SENSOR,
+    BOOT_BLUETOOTH,
+    BOOT_DONE,
+    BOOT_PHASES
+};
+
+
+namespace BOOT_Utils {
+
+    void        mark(uint8_t phase);
+    uint32_t    getPhaseTime(uint8_t phase);            // ms since power on, 0 while the phase has not completed
+    void        waitSince(uint8_t phase, uint32_t ms);  // settle time counted from the end of a phase, not from now
+    void        logTimeline();
+
+    void        firstRx();
+    void        firstBeacon();
+    uint32_t    getFirstRxTime();
+    uint32_t    getFirstBeaconTime();
+
+}
+
+#endif
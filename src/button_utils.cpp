@@ -11,17 +11,20 @@ namespace BUTTON_Utils {
 
     void singlePress() {
         menuTime = millis();
+        displayDismissOverlay();
         KEYBOARD_Utils::downArrow();
     }
 
     void longPress() {
         menuTime = millis();
+        displayDismissOverlay();
         KEYBOARD_Utils::rightArrow();
     }
 
     void doublePress() {
         displayToggle(true);
         menuTime = millis();
+        displayDismissOverlay();
         if (menuDisplay == 0) {
             menuDisplay = 1;
         } else if (menuDisplay > 0) {
@@ -33,6 +36,7 @@ namespace BUTTON_Utils {
     void multiPress() {
         displayToggle(true);
         menuTime = millis();
+        displayDismissOverlay();
         menuDisplay = 9000;
     }
 
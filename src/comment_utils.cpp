@@ -0,0 +1,136 @@
+#include <logger.h>
+#include "configuration.h"
+#include "comment_utils.h"
+#include "ax25_utils.h"
+
+extern logging::Logger  logger;
+extern Configuration    Config;
+
+/*
+ * Static dictionary for beacon comments, token 0x80 + index. Entries are what trackers put in comments (firmware
+ * and board names, the battery suffix, URLs, ham abbreviations) and frequent bigrams of English and Polish text.
+ * The order is part of the on-air format: append only, at most 127 entries. tools/comment_ratio.py reads this table.
+ */
+const char* const commentDictionary[] = {
+    " LoRa APRS", "LoRa", "APRS", " Tracker", "Tracker", "tracker", "iGate", "igate", "Digi", "digi",
+    " Bat=", "V (", "mA)", "%)", "https://", "http://", "www.", "github.com/", ".com", ".pl",
+    ".org", ".net", "qrz.com/db/", "aprs.fi", "LoRa_APRS_Tracker", "TTGO", "T-Beam", "Heltec", "ESP32", "QRV",
+    "QTH", "QSL", " 73", "73", "de ", "Mobile", "mobile", "Portable", "portable", "Car",
+    "car", "Bike", "bike", "Walking", "Hiking", "Home", "home", "Station", "station", "Test",
+    "test", "Radio", "radio", "Club", "club", "Ham", "ham", "MHz", "kHz", "433.",
+    "434.", "144.", "145.", "438.", ".775", ".800", ".500", "CTCSS", "Echolink", "Hz",
+    "km", " on ", " the ", " and ", " in ", " at ", " of ", " to ", " with ", " from ",
+    "ing", "tion", "the", "er", "re", "in", "an", "on", "en", "es",
+    "or", "ar", "al", "st", "ie", "ow", "ch", "sz", "cz", "rz",
+    "ni", "ck", "ll", "ou", "SOTA", "POTA", "WX", "Weather", "weather", "Monitoring",
+    "monitoring", "Active", "only", "Battery", "battery", "Solar", "solar", "Speed", "Alt", "Tel",
+    " www", " - ", "  ", "..."
+};
+
+const int   commentDictionarySize   = sizeof(commentDictionary) / sizeof(commentDictionary[0]);
+
+uint8_t     commentCounter          = 0;
+uint32_t    commentsCompressed      = 0;
+uint32_t    commentBytesSaved       = 0;
+
+
+namespace COMMENT_Utils {
+
+    size_t compress(const char* text, size_t length, uint8_t* data, size_t size) {
+        if (length == 0 || length > COMMENT_MAX_LENGTH) return 0;
+
+        // Shortest encoding of every suffix, so a long entry never hides two shorter ones that fit better
+        uint16_t    cost[COMMENT_MAX_LENGTH + 1];
+        int8_t      choice[COMMENT_MAX_LENGTH];
+        cost[length] = 0;
+        for (int i = length - 1; i >= 0; i--) {
+            cost[i]     = cost[i + 1] + (((uint8_t)text[i] & 0x80) ? 2 : 1);
+            choice[i]   = -1;
+            for (int k = 0; k < commentDictionarySize; k++) {
+                size_t entryLength = strlen(commentDictionary[k]);
+                if (entryLength > length - i || memcmp(text + i, commentDictionary[k], entryLength) != 0) continue;
+                if (1 + cost[i + entryLength] < cost[i]) {
+                    cost[i]     = 1 + cost[i + entryLength];
+                    choice[i]   = k;
+                }
+            }
+        }
+        if (1 + (size_t)cost[0] >= length || 1 + (size_t)cost[0] > size) return 0;
+
+        size_t written = 0;
+        data[written++] = COMMENT_MARKER;
+        for (size_t i = 0; i < length; ) {
+            if (choice[i] >= 0) {
+                data[written++] = 0x80 + choice[i];
+                i += strlen(commentDictionary[choice[i]]);
+            } else {
+                if ((uint8_t)text[i] & 0x80) data[written++] = COMMENT_MARKER;
+                data[written++] = text[i++];
+            }
+        }
+        return written;
+    }
+
+    size_t expand(const uint8_t* data, size_t length, char* text, size_t size) {
+        size_t written = 0;
+        for (size_t i = 0; i < length; i++) {
+            const char* entry;
+            size_t      entryLength;
+            char        literal;
+            if (data[i] == COMMENT_MARKER) {
+                if (++i == length) return 0;
+                literal     = data[i];
+                entry       = &literal;
+                entryLength = 1;
+            } else if (data[i] & 0x80) {
+                int k = data[i] - 0x80;
+                if (k >= commentDictionarySize) return 0;
+                entry       = commentDictionary[k];
+                entryLength = strlen(entry);
+            } else {
+                literal     = data[i];
+                entry       = &literal;
+                entryLength = 1;
+            }
+            if (written + entryLength > size) return 0;
+            memcpy(text + written, entry, entryLength);
+            written += entryLength;
+        }
+        return written;
+    }
+
+    String compressComment(const String& packet, int commentStart, int commentLength) {
+        if (!Config.compressComment || commentStart < 0 || commentLength <= 0) return packet;
+        bool plain = (commentCounter % COMMENT_PLAIN_EVERY) == 0;
+        commentCounter++;
+        if (plain) return packet;
+
+        uint8_t data[COMMENT_MAX_LENGTH];
+        size_t  length = compress(packet.c_str() + commentStart, commentLength, data, sizeof(data));
+        if (length == 0) return packet;
+
+        commentsCompressed++;
+        commentBytesSaved += commentLength - length;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Comment", "%d -> %u bytes", commentLength, (unsigned int)length);
+        String compressed = packet.substring(0, commentStart);
+        compressed.concat((const char*)data, length);
+        compressed += packet.substring(commentStart + commentLength);
+        return compressed;
+    }
+
+    String expandFrame(const String& packet) {
+        int payloadStart = packet.indexOf(':', 3);
+        if (payloadStart < 0) return packet;
+        int commentStart = packet.indexOf((char)COMMENT_MARKER, payloadStart + 1);
+        if (commentStart < 0) return packet;
+
+        char    text[AX25_MAX_FRAME_LENGTH];
+        size_t  length = expand((const uint8_t*)packet.c_str() + commentStart + 1, packet.length() - commentStart - 1, text, sizeof(text));
+        if (length == 0) return packet;
+
+        String expanded = packet.substring(0, commentStart);
+        expanded.concat(text, length);
+        return expanded;
+    }
+
+}
@@ -0,0 +1,23 @@
+#ifndef COMMENT_UTILS_H_
+#define COMMENT_UTILS_H_
+
+#include <Arduino.h>
+
+#define COMMENT_MARKER          0xFF        // never valid in UTF-8, starts a compressed comment and escapes high bytes
+#define COMMENT_MAX_LENGTH      128         // longer comments are sent as they are
+#define COMMENT_PLAIN_EVERY     6           // one comment in this many goes out uncompressed for stock receivers
+
+
+namespace COMMENT_Utils {
+
+    // Marker + dictionary tokens (0x80..) and ASCII literals, 0 when the text is too long, the result is not
+    // shorter or does not fit. expand() takes the bytes after the marker and writes no terminator.
+    size_t  compress(const char* text, size_t length, uint8_t* data, size_t size);
+    size_t  expand(const uint8_t* data, size_t length, char* text, size_t size);
+
+    String  compressComment(const String& packet, int commentStart, int commentLength);     // honours Config.compressComment
+    String  expandFrame(const String& packet);
+
+}
+
+#endif
@@ -1,17 +1,72 @@
 #include <ArduinoJson.h>
+#include <esp_system.h>
 #include <SPIFFS.h>
+#include <type_traits>
 #include "configuration.h"
+#include "power_utils.h"
 #include "display.h"
 #include "logger.h"
 
+
+#define CONFIG_SNAPSHOT_MAGIC   0x43464753
+#define CONFIG_SNAPSHOT_SIZE    2048
+#define CONFIG_SNAPSHOT_VERSION 1       // bump when snapshotFields() changes in a way the class size does not show
+#define CONFIG_SNAPSHOT_LAYOUT  (((uint32_t)CONFIG_SNAPSHOT_VERSION << 16) | (uint32_t)sizeof(Configuration))
+
+RTC_DATA_ATTR uint32_t  configSnapshotMagic;
+RTC_DATA_ATTR uint32_t  configSnapshotLayout;
+RTC_DATA_ATTR uint16_t  configSnapshotLength;
+RTC_DATA_ATTR uint8_t   configSnapshot[CONFIG_SNAPSHOT_SIZE];
+
+// Byte stream over configSnapshot: plain settings blocks are copied as they are, Strings and vectors with a length
+class SnapshotStream {
+public:
+    bool        ok          = true;
+    uint16_t    position    = 0;
+
+    void bytes(void* value, uint16_t length, bool writing) {
+        if (!ok || position + length > CONFIG_SNAPSHOT_SIZE) {
+            ok = false;
+            return;
+        }
+        if (writing) {
+            memcpy(configSnapshot + position, value, length);
+        } else {
+            memcpy(value, configSnapshot + position, length);
+        }
+        position += length;
+    }
+
+    template <typename T>
+    void field(T& value, bool writing) {
+        static_assert(std::is_trivially_copyable<T>::value, "settings block must be plain data");
+        bytes(&value, sizeof(T), writing);
+    }
+
+    void field(String& value, bool writing) {
+        uint16_t length = value.length();
+        field(length, writing);
+        if (!ok) return;
+        if (writing) {
+            bytes((void*)value.c_str(), length, true);
+        } else if (position + length <= CONFIG_SNAPSHOT_SIZE) {
+            value = String((const char*)configSnapshot + position, length);
+            position += length;
+        } else {
+            ok = false;
+        }
+    }
+};
+
 extern logging::Logger logger;
 
 
 void Configuration::writeFile() {
+    CPU_BOOST();
 
     Serial.println("Saving config..");
 
-    StaticJsonDocument<2800> data;
+    StaticJsonDocument<3776> data;
     File configFile = SPIFFS.open("/tracker_conf.json", "w");
 
     data["wifiAP"]["active"]                    = wifiAP.active;
@@ -42,6 +97,7 @@ void Configuration::writeFile() {
     data["bme"]["active"]                       = bme.active;
     data["bme"]["temperatureCorrection"]        = bme.temperatureCorrection;
     data["bme"]["sendTelemetry"]                = bme.sendTelemetry;
+    data["bme"]["sampleInterval"]               = bme.sampleInterval;
 
     data["notification"]["ledTx"]               = notification.ledTx;
     data["notification"]["ledTxPin"]            = notification.ledTxPin;
@@ -76,6 +132,33 @@ void Configuration::writeFile() {
     data["bluetooth"]["type"]                   = bluetooth.type;
     data["bluetooth"]["active"]                 = bluetooth.active;
 
+    data["digi"]["mode"]                        = digi.mode;
+    data["digi"]["maxHops"]                     = digi.maxHops;
+    data["digi"]["viscousDelay"]                = digi.viscousDelay;
+    data["digi"]["dupeTime"]                    = digi.dupeTime;
+
+    data["linkAdaptation"]["active"]                = linkAdaptation.active;
+    data["linkAdaptation"]["targetMargin"]          = linkAdaptation.targetMargin;
+    data["linkAdaptation"]["hysteresis"]            = linkAdaptation.hysteresis;
+    data["linkAdaptation"]["minPower"]              = linkAdaptation.minPower;
+    data["linkAdaptation"]["minSpreadingFactor"]    = linkAdaptation.minSpreadingFactor;
+
+    data["afc"]["active"]                       = afc.active;
+    data["afc"]["maxCorrection"]                = afc.maxCorrection;
+
+    data["tdma"]["active"]                      = tdma.active;
+    data["tdma"]["frameLength"]                 = tdma.frameLength;
+    data["tdma"]["slotLength"]                  = tdma.slotLength;
+    data["tdma"]["slot"]                        = tdma.slot;
+
+    data["deepSleep"]["active"]                 = deepSleep.active;
+    data["deepSleep"]["interval"]               = deepSleep.interval;
+    data["deepSleep"]["fixTimeout"]             = deepSleep.fixTimeout;
+    data["deepSleep"]["motionPin"]              = deepSleep.motionPin;
+
+    data["diagnostics"]["heapTelemetry"]            = diagnostics.heapTelemetry;
+    data["diagnostics"]["heapTelemetryInterval"]    = diagnostics.heapTelemetryInterval;
+
     data["other"]["simplifiedTrackerMode"]      = simplifiedTrackerMode;
     data["other"]["sendCommentAfterXBeacons"]   = sendCommentAfterXBeacons;
     data["other"]["path"]                       = path;
@@ -84,6 +167,11 @@ void Configuration::writeFile() {
     data["other"]["standingUpdateTime"]         = standingUpdateTime;
     data["other"]["sendAltitude"]               = sendAltitude;
     data["other"]["disableGPS"]                 = disableGPS;
+    data["other"]["receiveFilter"]              = receiveFilter;
+    data["other"]["loraFraming"]                = loraFraming;
+    data["other"]["loraFec"]                    = loraFec;
+    data["other"]["compressComment"]            = compressComment;
+    data["other"]["lightSleep"]                 = lightSleep;
 
     serializeJson(data, configFile);
     configFile.close();
@@ -95,7 +183,7 @@ bool Configuration::readFile() {
     File configFile = SPIFFS.open("/tracker_conf.json", "r");
 
     if (configFile) {
-        StaticJsonDocument<2800> data;
+        StaticJsonDocument<3776> data;
         DeserializationError error = deserializeJson(data, configFile);
         if (error) {
             Serial.println("Failed to read file, using default configuration");
@@ -135,6 +223,7 @@ bool Configuration::readFile() {
         bme.active                      = data["bme"]["active"] | false;
         bme.temperatureCorrection       = data["bme"]["temperatureCorrection"] | 0.0;
         bme.sendTelemetry               = data["bme"]["sendTelemetry"] | false;
+        bme.sampleInterval              = data["bme"]["sampleInterval"] | 60;
 
         notification.ledTx              = data["notification"]["ledTx"] | false;
         notification.ledTxPin           = data["notification"]["ledTxPin"]| 13;
@@ -173,6 +262,33 @@ bool Configuration::readFile() {
         bluetooth.type                  = data["bluetooth"]["type"] | 1;
         bluetooth.active                = data["bluetooth"]["active"] | false;
 
+        digi.mode                       = data["digi"]["mode"] | 1;
+        digi.maxHops                    = data["digi"]["maxHops"] | 2;
+        digi.viscousDelay               = data["digi"]["viscousDelay"] | 5;
+        digi.dupeTime                   = data["digi"]["dupeTime"] | 30;
+
+        linkAdaptation.active               = data["linkAdaptation"]["active"] | false;
+        linkAdaptation.targetMargin         = data["linkAdaptation"]["targetMargin"] | 8;
+        linkAdaptation.hysteresis           = data["linkAdaptation"]["hysteresis"] | 3;
+        linkAdaptation.minPower             = data["linkAdaptation"]["minPower"] | 2;
+        linkAdaptation.minSpreadingFactor   = data["linkAdaptation"]["minSpreadingFactor"] | 0;
+
+        afc.active                      = data["afc"]["active"] | false;
+        afc.maxCorrection               = data["afc"]["maxCorrection"] | 5000;
+
+        tdma.active                     = data["tdma"]["active"] | false;
+        tdma.frameLength                = data["tdma"]["frameLength"] | 60;
+        tdma.slotLength                 = data["tdma"]["slotLength"] | 5;
+        tdma.slot                       = data["tdma"]["slot"] | -1;
+
+        deepSleep.active                = data["deepSleep"]["active"] | false;
+        deepSleep.interval              = data["deepSleep"]["interval"] | 15;
+        deepSleep.fixTimeout            = data["deepSleep"]["fixTimeout"] | 120;
+        deepSleep.motionPin             = data["deepSleep"]["motionPin"] | -1;
+
+        diagnostics.heapTelemetry           = data["diagnostics"]["heapTelemetry"] | false;
+        diagnostics.heapTelemetryInterval   = data["diagnostics"]["heapTelemetryInterval"] | 30;
+
         simplifiedTrackerMode           = data["other"]["simplifiedTrackerMode"] | false;
         sendCommentAfterXBeacons        = data["other"]["sendCommentAfterXBeacons"] | 10;
         path                            = data["other"]["path"] | "WIDE1-1";
@@ -182,6 +298,11 @@ bool Configuration::readFile() {
         sendAltitude                    = data["other"]["sendAltitude"] | true;
         disableGPS                      = data["other"]["disableGPS"] | false;
         acceptOwnFrameFromTNC           = data["other"]["acceptOwnFrameFromTNC"] | false;
+        receiveFilter                   = data["other"]["receiveFilter"] | "";
+        loraFraming                     = data["other"]["loraFraming"] | 0;
+        loraFec                         = data["other"]["loraFec"] | false;
+        compressComment                 = data["other"]["compressComment"] | false;
+        lightSleep                      = data["other"]["lightSleep"] | false;
 
         configFile.close();
         Serial.println("Config read successfuly");
@@ -245,6 +366,7 @@ void Configuration::init() {
     bme.active                      = false;
     bme.temperatureCorrection       = 0.0;
     bme.sendTelemetry               = false;
+    bme.sampleInterval              = 60;
 
     notification.ledTx              = false;
     notification.ledTxPin           = 13;
@@ -295,6 +417,33 @@ void Configuration::init() {
     bluetooth.type                  = 1;
     bluetooth.active                = false;
 
+    digi.mode                       = 1;
+    digi.maxHops                    = 2;
+    digi.viscousDelay               = 5;
+    digi.dupeTime                   = 30;
+
+    linkAdaptation.active               = false;
+    linkAdaptation.targetMargin         = 8;
+    linkAdaptation.hysteresis           = 3;
+    linkAdaptation.minPower             = 2;
+    linkAdaptation.minSpreadingFactor   = 0;
+
+    afc.active                      = false;
+    afc.maxCorrection               = 5000;
+
+    tdma.active                     = false;
+    tdma.frameLength                = 60;
+    tdma.slotLength                 = 5;
+    tdma.slot                       = -1;
+
+    deepSleep.active                = false;
+    deepSleep.interval              = 15;
+    deepSleep.fixTimeout            = 120;
+    deepSleep.motionPin             = -1;
+
+    diagnostics.heapTelemetry           = false;
+    diagnostics.heapTelemetryInterval   = 30;
+
     simplifiedTrackerMode           = false;
     sendCommentAfterXBeacons        = 10;
     path                            = "WIDE1-1";
@@ -304,20 +453,106 @@ void Configuration::init() {
     sendAltitude                    = true;
     disableGPS                      = false;
     acceptOwnFrameFromTNC           = false;
+    receiveFilter                   = "";
+    loraFraming                     = 0;
+    loraFec                         = false;
+    compressComment                 = false;
+    lightSleep                      = false;
+}
+
+
+// Every setting in the order of the class; a field added to readFile() must be added here too, one left out keeps
+// its init() default on a wake
+template <typename Stream>
+static void snapshotFields(Configuration& config, Stream& stream, bool writing) {
+    stream.field(config.wifiAP.active, writing);
+    stream.field(config.wifiAP.password, writing);
+    uint8_t beaconsSize = config.beacons.size();
+    stream.field(beaconsSize, writing);
+    if (!writing) config.beacons.resize(beaconsSize);
+    for (Beacon& bcn : config.beacons) {
+        stream.field(bcn.callsign, writing);
+        stream.field(bcn.symbol, writing);
+        stream.field(bcn.overlay, writing);
+        stream.field(bcn.comment, writing);
+        stream.field(bcn.smartBeaconActive, writing);
+        stream.field(bcn.smartBeaconSetting, writing);
+        stream.field(bcn.micE, writing);
+        stream.field(bcn.gpsEcoMode, writing);
+    }
+    stream.field(config.display, writing);
+    stream.field(config.battery, writing);
+    stream.field(config.winlink.password, writing);
+    stream.field(config.bme, writing);
+    stream.field(config.notification, writing);
+    uint8_t loraTypesSize = config.loraTypes.size();
+    stream.field(loraTypesSize, writing);
+    if (!writing) config.loraTypes.resize(loraTypesSize);
+    for (LoraType& loraType : config.loraTypes) {
+        stream.field(loraType, writing);
+    }
+    stream.field(config.ptt, writing);
+    stream.field(config.bluetooth, writing);
+    stream.field(config.digi, writing);
+    stream.field(config.linkAdaptation, writing);
+    stream.field(config.afc, writing);
+    stream.field(config.tdma, writing);
+    stream.field(config.deepSleep, writing);
+    stream.field(config.diagnostics, writing);
+    stream.field(config.simplifiedTrackerMode, writing);
+    stream.field(config.sendCommentAfterXBeacons, writing);
+    stream.field(config.path, writing);
+    stream.field(config.nonSmartBeaconRate, writing);
+    stream.field(config.rememberStationTime, writing);
+    stream.field(config.standingUpdateTime, writing);
+    stream.field(config.sendAltitude, writing);
+    stream.field(config.disableGPS, writing);
+    stream.field(config.acceptOwnFrameFromTNC, writing);
+    stream.field(config.receiveFilter, writing);
+    stream.field(config.loraFraming, writing);
+    stream.field(config.loraFec, writing);
+    stream.field(config.compressComment, writing);
+    stream.field(config.lightSleep, writing);
+}
 
-    Serial.println("New Data Created...");
+bool Configuration::saveSnapshot() {
+    SnapshotStream stream;
+    snapshotFields(*this, stream, true);
+    configSnapshotMagic     = stream.ok ? CONFIG_SNAPSHOT_MAGIC : 0;   // too large: the next wake reads the file
+    configSnapshotLayout    = CONFIG_SNAPSHOT_LAYOUT;
+    configSnapshotLength    = stream.position;
+    return stream.ok;
 }
 
+bool Configuration::loadSnapshot() {
+    if (configSnapshotMagic != CONFIG_SNAPSHOT_MAGIC) return false;
+    configSnapshotMagic = 0;        // used once, a later reset or a config change reads the file again
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) return false;
+    if (configSnapshotLayout != CONFIG_SNAPSHOT_LAYOUT) {
+        Serial.println("Config snapshot from another build, reading the file");
+        return false;
+    }
+    SnapshotStream stream;
+    snapshotFields(*this, stream, false);
+    if (!stream.ok || stream.position != configSnapshotLength) return false;
+    Serial.println("Config from RTC memory");
+    return true;
+}
 
 Configuration::Configuration() {
     if (!SPIFFS.begin(false)) {
         Serial.println("SPIFFS Mount Failed");
         return;
     }
+    init();         // whatever the snapshot does not carry keeps its default
+    if (loadSnapshot()) return;
+    beacons.clear();
+    loraTypes.clear();
 
     bool exists = SPIFFS.exists("/tracker_conf.json");
     if (!exists) {        
         init();
+        Serial.println("New Data Created...");
         writeFile();
         ESP.restart();
     }
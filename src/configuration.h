@@ -48,6 +48,7 @@ public:
     bool    active;
     float   temperatureCorrection;
     bool    sendTelemetry;
+    int     sampleInterval;     // seconds
 };
 
 class Notification {
@@ -93,6 +94,51 @@ public:
     bool    active;
 };
 
+class Digi {
+public:
+    byte    mode;               // 1: fill-in (WIDE1-1 only), 2: WIDEn-N
+    int     maxHops;
+    int     viscousDelay;
+    int     dupeTime;
+};
+
+class LinkAdaptation {
+public:
+    bool    active;
+    int     targetMargin;       // dB above the demodulation floor
+    int     hysteresis;
+    int     minPower;
+    int     minSpreadingFactor; // 0: keep the LoRa type spreading factor
+};
+
+class AFC {
+public:
+    bool    active;
+    int     maxCorrection;      // Hz
+};
+
+class TDMA {
+public:
+    bool    active;
+    int     frameLength;        // seconds, should divide a day
+    int     slotLength;         // seconds
+    int     slot;               // -1: from a hash of the callsign
+};
+
+class DeepSleep {
+public:
+    bool    active;
+    int     interval;           // minutes from wake to wake
+    int     fixTimeout;         // seconds of GPS search before this wake is given up
+    int     motionPin;          // RTC GPIO of a motion sensor, active high, -1: timer only
+};
+
+class Diagnostics {
+public:
+    bool    heapTelemetry;
+    int     heapTelemetryInterval;
+};
+
 
 class Configuration {
 public:
@@ -107,6 +153,12 @@ public:
     std::vector<LoraType>   loraTypes;
     PTT                     ptt;
     BLUETOOTH               bluetooth;
+    Digi                    digi;
+    LinkAdaptation          linkAdaptation;
+    AFC                     afc;
+    TDMA                    tdma;
+    DeepSleep               deepSleep;
+    Diagnostics             diagnostics;
     
     bool    simplifiedTrackerMode;
     int     sendCommentAfterXBeacons;
@@ -117,15 +169,22 @@ public:
     bool    sendAltitude;
     bool    disableGPS;
     bool    acceptOwnFrameFromTNC;
+    String  receiveFilter;
+    int     loraFraming;
+    bool    loraFec;
+    bool    compressComment;
+    bool    lightSleep;
 
     void init();
     void writeFile();
+    bool saveSnapshot();        // parsed settings to RTC memory, a deep sleep wake takes them instead of the JSON
     Configuration();
     bool validateConfigFile(const String& currentBeaconCallsign);
     bool validateMicE(const String& currentBeaconMicE);
 
 private:
     bool readFile();
+    bool loadSnapshot();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include <logger.h>
+#include "configuration.h"
+#include "frame_utils.h"
+#include "lora_utils.h"
+#include "hal_utils.h"
+#include "sleep_utils.h"
+#include "digi_utils.h"
+
+
+extern Configuration        Config;
+extern Beacon               *currentBeacon;
+extern logging::Logger      logger;
+extern bool                 digirepeaterActive;
+
+struct DigiDupe {
+    uint32_t    hash;
+    uint32_t    time;
+};
+
+struct DigiPending {
+    bool        active;
+    uint32_t    hash;
+    uint32_t    dueTime;
+    String      packet;
+};
+
+DigiDupe    digiDupes[DIGI_DUPE_SLOTS];
+uint8_t     digiDupeIndex           = 0;
+DigiPending digiPending[DIGI_PENDING_SLOTS];
+
+uint32_t    digiRepeated            = 0;
+uint32_t    digiDropped             = 0;
+uint32_t    digiCancelled           = 0;
+
+
+namespace DIGI_Utils {
+
+    static uint32_t hashBytes(uint32_t hash, const char *data, int length) {
+        for (int i = 0; i < length; i++) {     // FNV-1a
+            hash ^= (uint8_t)data[i];
+            hash *= 16777619;
+        }
+        return hash;
+    }
+
+    static uint32_t frameHash(const String& packet, int destEnd, int payloadStart) {
+        // Source, destination and payload only: copies repeated by other digis differ just in the path
+        uint32_t hash = hashBytes(2166136261, packet.c_str(), destEnd);
+        return hashBytes(hash, packet.c_str() + payloadStart, packet.length() - payloadStart);
+    }
+
+    static bool isDupe(uint32_t hash) {
+        for (int i = 0; i < DIGI_DUPE_SLOTS; i++) {
+            if (digiDupes[i].hash == hash && digiDupes[i].time != 0 && HAL::now() - digiDupes[i].time < (uint32_t)Config.digi.dupeTime * 1000) return true;
+        }
+        return false;
+    }
+
+    static void addDupe(uint32_t hash) {
+        digiDupes[digiDupeIndex].hash = hash;
+        digiDupes[digiDupeIndex].time = HAL::now();
+        digiDupeIndex = (digiDupeIndex + 1) % DIGI_DUPE_SLOTS;
+    }
+
+    static void send(const String& packet, uint32_t hash) {
+        LoRa_Utils::sendNewPacket(packet, false);       // repeated frames serve other stations, never link adapted or reframed
+        addDupe(hash);
+        digiRepeated++;
+    }
+
+    static bool cancelPending(uint32_t hash) {
+        for (int i = 0; i < DIGI_PENDING_SLOTS; i++) {
+            if (digiPending[i].active && digiPending[i].hash == hash) {
+                digiPending[i].active = false;
+                digiPending[i].packet = "";
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool schedule(const String& packet, uint32_t hash) {
+        for (int i = 0; i < DIGI_PENDING_SLOTS; i++) {
+            if (!digiPending[i].active) {
+                digiPending[i].active   = true;
+                digiPending[i].hash     = hash;
+                digiPending[i].dueTime  = HAL::now() + Config.digi.viscousDelay * 1000;
+                digiPending[i].packet   = packet;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static int parseWide(const String& element, uint8_t& hops) {
+        // "WIDEn-N" -> returns N and sets n, -1 if it isn't a WIDEn-N alias
+        if (element.length() != 7 || !element.startsWith("WIDE") || element[5] != '-') return -1;
+        char n = element[4];
+        char N = element[6];
+        if (n < '1' || n > '7' || N < '0' || N > '7') return -1;
+        hops = n - '0';
+        return N - '0';
+    }
+
+    void processPacket(const String& packet, const FrameHeader& header) {
+        if (!digirepeaterActive || !header.valid) return;
+
+        uint32_t hash = frameHash(packet, header.destEnd, header.payloadStart);
+        const String& callsign = currentBeacon->callsign;
+
+        String path = FRAME_Utils::getPath(packet, header);
+        if (path.indexOf('*') != -1 && cancelPending(hash)) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Digi", "Heard repeated by another digi, cancelled");
+            digiCancelled++;
+            return;
+        }
+        if (header.pathStart == -1 || FRAME_Utils::getSource(packet, header) == callsign || FRAME_Utils::isAddressedTo(packet, header, callsign)) return;
+
+        String elements[DIGI_MAX_PATH_ELEMENTS];
+        uint8_t count       = 0;
+        int nextHop         = 0;
+        int start           = 0;
+        while (start <= (int)path.length()) {
+            int end = path.indexOf(',', start);
+            if (end == -1) end = path.length();
+            if (count == DIGI_MAX_PATH_ELEMENTS) {
+                digiDropped++;
+                return;
+            }
+            elements[count] = path.substring(start, end);
+            if (elements[count].endsWith("*")) {
+                elements[count].remove(elements[count].length() - 1);
+                nextHop = count + 1;
+            }
+            count++;
+            start = end + 1;
+        }
+        if (nextHop >= count) return;
+        for (int i = 0; i < nextHop; i++) {
+            if (elements[i] == callsign) {       // already went through us
+                digiDropped++;
+                return;
+            }
+        }
+
+        // Preemptive: our callsign anywhere ahead in the path is served now, the hops before it are skipped
+        int skipTo = nextHop;
+        for (int i = nextHop; i < count; i++) {
+            if (elements[i] == callsign) {
+                skipTo = i;
+                break;
+            }
+        }
+
+        // New path: used hops without marks, then our trace, with '*' after the last used element only
+        String hop      = elements[skipTo];
+        String newHops;
+        bool preemptive = false;
+        uint8_t hops    = 0;
+        int remaining   = parseWide(hop, hops);
+        if (hop == callsign) {
+            newHops     = callsign + "*";
+            preemptive  = true;
+        } else if (hop == "WIDE1-1") {
+            newHops     = callsign + ",WIDE1*";
+        } else if (Config.digi.mode == 2 && remaining > 0) {
+            if (hops > Config.digi.maxHops || remaining > hops) {
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Digi", "%s exceeds max hops", hop.c_str());
+                digiDropped++;
+                return;
+            }
+            remaining--;
+            newHops = callsign;
+            newHops += (remaining == 0) ? ",WIDE" + String(hops) + "*" : "*,WIDE" + String(hops) + "-" + String(remaining);
+        } else {
+            return;
+        }
+        if (!preemptive && count == DIGI_MAX_PATH_ELEMENTS) {
+            digiDropped++;
+            return;
+        }
+        if (isDupe(hash)) {
+            digiDropped++;
+            return;
+        }
+
+        String newPacket = packet.substring(0, header.pathStart);
+        for (int i = 0; i < nextHop; i++) {
+            newPacket += elements[i];
+            newPacket += ",";
+        }
+        newPacket += newHops;
+        for (int i = skipTo + 1; i < count; i++) {
+            newPacket += ",";
+            newPacket += elements[i];
+        }
+        newPacket += packet.substring(header.payloadStart);
+
+        if (preemptive || Config.digi.viscousDelay == 0) {
+            send(newPacket, hash);
+        } else if (schedule(newPacket, hash)) {
+            addDupe(hash);
+        } else {
+            digiDropped++;
+        }
+    }
+
+    void checkPending() {
+        for (int i = 0; i < DIGI_PENDING_SLOTS; i++) {
+            if (digiPending[i].active && (int32_t)(HAL::now() - digiPending[i].dueTime) >= 0) {
+                digiPending[i].active = false;
+                LoRa_Utils::sendNewPacket(digiPending[i].packet, false);
+                digiPending[i].packet = "";
+                digiRepeated++;
+            } else if (digiPending[i].active) {
+                SLEEP_Utils::wakeBy(digiPending[i].dueTime);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,19 @@
+#ifndef DIGI_UTILS_H_
+#define DIGI_UTILS_H_
+
+#include <Arduino.h>
+#include "frame_utils.h"
+
+#define DIGI_DUPE_SLOTS         16
+#define DIGI_PENDING_SLOTS      4
+#define DIGI_MAX_PATH_ELEMENTS  8
+
+
+namespace DIGI_Utils {
+
+    void    processPacket(const String& packet, const FrameHeader& header);
+    void    checkPending();
+
+}
+
+#endif
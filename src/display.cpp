@@ -3,10 +3,12 @@
 #include "custom_characters.h"
 #include "configuration.h"
 #include "boards_pinout.h"
+#include "power_utils.h"
+#include "boot_utils.h"
 #include "display.h"
 #include "TimeLib.h"
 
-String currentSymbol, lastSymbol, lastHeader;
+String lastHeader;
 
 #ifdef HAS_TFT
     #include <TFT_eSPI.h>
@@ -64,15 +66,32 @@ const uint8_t *symbolsAPRS[]  = {runnerSymbol, carSymbol, jeepSymbol, bikeSymbol
 // Uncomment Next Line (Remember ONLY if your OLED Screen has a RST pin). This is to avoid memory issues.
 //#define OLED_DISPLAY_HAS_RST_PIN
 
-int         lastMenuDisplay         = 0;
 uint8_t     screenBrightness        = 1;    //from 1 to 255 to regulate brightness of oled scren
 bool        symbolAvailable         = true;
+bool        displayInitialized      = false;    // a deep sleep wake leaves the panel off and uninitialized
+
+// Retained screen model: the last frame's text, symbol and brightness. A refresh only touches what changed.
+String      lastLines[5];
+int         lastSymbolIndex         = -1;       // -1: none, symbolArraySize: bluetooth
+uint8_t     lastBrightness          = 0;
+bool        screenInvalid           = true;
+
+// Timed overlay: a screen shown with a hold time stays up while the loop keeps running, then reverts.
+bool        overlayActive           = false;
+uint32_t    overlayStartTime        = 0;
+uint32_t    overlayHoldTime         = 0;
+
+uint32_t    displayRefreshes        = 0;
+uint32_t    displaySkipped          = 0;
+uint32_t    displayBytesPushed      = 0;        // pixel data: I2C bytes on OLED, RGB565 bytes over SPI on TFT
 
 extern logging::Logger logger;
 
 void cleanTFT() {
     #ifdef HAS_TFT
+        if (!displayInitialized) return;
         tft.fillScreen(TFT_BLACK);
+        screenInvalid = true;
     #endif
 }
 
@@ -85,7 +104,7 @@ String fillStringLength(const String& line, uint8_t length) {
 }
 
 void displaySetup() {
-    delay(500);
+    BOOT_Utils::waitSince(BOOT_POWER, 500);     // panel rails come up with POWER_Utils::setup(), storage and GPS ran meanwhile
     #ifdef HAS_TFT
         tft.init();
         tft.begin();
@@ -137,9 +156,21 @@ void displaySetup() {
         #endif
         display.display();
     #endif
+    displayInitialized  = true;
+    screenInvalid       = true;
+}
+
+void displayWakeSetup() {
+    #ifndef HAS_TFT
+        Wire.begin(OLED_SDA, OLED_SCL);     // the sensors and keyboard share the panel's bus
+    #endif
 }
 
 void displayToggle(bool toggle) {
+    if (!displayInitialized) {
+        if (!toggle) return;
+        displaySetup();         // first screen after a deep sleep wake
+    }
     if (toggle) {
         #ifdef HAS_TFT
             digitalWrite(TFT_BL, HIGH);
@@ -163,132 +194,174 @@ void displayToggle(bool toggle) {
     }
 }
 
-void displayShow(const String& header, const String& line1, const String& line2, int wait) {
-    #ifdef HAS_TFT
-        String filledLine1 = fillStringLength(line1, 22);
-        String filledLine2 = fillStringLength(line2, 22);
-        const String* const lines[] = {&filledLine1, &filledLine2};
-        
-        cleanTFT();
-        tft.setTextColor(TFT_WHITE,TFT_BLACK);
-        tft.setTextSize(bigSizeFont);
-        tft.setCursor(0, 0);
-
-        if (header != lastHeader) {
-            tft.print(fillStringLength(header, 11));
-            lastHeader = header;
-        } else {
-            tft.print(header);
-        }
+#ifndef HAS_TFT
+    uint8_t     oledShadow[128 * 64 / 8];       // what the controller's GDDRAM currently holds
 
-        tft.setTextSize(smallSizeFont);
-        for (int i = 0; i < 2; i++) {
-            tft.setCursor(0, ((lineSpacing * (2 + i)) - 2));
-            tft.print(*lines[i]);
-        }
-    #else
-        const String* const lines[] = {&line1, &line2};
-
-        display.clearDisplay();
+    void oledSetWindow(uint8_t page, uint8_t firstColumn, uint8_t lastColumn) {
         #ifdef ssd1306
-            display.setTextColor(WHITE);
+            display.ssd1306_command(SSD1306_PAGEADDR);
+            display.ssd1306_command(page);
+            display.ssd1306_command(page);
+            display.ssd1306_command(SSD1306_COLUMNADDR);
+            display.ssd1306_command(firstColumn);
+            display.ssd1306_command(lastColumn);
         #else
-            display.setTextColor(SH110X_WHITE);
+            uint8_t column = firstColumn + 2;   // SH1106 has 132 columns, the visible 128 start at 2
+            display.oled_command(SH110X_SETPAGEADDR + page);
+            display.oled_command(0x10 + (column >> 4));
+            display.oled_command(column & 0x0F);
         #endif
-        display.setTextSize(2);
-        display.setCursor(0, 0);
-        display.println(header);
-        display.setTextSize(1);
-        for (int i = 0; i < 2; i++) {
-            display.setCursor(0, 16 + (10 * i));
-            display.println(*lines[i]);
+    }
+
+    void oledFlush() {
+        // Push only the changed column span of each changed page instead of the whole 1 KB framebuffer
+        uint8_t *buffer = display.getBuffer();
+        Wire.setClock(400000);
+        for (uint8_t page = 0; page < 8; page++) {
+            int firstColumn = -1;
+            int lastColumn  = -1;
+            for (int column = 0; column < 128; column++) {
+                if (buffer[page * 128 + column] != oledShadow[page * 128 + column]) {
+                    if (firstColumn < 0) firstColumn = column;
+                    lastColumn = column;
+                }
+            }
+            if (screenInvalid) {                // controller RAM not known to match the shadow: whole page
+                firstColumn = 0;
+                lastColumn  = 127;
+            }
+            if (firstColumn < 0) continue;
+
+            oledSetWindow(page, firstColumn, lastColumn);
+            int index = page * 128 + firstColumn;
+            int end   = page * 128 + lastColumn + 1;
+            while (index < end) {
+                int chunk = min(end - index, 31);
+                Wire.beginTransmission(0x3c);
+                Wire.write((uint8_t)0x40);
+                Wire.write(buffer + index, chunk);
+                Wire.endTransmission();
+                index += chunk;
+            }
+            memcpy(oledShadow + page * 128 + firstColumn, buffer + page * 128 + firstColumn, lastColumn - firstColumn + 1);
+            displayBytesPushed += lastColumn - firstColumn + 1;
         }
-        #ifdef ssd1306
-            display.ssd1306_command(SSD1306_SETCONTRAST);
-            display.ssd1306_command(screenBrightness);
-        #else
-            display.setContrast(screenBrightness);
-        #endif
-        display.display();
+        Wire.setClock(100000);
+    }
+#else
+    #ifdef HELTEC_WIRELESS_TRACKER
+        #define SYMBOL_X    (TFT_WIDTH - SYMBOL_WIDTH + (128 - TFT_WIDTH))
+    #endif
+    #ifdef TTGO_T_DECK_GPS
+        #define SYMBOL_X    (TFT_WIDTH - SYMBOL_WIDTH)
     #endif
-    delay(wait);
+
+    void tftPrintChanged(const String& text, const String& lastText, int y, uint8_t textSize, uint8_t width) {
+        // Redraw only the runs of glyph cells that differ from the previous frame
+        int charWidth   = 6 * textSize;
+        int length      = max(max(text.length(), lastText.length()), (unsigned int)width);
+        String newText  = fillStringLength(text, length);
+        String oldText  = fillStringLength(lastText, length);
+        int i = 0;
+        while (i < length) {
+            if (!screenInvalid && newText[i] == oldText[i]) {
+                i++;
+                continue;
+            }
+            int start = i;
+            while (i < length && (screenInvalid || newText[i] != oldText[i])) {
+                i++;
+            }
+            tft.setCursor(start * charWidth, y);
+            tft.print(newText.substring(start, i));
+            displayBytesPushed += (i - start) * charWidth * 8 * textSize * 2;
+        }
+    }
+#endif
+
+int getSymbolIndex() {
+    int symbol = 100;
+    for (int i = 0; i < symbolArraySize; i++) {
+        if (currentBeacon->symbol == symbolArray[i]) {
+            symbol = i;
+            break;
+        }
+    }
+
+    symbolAvailable = symbol != 100;
+
+    /*
+    * Symbol alternate every 5s
+    * If bluetooth is disconnected or if we are in the first part of the clock, then we show the APRS symbol
+    * Otherwise, we are in the second part of the clock, then we show BT connected
+    */
+    const auto time_now = now();
+    if (!bluetoothConnected || time_now % 10 < 5) {
+        return symbolAvailable ? symbol : -1;
+    } else {
+        // TODO In this case, the text symbol stay displayed due to symbolAvailable false in menu_utils
+        return symbolArraySize;
+    }
 }
 
-void displayShow(const String& header, const String& line1, const String& line2, const String& line3, const String& line4, const String& line5, int wait) {
+bool displayOverlayActive() {
+    return overlayActive && millis() - overlayStartTime < overlayHoldTime;
+}
+
+bool displayOverlayExpired() {
+    if (overlayActive && millis() - overlayStartTime >= overlayHoldTime) {
+        overlayActive = false;
+        return true;
+    }
+    return false;
+}
+
+void displayDismissOverlay() {
+    overlayActive = false;
+}
+
+void showScreen(const String& header, const String* const lines[], bool withSymbol, int wait) {
+    if (!displayInitialized) return;
+    if (wait > 0) {
+        overlayActive       = true;
+        overlayStartTime    = millis();
+        overlayHoldTime     = wait;
+    }
+    int symbolIndex = (withSymbol && menuDisplay == 0 && Config.display.showSymbol) ? getSymbolIndex() : -1;
+    #ifdef DISPLAY_FULL_REFRESH
+        screenInvalid = true;       // profiler reference: every call redraws and pushes the whole screen, as display() did
+    #endif
+
+    bool changed = screenInvalid || header != lastHeader || symbolIndex != lastSymbolIndex || screenBrightness != lastBrightness;
+    for (int i = 0; i < 5 && !changed; i++) {
+        if (*lines[i] != lastLines[i]) changed = true;
+    }
+    if (!changed) {
+        displaySkipped++;
+        return;
+    }
+    displayRefreshes++;
+    CPU_BOOST();
+
     #ifdef HAS_TFT
-        String filledLine1  = fillStringLength(line1, 22);
-        String filledLine2  = fillStringLength(line2, 22);
-        String filledLine3  = fillStringLength(line3, 22);
-        String filledLine4  = fillStringLength(line4, 22);
-        String filledLine5  = fillStringLength(line5, 22);
-        const String* const lines[] = {&filledLine1, &filledLine2, &filledLine3, &filledLine4, &filledLine5};
-
-        if (menuDisplay != lastMenuDisplay) {
-            lastMenuDisplay = menuDisplay;
-            cleanTFT();
-        }
-        //tft.setTextColor(TFT_RED,TFT_BLACK);
         tft.setTextColor(TFT_WHITE,TFT_BLACK);
         tft.setTextSize(bigSizeFont);
-        tft.setCursor(0, 0);
-
-        if (header != lastHeader) {
-            tft.print(fillStringLength(header, 11));
-            lastHeader = header;
-        } else {
-            tft.print(header);
-        }
+        tftPrintChanged(header, lastHeader, 0, bigSizeFont, 11);
 
         tft.setTextSize(smallSizeFont);
         for (int i = 0; i < 5; i++) {
-            tft.setCursor(0, ((lineSpacing * (2 + i)) - 2));
-            tft.print(*lines[i]);
+            tftPrintChanged(*lines[i], lastLines[i], ((lineSpacing * (2 + i)) - 2), smallSizeFont, 22);
         }
-        if (menuDisplay == 0 && Config.display.showSymbol) {
-            int symbol = 100;
-            for (int i = 0; i < symbolArraySize; i++) {
-                if (currentBeacon->symbol == symbolArray[i]) {
-                    symbol = i;
-                    break;
-                }
-            }
 
-            symbolAvailable = symbol != 100;
-
-            /*
-            * Symbol alternate every 5s
-            * If bluetooth is disconnected or if we are in the first part of the clock, then we show the APRS symbol
-            * Otherwise, we are in the second part of the clock, then we show BT connected
-            */
-
-            const auto time_now = now();
-            if (!bluetoothConnected || time_now % 10 < 5) {
-                if (symbolAvailable) {
-                    currentSymbol = symbolArray[symbol];
-                    #if HELTEC_WIRELESS_TRACKER
-                        if (currentSymbol != lastSymbol) {
-                            tft.fillRect((TFT_WIDTH - SYMBOL_WIDTH + (128 - TFT_WIDTH)), 0, SYMBOL_WIDTH, SYMBOL_HEIGHT, TFT_BLACK);
-                            lastSymbol = currentSymbol;
-                        }
-                        tft.drawBitmap((TFT_WIDTH - SYMBOL_WIDTH + (128 - TFT_WIDTH)), 0, symbolsAPRS[symbol], SYMBOL_WIDTH, SYMBOL_HEIGHT, TFT_WHITE);//, TFT_RED);
-                    #endif
-                    #if TTGO_T_DECK_GPS
-                        tft.drawBitmap((TFT_WIDTH - SYMBOL_WIDTH), 0, symbolsAPRS[symbol], SYMBOL_WIDTH, SYMBOL_HEIGHT, TFT_WHITE);//, TFT_RED);
-                    #endif
-                }
-            } else if (bluetoothConnected) {    // TODO In this case, the text symbol stay displayed due to symbolAvailable false in menu_utils
-                #if HELTEC_WIRELESS_TRACKER
-                    tft.drawBitmap((TFT_WIDTH - SYMBOL_WIDTH + (128 - TFT_WIDTH)), 0, bluetoothSymbol, SYMBOL_WIDTH, SYMBOL_HEIGHT, TFT_WHITE);
-                #endif
-                #if TTGO_T_DECK_GPS
-                    tft.drawBitmap((TFT_WIDTH - SYMBOL_WIDTH), 0, bluetoothSymbol, SYMBOL_WIDTH, SYMBOL_HEIGHT, TFT_WHITE);
-                #endif
+        if (screenInvalid || symbolIndex != lastSymbolIndex || header != lastHeader) {
+            tft.fillRect(SYMBOL_X, 0, SYMBOL_WIDTH, SYMBOL_HEIGHT, TFT_BLACK);
+            displayBytesPushed += SYMBOL_WIDTH * SYMBOL_HEIGHT * 2;
+            if (symbolIndex >= 0) {
+                const uint8_t *bitmap = (symbolIndex == symbolArraySize) ? bluetoothSymbol : symbolsAPRS[symbolIndex];
+                tft.drawBitmap(SYMBOL_X, 0, bitmap, SYMBOL_WIDTH, SYMBOL_HEIGHT, TFT_WHITE);
             }
         }
-
     #else
-        const String* const lines[] = {&line1, &line2, &line3, &line4, &line5};
-
         display.clearDisplay();
         #ifdef ssd1306
             display.setTextColor(WHITE);
@@ -303,43 +376,38 @@ void displayShow(const String& header, const String& line1, const String& line2,
             display.setCursor(0, 16 + (10 * i));
             display.println(*lines[i]);
         }
-        #ifdef ssd1306
-            display.ssd1306_command(SSD1306_SETCONTRAST);
-            display.ssd1306_command(screenBrightness);
-        #else
-            display.setContrast(screenBrightness);
-        #endif
-
-        if (menuDisplay == 0 && Config.display.showSymbol) {
-            int symbol = 100;
-            for (int i = 0; i < symbolArraySize; i++) {
-                if (currentBeacon->symbol == symbolArray[i]) {
-                    symbol = i;
-                    break;
-                }
-            }
-
-            symbolAvailable = symbol != 100;
-
-            /*
-            * Symbol alternate every 5s
-            * If bluetooth is disconnected or if we are in the first part of the clock, then we show the APRS symbol
-            * Otherwise, we are in the second part of the clock, then we show BT connected
-            */
-            const auto time_now = now();
-            if (!bluetoothConnected || time_now % 10 < 5) {
-                if (symbolAvailable) {
-                    display.drawBitmap((display.width() - SYMBOL_WIDTH), 0, symbolsAPRS[symbol], SYMBOL_WIDTH, SYMBOL_HEIGHT, 1);
-                }
-            } else if (bluetoothConnected) {
-                // TODO In this case, the text symbol stay displayed due to symbolAvailable false in menu_utils
-                display.drawBitmap((display.width() - SYMBOL_WIDTH), 0, bluetoothSymbol, SYMBOL_WIDTH, SYMBOL_HEIGHT, 1);
-            }
+        if (symbolIndex >= 0) {
+            const uint8_t *bitmap = (symbolIndex == symbolArraySize) ? bluetoothSymbol : symbolsAPRS[symbolIndex];
+            display.drawBitmap((display.width() - SYMBOL_WIDTH), 0, bitmap, SYMBOL_WIDTH, SYMBOL_HEIGHT, 1);
         }
-        
-        display.display();
+        if (screenBrightness != lastBrightness) {
+            #ifdef ssd1306
+                display.ssd1306_command(SSD1306_SETCONTRAST);
+                display.ssd1306_command(screenBrightness);
+            #else
+                display.setContrast(screenBrightness);
+            #endif
+        }
+        oledFlush();
     #endif
-    delay(wait);
+    for (int i = 0; i < 5; i++) {
+        lastLines[i] = *lines[i];
+    }
+    lastHeader      = header;
+    lastSymbolIndex = symbolIndex;
+    lastBrightness  = screenBrightness;
+    screenInvalid   = false;
+}
+
+void displayShow(const String& header, const String& line1, const String& line2, int wait) {
+    const String emptyLine = "";
+    const String* const lines[] = {&line1, &line2, &emptyLine, &emptyLine, &emptyLine};
+    showScreen(header, lines, false, wait);
+}
+
+void displayShow(const String& header, const String& line1, const String& line2, const String& line3, const String& line4, const String& line5, int wait) {
+    const String* const lines[] = {&line1, &line2, &line3, &line4, &line5};
+    showScreen(header, lines, true, wait);
 }
 
 void startupScreen(uint8_t index, const String& version) {
@@ -349,10 +417,7 @@ void startupScreen(uint8_t index, const String& version) {
         case 1: workingFreq += "PL]"; break;
         case 2: workingFreq += "UK]"; break;
     }
-    displayShow(" LoRa APRS", "      (TRACKER)", workingFreq, "", "", "  CA2RXU  " + version, 4000);
-    #ifdef HAS_TFT
-        cleanTFT();
-    #endif
+    displayShow(" LoRa APRS", "      (TRACKER)", workingFreq, "", "", "  CA2RXU  " + version, 4000);     // held while the boot goes on
     logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Main", "RichonGuzman (CA2RXU) --> LoRa APRS Tracker/Station");
     logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Main", "Version: %s", version);
 }
@@ -2,9 +2,16 @@
 #define DISPLAY_H_
 
 void displaySetup();
+// Deep sleep wake: the panel stays off and is set up by the first displayToggle(true), drawing is ignored until then.
+void displayWakeSetup();
 void displayToggle(bool toggle);
 void cleanTFT();
 
+bool displayOverlayActive();
+bool displayOverlayExpired();
+void displayDismissOverlay();
+
+// wait > 0 shows the screen as an overlay held for wait ms; it does not block.
 void displayShow(const String& header, const String& line1, const String& line2, int wait = 0);
 void displayShow(const String& header, const String& line1, const String& line2, const String& line3, const String& line4, const String& line5, int wait = 0);
 
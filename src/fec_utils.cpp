@@ -0,0 +1,150 @@
+#include "fec_utils.h"
+
+/*
+ * Reed-Solomon over GF(256), field polynomial 0x11d, generator roots alpha^1 .. alpha^16 (FX.25 parameters).
+ * Codeword byte k of n stands for the coefficient of x^(n-1-k), parity closes the codeword. Decoding is
+ * syndromes, Berlekamp-Massey, Chien search and Forney, all through log/antilog tables.
+ */
+
+#define FEC_FIRST_ROOT  1
+
+uint8_t     fecExp[512];
+uint8_t     fecLog[256];
+uint8_t     fecGenerator[FEC_PARITY + 1];       // monic, fecGenerator[i] is the coefficient of x^i
+bool        fecReady    = false;
+
+
+namespace FEC_Utils {
+
+    static inline uint8_t multiply(uint8_t a, uint8_t b) {
+        return (a == 0 || b == 0) ? 0 : fecExp[fecLog[a] + fecLog[b]];
+    }
+
+    static inline uint8_t divide(uint8_t a, uint8_t b) {
+        return (a == 0) ? 0 : fecExp[fecLog[a] + 255 - fecLog[b]];
+    }
+
+    static void buildTables() {
+        uint16_t value = 1;
+        for (int i = 0; i < 255; i++) {
+            fecExp[i]           = value;
+            fecExp[i + 255]     = value;
+            fecLog[value]       = i;
+            value <<= 1;
+            if (value & 0x100) value ^= 0x11d;
+        }
+        fecExp[510] = fecExp[0];
+        fecExp[511] = fecExp[1];
+        fecLog[0]   = 0;
+
+        memset(fecGenerator, 0, sizeof(fecGenerator));
+        fecGenerator[0] = 1;
+        for (int i = 0; i < FEC_PARITY; i++) {          // multiply by (x + alpha^(FEC_FIRST_ROOT + i))
+            uint8_t root = fecExp[FEC_FIRST_ROOT + i];
+            for (int j = i + 1; j > 0; j--) {
+                fecGenerator[j] = fecGenerator[j - 1] ^ multiply(fecGenerator[j], root);
+            }
+            fecGenerator[0] = multiply(fecGenerator[0], root);
+        }
+        fecReady = true;
+    }
+
+    void encode(const uint8_t* data, size_t length, uint8_t* parity) {
+        if (!fecReady) buildTables();
+        memset(parity, 0, FEC_PARITY);
+        for (size_t i = 0; i < length; i++) {
+            uint8_t feedback = data[i] ^ parity[0];
+            if (feedback == 0) {
+                memmove(parity, parity + 1, FEC_PARITY - 1);
+                parity[FEC_PARITY - 1] = 0;
+                continue;
+            }
+            uint8_t feedbackLog = fecLog[feedback];
+            for (int j = 0; j < FEC_PARITY - 1; j++) {
+                parity[j] = parity[j + 1] ^ fecExp[feedbackLog + fecLog[fecGenerator[FEC_PARITY - 1 - j]]];
+            }
+            parity[FEC_PARITY - 1] = fecExp[feedbackLog + fecLog[fecGenerator[0]]];
+        }
+    }
+
+    int decode(uint8_t* codeword, size_t length) {
+        if (length <= FEC_PARITY || length > FEC_MAX_CODEWORD) return -1;
+        if (!fecReady) buildTables();
+
+        uint8_t syndromes[FEC_PARITY];
+        bool    clean = true;
+        for (int i = 0; i < FEC_PARITY; i++) {
+            uint8_t rootLog = FEC_FIRST_ROOT + i;
+            uint8_t value   = 0;
+            for (size_t k = 0; k < length; k++) {      // Horner
+                value = (value == 0 ? 0 : fecExp[fecLog[value] + rootLog]) ^ codeword[k];
+            }
+            syndromes[i] = value;
+            if (value != 0) clean = false;
+        }
+        if (clean) return 0;
+
+        // Berlekamp-Massey: error locator lambda(x) of degree errors
+        uint8_t lambda[FEC_PARITY + 1]  = {1};
+        uint8_t previous[FEC_PARITY + 1] = {1};
+        int     errors                  = 0;
+        int     shift                   = 1;
+        uint8_t previousDiscrepancy     = 1;
+        for (int r = 0; r < FEC_PARITY; r++) {
+            uint8_t discrepancy = syndromes[r];
+            for (int i = 1; i <= errors; i++) discrepancy ^= multiply(lambda[i], syndromes[r - i]);
+            if (discrepancy == 0) {
+                shift++;
+                continue;
+            }
+            uint8_t scale = divide(discrepancy, previousDiscrepancy);
+            if (2 * errors <= r) {
+                uint8_t saved[FEC_PARITY + 1];
+                memcpy(saved, lambda, sizeof(saved));
+                for (int i = 0; i + shift <= FEC_PARITY; i++) lambda[i + shift] ^= multiply(scale, previous[i]);
+                errors              = r + 1 - errors;
+                memcpy(previous, saved, sizeof(previous));
+                previousDiscrepancy = discrepancy;
+                shift               = 1;
+            } else {
+                for (int i = 0; i + shift <= FEC_PARITY; i++) lambda[i + shift] ^= multiply(scale, previous[i]);
+                shift++;
+            }
+        }
+        if (errors > FEC_PARITY / 2) return -1;
+
+        // Error evaluator omega(x) = S(x) lambda(x) mod x^FEC_PARITY
+        uint8_t omega[FEC_PARITY];
+        for (int i = 0; i < FEC_PARITY; i++) {
+            uint8_t value = 0;
+            for (int j = 0; j <= i && j <= errors; j++) value ^= multiply(lambda[j], syndromes[i - j]);
+            omega[i] = value;
+        }
+
+        // Chien search over the positions present in the shortened codeword, Forney for the values
+        int found = 0;
+        for (size_t k = 0; k < length && found < errors; k++) {
+            int     power       = (length - 1 - k) % 255;      // error locator X = alpha^power
+            int     inverseLog  = (255 - power) % 255;          // X^-1
+            uint8_t value       = 0;
+            for (int i = 0; i <= errors; i++) {
+                if (lambda[i]) value ^= fecExp[(fecLog[lambda[i]] + inverseLog * i) % 255];
+            }
+            if (value != 0) continue;
+
+            uint8_t numerator = 0;
+            for (int i = 0; i < FEC_PARITY; i++) {
+                if (omega[i]) numerator ^= fecExp[(fecLog[omega[i]] + inverseLog * i) % 255];
+            }
+            uint8_t derivative = 0;                             // odd terms of lambda'(X^-1)
+            for (int i = 1; i <= errors; i += 2) {
+                if (lambda[i]) derivative ^= fecExp[(fecLog[lambda[i]] + inverseLog * (i - 1)) % 255];
+            }
+            if (derivative == 0) return -1;
+            codeword[k] ^= divide(numerator, derivative);      // X^(1 - FEC_FIRST_ROOT) omega(X^-1) / lambda'(X^-1), X^0 here
+            found++;
+        }
+        return (found == errors) ? found : -1;
+    }
+
+}
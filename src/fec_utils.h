@@ -0,0 +1,17 @@
+#ifndef FEC_UTILS_H_
+#define FEC_UTILS_H_
+
+#include <Arduino.h>
+
+#define FEC_PARITY          16          // Reed-Solomon parity bytes, corrects 8 byte errors as FX.25 RS(255,239) does
+#define FEC_MAX_CODEWORD    255         // data + parity, shorter frames are a shortened code
+
+
+namespace FEC_Utils {
+
+    void    encode(const uint8_t* data, size_t length, uint8_t* parity);
+    int     decode(uint8_t* codeword, size_t length);      // corrects in place, number of bytes fixed or -1
+
+}
+
+#endif
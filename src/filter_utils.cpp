@@ -0,0 +1,240 @@
+#include <logger.h>
+#include "filter_utils.h"
+#include "geo_utils.h"
+
+
+extern logging::Logger      logger;
+
+enum FilterOp {
+    FILTER_BUDDY,
+    FILTER_PREFIX,
+    FILTER_TYPE,
+    FILTER_DIGI,
+    FILTER_RANGE,
+    FILTER_MY_RANGE
+};
+
+struct FilterTerm {
+    uint8_t     op;
+    bool        exclude;
+    uint16_t    typeMask;
+    float       latitude;
+    float       longitude;
+    float       range;          // m
+    uint8_t     patternCount;
+    String      patterns[FILTER_MAX_PATTERNS];
+};
+
+// Compiled program: exclusions first, then inclusions, each with the position terms (which need a decode) last
+FilterTerm  filterTerms[FILTER_MAX_TERMS];
+uint8_t     filterTermCount         = 0;
+uint8_t     filterExclusionCount    = 0;
+
+const char  filterTypeChars[]       = "poimqstunw";
+
+bool        filterHasPosition       = false;
+float       filterLatitude          = 0;
+float       filterLongitude         = 0;
+
+
+namespace FILTER_Utils {
+
+    static uint16_t typeBit(const String& frame, const FrameHeader& header) {
+        switch (header.dataType) {
+            case '!': case '=': case '/': case '@':
+                return (FRAME_Utils::getSymbol(frame, header) == '_') ? (1 << 9) | (1 << 0) : (1 << 0);
+            case '`': case '\'':
+                return 1 << 0;
+            case ';':   return 1 << 1;
+            case ')':   return 1 << 2;
+            case ':':   return frame.startsWith("NWS", header.payloadStart + 2) ? (1 << 7) | (1 << 3) : (1 << 3);
+            case '?':   return 1 << 4;
+            case '>':   return 1 << 5;
+            case 'T':   return 1 << 6;
+            case '{':   return 1 << 8;
+            case '_':   return 1 << 9;
+            default:    return 0;
+        }
+    }
+
+    static bool matchPattern(const String& pattern, const char *text, int length) {
+        int patternLength = pattern.length();
+        if (patternLength > 0 && pattern[patternLength - 1] == '*') {
+            return length >= patternLength - 1 && strncmp(pattern.c_str(), text, patternLength - 1) == 0;
+        }
+        return length == patternLength && strncmp(pattern.c_str(), text, length) == 0;
+    }
+
+    // Only hops that have digipeated: in TNC2 the last used one carries the '*', every hop before it was used as well
+    static bool matchDigi(const FilterTerm& term, const String& frame, const FrameHeader& header) {
+        if (header.pathStart == -1) return false;
+        int usedEnd = -1;
+        for (int i = header.pathStart; i < header.payloadStart; i++) {
+            if (frame[i] == '*') usedEnd = i;
+        }
+        int start = header.pathStart;
+        while (start < usedEnd) {
+            int end = start;
+            while (end < header.payloadStart && frame[end] != ',') end++;
+            int length = (end > start && frame[end - 1] == '*') ? end - start - 1 : end - start;
+            for (int i = 0; i < term.patternCount; i++) {
+                if (matchPattern(term.patterns[i], frame.c_str() + start, length)) return true;
+            }
+            start = end + 1;
+        }
+        return false;
+    }
+
+    static bool matchTerm(const FilterTerm& term, const String& frame, const FrameHeader& header, APRSPacket& decoded, bool& isDecoded) {
+        const char *source  = frame.c_str() + header.start;
+        int sourceLength    = header.sourceEnd - header.start;
+        switch (term.op) {
+            case FILTER_BUDDY:
+                for (int i = 0; i < term.patternCount; i++) {
+                    if (matchPattern(term.patterns[i], source, sourceLength)) return true;
+                }
+                return false;
+            case FILTER_PREFIX:
+                for (int i = 0; i < term.patternCount; i++) {
+                    int length = term.patterns[i].length();
+                    if (sourceLength >= length && strncmp(term.patterns[i].c_str(), source, length) == 0) return true;
+                }
+                return false;
+            case FILTER_TYPE:
+                return (typeBit(frame, header) & term.typeMask) != 0;
+            case FILTER_DIGI:
+                return matchDigi(term, frame, header);
+            case FILTER_RANGE:
+            case FILTER_MY_RANGE: {
+                if (header.type != 0 && header.type != 4) return false;
+                if (term.op == FILTER_MY_RANGE && !filterHasPosition) return false;
+                if (!isDecoded) {
+                    decoded     = APRSPacketLib::processReceivedPacket(frame, 0, 0, 0);
+                    isDecoded   = true;
+                }
+                if (decoded.latitude == 0 && decoded.longitude == 0) return false;
+                if (term.op == FILTER_MY_RANGE) {
+                    return GEO_Utils::distanceBetween(filterLatitude, filterLongitude, decoded.latitude, decoded.longitude) <= term.range;
+                }
+                return GEO_Utils::distanceBetween(term.latitude, term.longitude, decoded.latitude, decoded.longitude) <= term.range;
+            }
+            default:
+                return false;
+        }
+    }
+
+    static bool parseTerm(const String& text, FilterTerm& term) {
+        String body         = text;
+        term.exclude        = body.startsWith("-");
+        if (term.exclude) body = body.substring(1);
+        if (body.length() < 3 || body[1] != '/') return false;
+
+        String fields[FILTER_MAX_PATTERNS];
+        uint8_t fieldCount  = 0;
+        int start           = 2;
+        while (start <= (int)body.length()) {
+            int end = body.indexOf('/', start);
+            if (end == -1) end = body.length();
+            if (end > start) {
+                if (fieldCount == FILTER_MAX_PATTERNS) return false;       // cutting the list would change what the term means
+                fields[fieldCount++] = body.substring(start, end);
+            }
+            start = end + 1;
+        }
+        if (fieldCount == 0) return false;
+
+        term.patternCount   = 0;
+        term.typeMask       = 0;
+        switch (body[0]) {
+            case 'b':
+            case 'p':
+            case 'd':
+                term.op = (body[0] == 'b') ? FILTER_BUDDY : (body[0] == 'p') ? FILTER_PREFIX : FILTER_DIGI;
+                for (int i = 0; i < fieldCount; i++) {
+                    fields[i].toUpperCase();
+                    term.patterns[term.patternCount++] = fields[i];
+                }
+                return true;
+            case 't':
+                term.op = FILTER_TYPE;
+                for (unsigned int i = 0; i < fields[0].length(); i++) {
+                    const char *found = strchr(filterTypeChars, fields[0][i]);
+                    if (found) term.typeMask |= 1 << (found - filterTypeChars);
+                }
+                return term.typeMask != 0;
+            case 'r':
+                if (fieldCount != 3) return false;
+                term.op         = FILTER_RANGE;
+                term.latitude   = fields[0].toFloat();
+                term.longitude  = fields[1].toFloat();
+                term.range      = fields[2].toFloat() * 1000.0f;
+                return true;
+            case 'm':
+                term.op         = FILTER_MY_RANGE;
+                term.range      = fields[0].toFloat() * 1000.0f;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static int termRank(const FilterTerm& term) {
+        bool needsDecode = term.op == FILTER_RANGE || term.op == FILTER_MY_RANGE;
+        return (term.exclude ? 0 : 2) + (needsDecode ? 1 : 0);
+    }
+
+    void compile(const String& filter) {
+        filterTermCount         = 0;
+        filterExclusionCount    = 0;
+        FilterTerm parsed;
+        for (int rank = 0; rank < 4; rank++) {
+            int start = 0;
+            while (start < (int)filter.length()) {
+                int end = filter.indexOf(' ', start);
+                if (end == -1) end = filter.length();
+                if (end > start) {
+                    String text = filter.substring(start, end);
+                    if (!parseTerm(text, parsed)) {
+                        if (rank == 0) logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Filter", "Ignoring term '%s' (malformed or over %d patterns)", text.c_str(), FILTER_MAX_PATTERNS);
+                    } else if (termRank(parsed) == rank) {
+                        if (filterTermCount < FILTER_MAX_TERMS) {
+                            filterTerms[filterTermCount++] = parsed;
+                            if (parsed.exclude) filterExclusionCount++;
+                        } else {
+                            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Filter", "Ignoring term '%s' (over %d terms)", text.c_str(), FILTER_MAX_TERMS);
+                        }
+                    }
+                }
+                start = end + 1;
+            }
+        }
+        if (filterTermCount > 0) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Filter", "%d terms (%d exclusions)", filterTermCount, filterExclusionCount);
+        }
+    }
+
+    bool isActive() {
+        return filterTermCount > 0;
+    }
+
+    void setPosition(bool valid, float latitude, float longitude) {
+        filterHasPosition   = valid;
+        filterLatitude      = latitude;
+        filterLongitude     = longitude;
+    }
+
+    bool passes(const String& frame, const FrameHeader& header, const String& callsign, APRSPacket& decoded, bool& isDecoded) {
+        if (!header.valid) return false;
+        if (FRAME_Utils::isAddressedTo(frame, header, callsign)) return true;
+        for (int i = 0; i < filterTermCount; i++) {
+            bool match = matchTerm(filterTerms[i], frame, header, decoded, isDecoded);
+            if (i < filterExclusionCount) {
+                if (match) return false;
+            } else if (match) {
+                return true;
+            }
+        }
+        return filterTermCount == filterExclusionCount;
+    }
+
+}
@@ -0,0 +1,32 @@
+#ifndef FILTER_UTILS_H_
+#define FILTER_UTILS_H_
+
+#include <Arduino.h>
+#include "APRSPacketLib.h"
+#include "frame_utils.h"
+
+#define FILTER_MAX_TERMS        12
+#define FILTER_MAX_PATTERNS     8
+
+/*  Receive filter, APRS-IS style, space separated terms. A leading '-' makes a term an exclusion.
+    m/dist              within dist km of our position
+    r/lat/lon/dist      within dist km of lat/lon
+    b/call1/call2...    source callsign, trailing * as wildcard
+    p/aa/bb...          source callsign prefix
+    t/poimqstunw        data types: position object item message query status telemetry user-defined nws weather
+    d/digi1/digi2...    digipeater that has repeated the frame (up to the last * in the path), trailing * as wildcard
+    A frame passes when no exclusion matches and, if there are other terms, at least one of them matches.
+    Messages addressed to callsign always pass. A term with more than FILTER_MAX_PATTERNS patterns is rejected
+    with a warning rather than cut short. No hardware is touched: m/ uses the position given to setPosition(). */
+
+
+namespace FILTER_Utils {
+
+    void    compile(const String& filter);
+    bool    isActive();
+    void    setPosition(bool valid, float latitude, float longitude);
+    bool    passes(const String& frame, const FrameHeader& header, const String& callsign, APRSPacket& decoded, bool& isDecoded);
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#include "frame_utils.h"
+
+
+namespace FRAME_Utils {
+
+    static uint8_t getType(const String& frame, int dataTypeIndex) {
+        switch (frame[dataTypeIndex]) {
+            case '!':
+            case '=':
+                return 0;
+            case ':':
+                return 1;
+            case '>':
+                return 2;
+            case 'T':
+                return (frame[dataTypeIndex + 1] == '#') ? 3 : FRAME_TYPE_UNKNOWN;
+            case '`':
+            case '\'':
+                return 4;
+            case ';':
+                return 5;
+            default:
+                return FRAME_TYPE_UNKNOWN;
+        }
+    }
+
+    FrameHeader classify(const String& frame, int start) {
+        FrameHeader header;
+        header.valid        = false;
+        header.thirdParty   = false;
+        header.type         = FRAME_TYPE_UNKNOWN;
+        header.dataType     = 0;
+        header.start        = start;
+        header.sourceEnd    = -1;
+        header.destEnd      = -1;
+        header.pathStart    = -1;
+        header.payloadStart = -1;
+
+        int length = frame.length();
+        for (int i = start; i < length; i++) {
+            char c = frame[i];
+            if (c == '>' && header.sourceEnd == -1) {
+                header.sourceEnd = i;
+            } else if (c == ',' && header.sourceEnd != -1 && header.destEnd == -1) {
+                header.destEnd      = i;
+                header.pathStart    = i + 1;
+            } else if (c == ':') {
+                if (header.destEnd == -1) header.destEnd = i;
+                header.payloadStart = i;
+                break;
+            }
+        }
+        if (header.sourceEnd <= start || header.payloadStart == -1 || header.payloadStart + 1 >= length) return header;
+
+        header.valid        = true;
+        header.dataType     = frame[header.payloadStart + 1];
+        header.thirdParty   = header.dataType == '}';
+        header.type         = getType(frame, header.payloadStart + 1);
+        return header;
+    }
+
+    const String getSource(const String& frame, const FrameHeader& header) {
+        return frame.substring(header.start, header.sourceEnd);
+    }
+
+    const String getPath(const String& frame, const FrameHeader& header) {
+        if (header.pathStart == -1) return "";
+        return frame.substring(header.pathStart, header.payloadStart);
+    }
+
+    char getSymbol(const String& frame, const FrameHeader& header) {
+        int data = header.payloadStart + 1;
+        int symbolIndex;
+        if (header.type == 4) {
+            symbolIndex = data + 7;                                                 // Mic-E: lon, speed/course, symbol
+        } else {
+            if (header.dataType == '/' || header.dataType == '@') data += 7;        // timestamp
+            if ((int)frame.length() <= data + 10) return 0;
+            bool compressed = !isDigit(frame[data + 1]);
+            symbolIndex = compressed ? data + 10 : data + 19;
+        }
+        return ((int)frame.length() > symbolIndex) ? frame[symbolIndex] : 0;
+    }
+
+    bool getInfrastructureSender(const String& frame, const FrameHeader& header, int& start, int& end) {
+        // The station we actually heard: the last digipeater that marked the path as used, otherwise the source
+        // when it is an igate gating to RF (third party) or beacons a digipeater/igate symbol
+        start   = -1;
+        end     = -1;
+        if (header.pathStart != -1) {
+            int element = header.pathStart;
+            while (element < header.payloadStart) {
+                int elementEnd = element;
+                while (elementEnd < header.payloadStart && frame[elementEnd] != ',') elementEnd++;
+                if (elementEnd > element && frame[elementEnd - 1] == '*') {
+                    start   = element;
+                    end     = elementEnd - 1;
+                }
+                element = elementEnd + 1;
+            }
+        }
+        if (start == -1) {
+            char symbol = getSymbol(frame, header);
+            if (!header.thirdParty && symbol != '#' && symbol != '&') return false;
+            start   = header.start;
+            end     = header.sourceEnd;
+        }
+        return true;
+    }
+
+    bool isAddressedTo(const String& frame, const FrameHeader& header, const String& callsign) {
+        // ":ADDRESSEE:text", addressee padded to 9 characters
+        int addresseeStart = header.payloadStart + 2;
+        if (header.type != 1 || (int)frame.length() <= addresseeStart + 9 || frame[addresseeStart + 9] != ':') return false;
+        unsigned int i = 0;
+        for (; i < callsign.length(); i++) {
+            if (i >= 9 || frame[addresseeStart + i] != callsign[i]) return false;
+        }
+        for (; i < 9; i++) {
+            if (frame[addresseeStart + i] != ' ') return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,33 @@
+#ifndef FRAME_UTILS_H_
+#define FRAME_UTILS_H_
+
+#include <Arduino.h>
+
+#define FRAME_TYPE_UNKNOWN  255     // other types follow APRSPacketLib: 0 gps, 1 message, 2 status, 3 telemetry, 4 mic-e, 5 object
+
+// Offsets into a TNC2 frame "SRC>DEST,PATH:payload", found in one pass without decoding the payload
+struct FrameHeader {
+    bool        valid;
+    bool        thirdParty;
+    uint8_t     type;
+    char        dataType;       // APRS data type identifier, first payload byte
+    int         start;
+    int         sourceEnd;      // '>'
+    int         destEnd;        // ',' before the path or ':' when there is no path
+    int         pathStart;      // first path element, -1 without path
+    int         payloadStart;   // ':' before the payload
+};
+
+
+namespace FRAME_Utils {
+
+    FrameHeader classify(const String& frame, int start = 0);
+    const String getSource(const String& frame, const FrameHeader& header);
+    const String getPath(const String& frame, const FrameHeader& header);
+    char        getSymbol(const String& frame, const FrameHeader& header);     // position and Mic-E frames, 0 otherwise
+    bool        getInfrastructureSender(const String& frame, const FrameHeader& header, int& start, int& end);
+    bool        isAddressedTo(const String& frame, const FrameHeader& header, const String& callsign);
+
+}
+
+#endif
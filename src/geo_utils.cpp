@@ -0,0 +1,97 @@
+#include <math.h>
+#include "geo_utils.h"
+
+#define EARTH_RADIUS    6372795.0f      // m, same as TinyGPSPlus
+#define DEG_TO_RADF     0.017453292519943295f
+#define RAD_TO_DEGF     57.29577951308232f
+
+// lat1 is our own position on every call site, so its sin/cos are cached until it moves
+double      cachedLatitude  = 1000.0;
+float       cachedSinLat    = 0.0f;
+float       cachedCosLat    = 1.0f;
+
+static char locator[11];
+
+
+namespace GEO_Utils {
+
+    static void cacheOrigin(double lat) {
+        if (lat != cachedLatitude) {
+            float latRad    = (float)lat * DEG_TO_RADF;
+            cachedSinLat    = sinf(latRad);
+            cachedCosLat    = cosf(latRad);
+            cachedLatitude  = lat;
+        }
+    }
+
+    static float normalizeLongitude(double lon1, double lon2) {
+        double deltaLon = lon2 - lon1;
+        if (deltaLon > 180.0) deltaLon -= 360.0;
+        if (deltaLon < -180.0) deltaLon += 360.0;
+        return (float)deltaLon * DEG_TO_RADF;
+    }
+
+    static float equirectangular(float deltaLat, float deltaLon) {
+        float cosMeanLat = cachedCosLat - cachedSinLat * (deltaLat * 0.5f);   // first order cos(lat1 + dLat/2)
+        float x = deltaLon * cosMeanLat;
+        return EARTH_RADIUS * sqrtf(x * x + deltaLat * deltaLat);
+    }
+
+    float distanceBetween(double lat1, double lon1, double lat2, double lon2) {
+        cacheOrigin(lat1);
+        float deltaLat  = (float)(lat2 - lat1) * DEG_TO_RADF;
+        float deltaLon  = normalizeLongitude(lon1, lon2);
+
+        float distance  = equirectangular(deltaLat, deltaLon);
+        if (distance < GEO_EQUIRECTANGULAR_LIMIT) return distance;
+
+        float sinHalfLat    = sinf(deltaLat * 0.5f);
+        float sinHalfLon    = sinf(deltaLon * 0.5f);
+        float cosLat2       = cachedCosLat * cosf(deltaLat) - cachedSinLat * sinf(deltaLat);
+        float a = sinHalfLat * sinHalfLat + cachedCosLat * cosLat2 * sinHalfLon * sinHalfLon;
+        if (a > 1.0f) a = 1.0f;
+        return 2.0f * EARTH_RADIUS * asinf(sqrtf(a));
+    }
+
+    float courseTo(double lat1, double lon1, double lat2, double lon2) {
+        cacheOrigin(lat1);
+        float deltaLat  = (float)(lat2 - lat1) * DEG_TO_RADF;
+        float deltaLon  = normalizeLongitude(lon1, lon2);
+
+        // Initial great-circle bearing, with cos(lat1)sin(lat2) - sin(lat1)cos(lat2)cos(dLon) rewritten as
+        // sin(dLat) + 2 sin(lat1)cos(lat2)sin^2(dLon/2) so short distances don't cancel out in float
+        float sinDeltaLat   = sinf(deltaLat);
+        float cosLat2       = cachedCosLat * cosf(deltaLat) - cachedSinLat * sinDeltaLat;
+        float sinHalfLon    = sinf(deltaLon * 0.5f);
+        float course = atan2f(sinf(deltaLon) * cosLat2, sinDeltaLat + 2.0f * cachedSinLat * cosLat2 * sinHalfLon * sinHalfLon);
+        course *= RAD_TO_DEGF;
+        if (course < 0.0f) course += 360.0f;
+        return course;
+    }
+
+    char *getMaidenheadLocator(double lat, double lon, uint8_t size) {
+        // Fixed point: 1 unit = 1/2880 deg of longitude and 1/5760 deg of latitude, the size of the 5th pair.
+        // Field, square, subsquare, extended square and 5th pair then all share the same divisors.
+        const uint32_t divisors[5] = {57600, 5760, 240, 24, 1};
+        const uint8_t  bases[5]    = {18, 10, 24, 10, 24};
+
+        int32_t lonUnits = (int32_t)((lon + 180.0) * 2880.0);     // the only floating point step
+        int32_t latUnits = (int32_t)((lat + 90.0) * 5760.0);
+        lonUnits = constrain(lonUnits, 0, 360 * 2880 - 1);
+        latUnits = constrain(latUnits, 0, 180 * 5760 - 1);
+
+        if (size == 0 || size > 10) size = 6;
+        size /= 2;
+
+        for (uint8_t i = 0; i < size; i++) {
+            uint8_t lonDigit = (lonUnits / divisors[i]) % bases[i];
+            uint8_t latDigit = (latUnits / divisors[i]) % bases[i];
+            char base = (i % 2 == 1) ? '0' : 'A';
+            locator[i * 2]      = base + lonDigit;
+            locator[i * 2 + 1]  = base + latDigit;
+        }
+        locator[size * 2] = 0;
+        return locator;
+    }
+
+}
@@ -5,8 +5,10 @@
 #include "station_utils.h"
 #include "boards_pinout.h"
 #include "power_utils.h"
+#include "hal_utils.h"
 #include "sleep_utils.h"
 #include "gps_utils.h"
+#include "geo_utils.h"
 #include "display.h"
 #include "logger.h"
 
@@ -41,39 +43,114 @@ double      previousHeading = 0;
 float       bearing         = 0;
 
 bool        gpsIsActive     = true;
+uint32_t    gpsBurstTime    = 0;    // first byte of the last NMEA burst
+uint32_t    gpsByteTime     = 0;    // last byte read
+uint32_t    gpsDropped      = 0;    // sentences lost to a full queue
+uint32_t    gpsDroppedShown = 0;
+
+TaskHandle_t        gpsTaskHandle   = NULL;
+QueueHandle_t       gpsQueue        = NULL;
 
 
 namespace GPS_Utils {
 
+    // The GPS task owns the UART read side: it splits the NMEA stream into sentences and queues them for loop(),
+    // which keeps TinyGPS to itself. A loop pass stalled by the display or a Bluetooth write no longer overflows
+    // the UART buffer in the middle of a fix. Bytes read while the receiver is off are stale and dropped.
+    static void gpsTask(void *parameter) {
+        GPSSentence sentence;
+        sentence.length = 0;
+        for (;;) {
+            while (HAL::gpsAvailable() > 0) {
+                char c = (char)HAL::gpsRead();
+                if (!gpsIsActive) {
+                    sentence.length = 0;
+                    continue;
+                }
+                uint32_t now = HAL::now();
+                if (gpsByteTime == 0 || now - gpsByteTime >= GPS_BURST_GAP) gpsBurstTime = now;
+                gpsByteTime = now;
+                if (sentence.length < GPS_SENTENCE_SIZE) sentence.text[sentence.length++] = c;
+                if (c == '\n') {
+                    if (xQueueSend(gpsQueue, &sentence, 0) != pdTRUE) gpsDropped++;
+                    sentence.length = 0;
+                }
+            }
+            vTaskDelay(pdMS_TO_TICKS(GPS_TASK_PERIOD));
+        }
+    }
+
     void setup() {
         if (disableGPS) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Main", "GPS disabled");
             return;
         }
         neo6m_gps.begin(GPS_BAUD, SERIAL_8N1, GPS_TX, GPS_RX);
+        gpsQueue = xQueueCreate(GPS_QUEUE_SIZE, sizeof(GPSSentence));
+        xTaskCreatePinnedToCore(gpsTask, "gpsTask", 2048, NULL, 2, &gpsTaskHandle, 0);
+    }
+
+    // UBX-RXM-PMREQ: backup mode for ms, the receiver keeps time, ephemeris and last position and comes back by
+    // itself or on UART activity. Other receivers ignore the frame.
+    void enterBackup(uint32_t ms) {
+        if (disableGPS) return;
+        uint8_t request[16] = {0xB5, 0x62, 0x02, 0x41, 0x08, 0x00,
+                               (uint8_t)ms, (uint8_t)(ms >> 8), (uint8_t)(ms >> 16), (uint8_t)(ms >> 24),
+                               0x02, 0x00, 0x00, 0x00};
+        uint8_t checkA = 0;
+        uint8_t checkB = 0;
+        for (int i = 2; i < 14; i++) {
+            checkA += request[i];
+            checkB += checkA;
+        }
+        request[14] = checkA;
+        request[15] = checkB;
+        neo6m_gps.write(request, sizeof(request));
+        neo6m_gps.flush();
+    }
+
+    void wakeFromBackup() {
+        if (disableGPS) return;
+        neo6m_gps.write(0xFF);
     }
 
     void calculateDistanceCourse(const String& callsign, double checkpointLatitude, double checkPointLongitude) {
-        double distanceKm = TinyGPSPlus::distanceBetween(gps.location.lat(), gps.location.lng(), checkpointLatitude, checkPointLongitude) / 1000.0;
-        double courseTo   = TinyGPSPlus::courseTo(gps.location.lat(), gps.location.lng(), checkpointLatitude, checkPointLongitude);
+        float distanceKm  = GEO_Utils::distanceBetween(gps.location.lat(), gps.location.lng(), checkpointLatitude, checkPointLongitude) / 1000.0f;
+        float courseTo    = GEO_Utils::courseTo(gps.location.lat(), gps.location.lng(), checkpointLatitude, checkPointLongitude);
         STATION_Utils::deleteListenedTrackersbyTime();
         STATION_Utils::orderListenedTrackersByDistance(callsign, distanceKm, courseTo);
     }
 
     void getData() {
-        if (disableGPS) return;
-        while (neo6m_gps.available() > 0) {
-            gps.encode(neo6m_gps.read());
+        if (disableGPS || gpsQueue == NULL) return;
+        GPSSentence sentence;
+        while (xQueueReceive(gpsQueue, &sentence, 0) == pdTRUE) {
+            for (int i = 0; i < sentence.length; i++) {
+                gps.encode(sentence.text[i]);
+            }
+        }
+        if (gpsDropped != gpsDroppedShown) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "GPS", "%u NMEA sentences dropped, loop() too slow", (unsigned int)(gpsDropped - gpsDroppedShown));
+            gpsDroppedShown = gpsDropped;
         }
     }
 
+    uint32_t getNextBurstTime() {
+        uint32_t now = HAL::now();
+        if (gpsByteTime == 0 || now - gpsByteTime >= GPS_SILENT_TIME) return now + GPS_BURST_PERIOD;
+        if (now - gpsByteTime < GPS_BURST_GAP) return now;
+        uint32_t next = gpsBurstTime + GPS_BURST_PERIOD - GPS_BURST_MARGIN;
+        while ((int32_t)(now - next) > 2 * GPS_BURST_MARGIN) next += GPS_BURST_PERIOD;    // late or missed, the RX pin wakes us
+        return ((int32_t)(next - now) < 0) ? now : next;
+    }
+
     void setDateFromData() {
         if (gps.time.isValid()) setTime(gps.time.hour(), gps.time.minute(), gps.time.second(), gps.date.day(), gps.date.month(), gps.date.year());
     }
 
     void calculateDistanceTraveled() {
         currentHeading  = gps.course.deg();
-        lastTxDistance  = TinyGPSPlus::distanceBetween(gps.location.lat(), gps.location.lng(), lastTxLat, lastTxLng);
+        lastTxDistance  = GEO_Utils::distanceBetween(gps.location.lat(), gps.location.lng(), lastTxLat, lastTxLng);
         if (lastTx >= txInterval) {
             if (lastTxDistance > currentSmartBeaconValues.minTxDist) {
                 sendUpdate = true;
@@ -108,7 +185,7 @@ namespace GPS_Utils {
 
     void checkStartUpFrames() {
         if (disableGPS) return;
-        if ((millis() > 10000 && gps.charsProcessed() < 10)) {
+        if ((HAL::now() > 10000 && gps.charsProcessed() < 10)) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "GPS",
                         "No GPS frames detected! Try to reset the GPS Chip with this "
                         "firmware: https://github.com/richonguzman/TTGO_T_BEAM_GPS_RESET");
@@ -3,11 +3,27 @@
 
 #include <Arduino.h>
 
+#define GPS_BURST_GAP       50      // ms of silence that ends the NMEA burst of one fix
+#define GPS_BURST_PERIOD    1000
+#define GPS_BURST_MARGIN    30      // wake this much before the next burst is due
+#define GPS_SILENT_TIME     5000    // no rhythm to follow after this long without data
+#define GPS_SENTENCE_SIZE   96      // NMEA allows 82, longer ones are cut and fail their checksum
+#define GPS_QUEUE_SIZE      16      // one second of sentences at the usual 1 Hz output
+#define GPS_TASK_PERIOD     10      // ms between UART reads, ~10 bytes at 9600 baud
+
+struct GPSSentence {
+    uint8_t     length;
+    char        text[GPS_SENTENCE_SIZE];
+};
+
 namespace GPS_Utils {
 
     void setup();
+    void enterBackup(uint32_t ms);
+    void wakeFromBackup();
     void calculateDistanceCourse(const String& callsign, double checkpointLatitude, double checkPointLongitude);
-    void getData();
+    void getData();                 // feeds TinyGPS the sentences the GPS task queued
+    uint32_t getNextBurstTime();    // HAL::now() time the UART has to be read again, now while a burst is coming in
     void setDateFromData();
     void calculateDistanceTraveled();
     void calculateHeadingDelta(int speed);
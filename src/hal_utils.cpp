@@ -0,0 +1,137 @@
+#include "hal_utils.h"
+
+#ifdef ARDUINO
+
+#include <SPIFFS.h>
+
+extern HardwareSerial       neo6m_gps;
+
+
+namespace HAL {
+
+    bool mountStorage() {
+        return SPIFFS.begin(true);
+    }
+
+    bool readLine(const String& path, String& line) {
+        File file = SPIFFS.open(path);
+        if (!file) return false;
+        bool found = file.available();
+        if (found) line = file.readStringUntil('\n');
+        file.close();
+        return found;
+    }
+
+    bool writeLine(const String& path, const String& line) {
+        File file = SPIFFS.open(path, "w");
+        if (!file) return false;
+        bool written = file.println(line);
+        file.close();
+        return written;
+    }
+
+    bool readLines(const String& path, std::vector<String>& lines) {
+        File file = SPIFFS.open(path);
+        if (!file) return false;
+        while (file.available()) {
+            lines.push_back(file.readStringUntil('\n'));
+        }
+        file.close();
+        return true;
+    }
+
+    bool appendLine(const String& path, const String& line) {
+        File file = SPIFFS.open(path, FILE_APPEND);
+        if (!file) return false;
+        bool written = file.println(line);
+        file.close();
+        return written;
+    }
+
+    bool removeFile(const String& path) {
+        return SPIFFS.remove(path);
+    }
+
+    int gpsAvailable() {
+        return neo6m_gps.available();
+    }
+
+    int gpsRead() {
+        return neo6m_gps.read();
+    }
+
+}
+
+#else
+
+#include <map>
+
+uint32_t                    halVirtualTime  = 0;
+std::map<String, std::vector<String>>   halFiles;      // lines of each file
+String                      halGpsBuffer    = "";
+unsigned int                halGpsIndex     = 0;
+
+
+namespace HAL {
+
+    uint32_t now() {
+        return halVirtualTime;
+    }
+
+    void delay(uint32_t ms) {
+        halVirtualTime += ms;
+    }
+
+    void advance(uint32_t ms) {
+        halVirtualTime += ms;
+    }
+
+    bool mountStorage() {
+        return true;
+    }
+
+    bool readLine(const String& path, String& line) {
+        auto file = halFiles.find(path);
+        if (file == halFiles.end() || file->second.empty()) return false;
+        line = file->second[0];
+        return true;
+    }
+
+    bool writeLine(const String& path, const String& line) {
+        halFiles[path] = {line};
+        return true;
+    }
+
+    bool readLines(const String& path, std::vector<String>& lines) {
+        auto file = halFiles.find(path);
+        if (file == halFiles.end()) return false;
+        lines.insert(lines.end(), file->second.begin(), file->second.end());
+        return true;
+    }
+
+    bool appendLine(const String& path, const String& line) {
+        halFiles[path].push_back(line);
+        return true;
+    }
+
+    bool removeFile(const String& path) {
+        return halFiles.erase(path) > 0;
+    }
+
+    void gpsFeed(const String& sentences) {
+        halGpsBuffer = halGpsBuffer.substring(halGpsIndex) + sentences;
+        halGpsIndex = 0;
+    }
+
+    int gpsAvailable() {
+        return halGpsBuffer.length() - halGpsIndex;
+    }
+
+    int gpsRead() {
+        if (halGpsIndex >= halGpsBuffer.length()) return -1;
+        return halGpsBuffer[halGpsIndex++];
+    }
+
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef HAL_UTILS_H_
+#define HAL_UTILS_H_
+
+#include <Arduino.h>
+#include <vector>
+
+// Clock, storage and GPS UART seam. Timing code (beaconing, message retries, digipeater, station list, TDMA,
+// link adaptation) reads time through HAL::now() so it can run on a host against a virtual clock, where
+// HAL::delay() and HAL::advance() move time forward instantly: hours of retries pass in milliseconds.
+// The host side builds in [env:native] (pio test -e native), test_msg drives the ack retry ladder of msg_queue.cpp
+// on it. Storage on the host is an in-memory file table. Radio, display and I2C are not behind this seam: host
+// tests link their own stand-ins for the calls they need (sendMessage(), SLEEP_Utils::wakeBy(), ...).
+
+
+namespace HAL {
+
+    #ifdef ARDUINO
+        inline uint32_t now() { return ::millis(); }
+        inline void     delay(uint32_t ms) { ::delay(ms); }
+    #else
+        uint32_t        now();
+        void            delay(uint32_t ms);
+        void            advance(uint32_t ms);
+        void            gpsFeed(const String& sentences);
+    #endif
+
+    bool    mountStorage();
+    bool    readLine(const String& path, String& line);
+    bool    writeLine(const String& path, const String& line);      // replaces the file
+    bool    readLines(const String& path, std::vector<String>& lines);
+    bool    appendLine(const String& path, const String& line);
+    bool    removeFile(const String& path);
+
+    int     gpsAvailable();
+    int     gpsRead();
+
+}
+
+#endif
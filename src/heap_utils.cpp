@@ -0,0 +1,140 @@
+#include <logger.h>
+#include "APRSPacketLib.h"
+#include "configuration.h"
+#include "heap_utils.h"
+#include "hal_utils.h"
+#include "lora_utils.h"
+#include "telemetry_utils.h"
+
+
+extern Configuration        Config;
+extern Beacon               *currentBeacon;
+extern logging::Logger      logger;
+extern uint32_t             lastTxTime;
+
+struct HeapStats {
+    uint32_t    calls;
+    uint32_t    allocations;
+    int32_t     retained;
+};
+
+HeapStats   heapStats[HEAP_SUBSYSTEMS];
+portMUX_TYPE heapStatsMux           = portMUX_INITIALIZER_UNLOCKED;     // web scopes run on the AsyncTCP task
+const char  *heapSubsystemNames[HEAP_SUBSYSTEMS] = {"PktLib", "Msgs", "Disp", "BLE", "Web"};
+#define HEAP_DEFINITIONS    2
+const char  *heapTelemetryDefinitions[HEAP_DEFINITIONS] = {"PARM.Free,Block,MinFree,Frag,Uptime", "UNIT.kB,kB,kB,%,h"};
+
+uint32_t    heapSampleTime          = 0;
+uint32_t    heapTelemetryTime       = 0;
+uint16_t    heapTelemetryCounter    = 0;
+uint8_t     heapDefinitionsSent     = 0;
+uint32_t    heapDefinitionsTime     = 0;
+
+
+namespace HEAP_Utils {
+
+    void track(uint8_t subsystem, uint32_t freeBefore) {
+        if (subsystem >= HEAP_SUBSYSTEMS) return;
+        int32_t delta = (int32_t)freeBefore - (int32_t)ESP.getFreeHeap();
+        portENTER_CRITICAL(&heapStatsMux);
+        HeapStats &stats = heapStats[subsystem];
+        stats.calls++;
+        if (delta > 0) stats.allocations++;
+        stats.retained += delta;
+        portEXIT_CRITICAL(&heapStatsMux);
+    }
+
+    uint32_t getFreeHeap() {
+        return ESP.getFreeHeap();
+    }
+
+    uint32_t getLargestFreeBlock() {
+        return ESP.getMaxAllocHeap();
+    }
+
+    uint32_t getMinFreeHeap() {
+        return ESP.getMinFreeHeap();
+    }
+
+    uint8_t getFragmentation() {
+        uint32_t freeHeap = getFreeHeap();
+        if (freeHeap == 0) return 100;
+        return 100 - (getLargestFreeBlock() * 100 / freeHeap);
+    }
+
+    const String getSubsystemLine(uint8_t subsystem) {
+        if (subsystem >= HEAP_SUBSYSTEMS) return "";
+        portENTER_CRITICAL(&heapStatsMux);
+        HeapStats stats = heapStats[subsystem];
+        portEXIT_CRITICAL(&heapStatsMux);
+        String line = heapSubsystemNames[subsystem];
+        for (int i = line.length(); i < 7; i++) {
+            line += " ";
+        }
+        line += String(stats.allocations);
+        line += "/";
+        line += String(stats.calls);
+        line += " ";
+        line += String(stats.retained);
+        line += "B";
+        return line;
+    }
+
+    // PARM/UNIT messages to ourselves, so receivers label the T# fields before the first one arrives
+    static void sendDefinition(const char* definition) {
+        String addressee = currentBeacon->callsign;
+        for (int i = addressee.length(); i < 9; i++) {
+            addressee += ' ';
+        }
+        String packet = APRSPacketLib::generateBasePacket(currentBeacon->callsign, "APLRT1", Config.path);
+        packet += "::";
+        packet += addressee;
+        packet += ":";
+        packet += definition;
+        LoRa_Utils::sendNewPacket(packet);
+        lastTxTime = HAL::now();
+    }
+
+    static void sendTelemetry() {
+        // T#seq,A1..A5: free kB, largest block kB, min free kB, fragmentation %, uptime h
+        char telemetry[48];
+        snprintf(telemetry, sizeof(telemetry), "T#%03d,%u,%u,%u,%u,%u,00000000",
+                heapTelemetryCounter,
+                (unsigned int)(getFreeHeap() / 1024),
+                (unsigned int)(getLargestFreeBlock() / 1024),
+                (unsigned int)(getMinFreeHeap() / 1024),
+                (unsigned int)getFragmentation(),
+                (unsigned int)(HAL::now() / 3600000));
+        heapTelemetryCounter = (heapTelemetryCounter + 1) % 1000;
+
+        String packet = APRSPacketLib::generateBasePacket(currentBeacon->callsign, "APLRT1", Config.path);
+        packet += ":";
+        packet += telemetry;
+        LoRa_Utils::sendNewPacket(packet);
+        lastTxTime = HAL::now();
+    }
+
+    void checkHeap() {
+        if (HAL::now() - heapSampleTime >= 60 * 1000) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Heap", "free: %u largest: %u min: %u frag: %u%%",
+                        (unsigned int)getFreeHeap(), (unsigned int)getLargestFreeBlock(), (unsigned int)getMinFreeHeap(), (unsigned int)getFragmentation());
+            if (Config.diagnostics.heapTelemetry) TELEMETRY_Utils::publish(TELEMETRY_HEAP, getFreeHeap() / 1024.0);
+            heapSampleTime = HAL::now();
+        }
+        // With base91 comment telemetry on, the heap rides in it as a channel when it gets a slot: the callsign has one set of
+        // PARM/UNIT, and those describe the comment frames
+        if (Config.diagnostics.heapTelemetry && !(Config.battery.sendVoltage && Config.battery.voltageAsTelemetry)) {
+            uint32_t sinceLastTx = HAL::now() - lastTxTime;
+            if (sinceLastTx <= 10 * 1000) return;
+            if (heapDefinitionsSent == HEAP_DEFINITIONS && HAL::now() - heapDefinitionsTime >= TELEMETRY_DEFINITION_PERIOD) heapDefinitionsSent = 0;
+            if (heapDefinitionsSent < HEAP_DEFINITIONS) {
+                sendDefinition(heapTelemetryDefinitions[heapDefinitionsSent++]);
+                if (heapDefinitionsSent == HEAP_DEFINITIONS) heapDefinitionsTime = HAL::now();
+            } else if (heapTelemetryTime == 0 || HAL::now() - heapTelemetryTime >= (uint32_t)Config.diagnostics.heapTelemetryInterval * 60 * 1000) {
+                sendTelemetry();
+                heapTelemetryTime = HAL::now();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,41 @@
+#ifndef HEAP_UTILS_H_
+#define HEAP_UTILS_H_
+
+#include <Arduino.h>
+
+enum HeapSubsystem {
+    HEAP_PACKETLIB,
+    HEAP_MESSAGES,
+    HEAP_DISPLAY,
+    HEAP_BLE,
+    HEAP_WEB,
+    HEAP_SUBSYSTEMS
+};
+
+
+namespace HEAP_Utils {
+
+    void        track(uint8_t subsystem, uint32_t freeBefore);
+    uint32_t    getFreeHeap();
+    uint32_t    getLargestFreeBlock();
+    uint32_t    getMinFreeHeap();
+    uint8_t     getFragmentation();
+    const String getSubsystemLine(uint8_t subsystem);
+    void        checkHeap();
+
+    // Heap delta across a scope: a call that leaves less free heap than it found counts as an
+    // allocation for its subsystem. Other tasks allocating meanwhile add some noise.
+    class ScopeTracker {
+    public:
+        explicit ScopeTracker(uint8_t subsystem) : subsystem(subsystem), freeBefore(ESP.getFreeHeap()) {}
+        ~ScopeTracker() { track(subsystem, freeBefore); }
+    private:
+        uint8_t     subsystem;
+        uint32_t    freeBefore;
+    };
+
+}
+
+#define HEAP_TRACK(subsystem)   HEAP_Utils::ScopeTracker heapScope_##subsystem(subsystem)
+
+#endif
@@ -8,7 +8,11 @@
 #include "configuration.h"
 #include "boards_pinout.h"
 #include "power_utils.h"
+#include "hal_utils.h"
+#include "perf_utils.h"
 #include "sleep_utils.h"
+#include "telemetry_utils.h"
+#include "menu_utils.h"
 #include "msg_utils.h"
 #include "display.h"
 
@@ -52,7 +56,10 @@ extern String           winlinkAlias;
 extern String           winlinkAliasComplete;
 extern bool             winlinkCommentState;
 extern bool             gpsIsActive;
-extern bool             sendStartTelemetry;
+extern uint8_t          diagnosticsPage;
+#ifdef PERF_PROFILING
+    extern uint8_t      perfPage;
+#endif
 
 extern std::vector<String>  outputMessagesBuffer;
 
@@ -105,9 +112,9 @@ namespace KEYBOARD_Utils {
             if (menuDisplay < 240) menuDisplay = 241;
         } 
         
-        else if (menuDisplay >= 30 && menuDisplay <= 31) {
+        else if (menuDisplay >= 30 && menuDisplay <= 32) {
             menuDisplay--;
-            if (menuDisplay < 30) menuDisplay = 31;
+            if (menuDisplay < 30) menuDisplay = 32;
         } 
         
         else if (menuDisplay >= 50 && menuDisplay <= 53) {
@@ -131,7 +138,14 @@ namespace KEYBOARD_Utils {
         } else if (menuDisplay >= 9000 && menuDisplay <= 9001) {
             menuDisplay--;
             if (menuDisplay < 9000) menuDisplay = 9001;
+        } else if (menuDisplay == 320) {
+            diagnosticsPage = (diagnosticsPage == 0) ? DIAGNOSTICS_PAGES - 1 : diagnosticsPage - 1;
+        }
+        #ifdef PERF_PROFILING
+        else if (menuDisplay == 9100) {
+            perfPage = (perfPage == 0) ? (PERF_SECTIONS - 1) / 4 : perfPage - 1;
         }
+        #endif
     }
 
     void downArrow() {
@@ -179,9 +193,9 @@ namespace KEYBOARD_Utils {
             if (menuDisplay > 241) menuDisplay = 240;
         }
 
-        else if (menuDisplay >= 30 && menuDisplay <= 31) {
+        else if (menuDisplay >= 30 && menuDisplay <= 32) {
             menuDisplay++;  
-            if (menuDisplay > 31) menuDisplay = 30;
+            if (menuDisplay > 32) menuDisplay = 30;
         }
         
         else if (menuDisplay == 40) {
@@ -226,7 +240,14 @@ namespace KEYBOARD_Utils {
         else if (menuDisplay >= 9000 && menuDisplay <= 9001) {
             menuDisplay++;
             if (menuDisplay > 9001) menuDisplay = 9000;
+        } else if (menuDisplay == 320) {
+            diagnosticsPage = (diagnosticsPage + 1) % DIAGNOSTICS_PAGES;
         }
+        #ifdef PERF_PROFILING
+        else if (menuDisplay == 9100) {
+            perfPage = (perfPage >= (PERF_SECTIONS - 1) / 4) ? 0 : perfPage + 1;
+        }
+        #endif
     }
 
     void leftArrow() {
@@ -244,7 +265,7 @@ namespace KEYBOARD_Utils {
         } else if (menuDisplay == 1300 ||  menuDisplay == 1310) {
             messageText = "";
             menuDisplay = menuDisplay/10;
-        } else if ((menuDisplay>=10 && menuDisplay<=13) || (menuDisplay>=20 && menuDisplay<=29) || (menuDisplay == 120) || (menuDisplay>=130 && menuDisplay<=133) || (menuDisplay>=50 && menuDisplay<=53) || (menuDisplay>=200 && menuDisplay<=290) || (menuDisplay>=60 && menuDisplay<=63) || (menuDisplay>=30 && menuDisplay<=31) || (menuDisplay>=300 && menuDisplay<=310) || (menuDisplay == 40)) {
+        } else if ((menuDisplay>=10 && menuDisplay<=13) || (menuDisplay>=20 && menuDisplay<=29) || (menuDisplay == 120) || (menuDisplay>=130 && menuDisplay<=133) || (menuDisplay>=50 && menuDisplay<=53) || (menuDisplay>=200 && menuDisplay<=290) || (menuDisplay>=60 && menuDisplay<=63) || (menuDisplay>=30 && menuDisplay<=32) || (menuDisplay>=300 && menuDisplay<=320) || (menuDisplay == 40)) {
             menuDisplay = int(menuDisplay/10);
         } else if (menuDisplay == 5000 || menuDisplay == 5010 || menuDisplay == 5020 || menuDisplay == 5030 || menuDisplay == 5040 || menuDisplay == 5050 || menuDisplay == 5060 || menuDisplay == 5070 || menuDisplay == 5080) {
             menuDisplay = 5;
@@ -272,10 +293,16 @@ namespace KEYBOARD_Utils {
             messageText = "";
             menuDisplay = 63;
         }
+        #ifdef PERF_PROFILING
+        else if (menuDisplay == 9100) {
+            menuDisplay = 0;
+        }
+        #endif
     }
     
     void rightArrow() {
         if (menuDisplay == 0 || menuDisplay == 200) {
+            uint8_t previousIndex = myBeaconsIndex;
             if(myBeaconsIndex >= (myBeaconsSize - 1)) {
                 myBeaconsIndex = 0;
             } else {
@@ -284,13 +311,15 @@ namespace KEYBOARD_Utils {
             displayToggle(true);
             displayTime = millis();
             statusState  = true;
-            statusTime = millis();
+            statusTime = HAL::now();
             winlinkCommentState = false;
             displayShow("__ INFO __", "", "  CHANGING CALLSIGN!", "", "-----> " + Config.beacons[myBeaconsIndex].callsign, "", 2000);
-            STATION_Utils::saveIndex(0, myBeaconsIndex);
-            sendStartTelemetry = true;
+            if (myBeaconsIndex != previousIndex) {
+                STATION_Utils::saveIndex(0, myBeaconsIndex);
+                TELEMETRY_Utils::announceDefinitions();
+            }
             if (menuDisplay == 200) menuDisplay = 20;
-        } else if ((menuDisplay >= 1 && menuDisplay <= 3) || (menuDisplay >= 11 &&menuDisplay <= 13) || (menuDisplay >= 20 && menuDisplay <= 27) || (menuDisplay >= 30 && menuDisplay <= 31)) {
+        } else if ((menuDisplay >= 1 && menuDisplay <= 3) || (menuDisplay >= 11 &&menuDisplay <= 13) || (menuDisplay >= 20 && menuDisplay <= 27) || (menuDisplay >= 30 && menuDisplay <= 32)) {
             menuDisplay = menuDisplay * 10;
         } else if (menuDisplay == 10) {
             MSG_Utils::loadMessagesFromMemory(0);
@@ -477,13 +506,15 @@ namespace KEYBOARD_Utils {
 
         else if (menuDisplay == 9000) {
             #if defined(HAS_AXP192) || defined(HAS_AXP2101)
-                displayShow("", "", "    POWER OFF ...", 2000);
+                displayShow("", "", "    POWER OFF ...");
             #else
-                displayShow("", "", "  starting DEEP SLEEP", 2000);
+                displayShow("", "", "  starting DEEP SLEEP");
             #endif
+            delay(2000);
             POWER_Utils::shutdown();
         } else if (menuDisplay == 9001) {
-            displayShow("", "", "  STARTING WiFi AP", 2000);
+            displayShow("", "", "  STARTING WiFi AP");
+            delay(2000);
             Config.wifiAP.active = true;
             Config.writeFile();
             ESP.restart();            
@@ -493,6 +524,7 @@ namespace KEYBOARD_Utils {
     void processPressedKey(char key) {
         keyDetected = true;
         menuTime = millis();
+        displayDismissOverlay();
         /*  181 -> up / 182 -> down / 180 <- back / 183 -> forward / 8 Delete / 13 Enter / 32 Space  / 27 Esc */
         if (!displayState) {
             displayToggle(true);
@@ -503,6 +535,12 @@ namespace KEYBOARD_Utils {
             menuDisplay = 1;      
         } else if (menuDisplay == 0 && key == 8) {
             showHumanHeading = !showHumanHeading;
+        #ifdef PERF_PROFILING
+        } else if (menuDisplay == 0 && (key == 80 || key == 112)) {    // P = hidden Profiler page
+            menuDisplay = 9100;
+        } else if (menuDisplay == 9100 && key == 13) {
+            PERF_Utils::dumpCSV();
+        #endif
         } else if (key == 27) {                           // ESC = return to Main Menu
             menuDisplay = 0;
             messagesIterator = 0;
@@ -552,14 +590,16 @@ namespace KEYBOARD_Utils {
                 messageText = messageText.substring(0, messageText.length() - 1);
             }
         } else if (menuDisplay == 260 && key == 13) {
-            displayShow("", "", "    REBOOTING ...", 2000);
+            displayShow("", "", "    REBOOTING ...");
+            delay(2000);
             ESP.restart();
         } else if (menuDisplay == 270 && key == 13) {
             #if defined(HAS_AXP192) || defined(HAS_AXP2101)
-                displayShow("", "", "    POWER OFF ...", 2000);
+                displayShow("", "", "    POWER OFF ...");
             #else
-                displayShow("", "", " starting DEEP SLEEP", 2000);
+                displayShow("", "", " starting DEEP SLEEP");
             #endif
+            delay(2000);
             POWER_Utils::shutdown();
         } else if ((menuDisplay == 5021 || menuDisplay == 5031 || menuDisplay == 5041 || menuDisplay == 5051) && key >= 48 && key <= 57) {
             winlinkMailNumber = key;
@@ -754,15 +794,19 @@ namespace KEYBOARD_Utils {
             }
             if (upCounter == trackBallSensitivity) {
                 clearTrackballCounter();
+                displayDismissOverlay();
                 upArrow();
             } else if (downCounter == trackBallSensitivity) {
                 clearTrackballCounter();
+                displayDismissOverlay();
                 downArrow();
             } else if (leftCounter == trackBallSensitivity) {
                 clearTrackballCounter();
+                displayDismissOverlay();
                 leftArrow();
             } else if (rightCounter == trackBallSensitivity) {
                 clearTrackballCounter();
+                displayDismissOverlay();
                 rightArrow();
             }
         #endif
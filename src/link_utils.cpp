@@ -0,0 +1,140 @@
+#include <logger.h>
+#include "configuration.h"
+#include "hal_utils.h"
+#include "link_utils.h"
+
+
+extern Configuration        Config;
+extern LoraType             *currentLoRaType;
+extern logging::Logger      logger;
+
+struct LinkStation {
+    uint32_t    hash;
+    float       snr;
+    uint32_t    lastHeard;
+};
+
+LinkStation     linkStations[LINK_MAX_STATIONS];
+LinkSettings    linkCurrent             = {0, 0};
+
+
+namespace LINK_Utils {
+
+    static uint32_t hashCallsign(const char *data, int length) {
+        uint32_t hash = 2166136261;             // FNV-1a
+        for (int i = 0; i < length; i++) {
+            hash ^= (uint8_t)data[i];
+            hash *= 16777619;
+        }
+        return hash;
+    }
+
+    LinkSettings getBaseSettings() {
+        LinkSettings base;
+        base.power              = currentLoRaType->power;
+        base.spreadingFactor    = currentLoRaType->spreadingFactor;
+        return base;
+    }
+
+    float getRequiredSnr(int spreadingFactor) {
+        return -7.5 - 2.5 * (spreadingFactor - 7);      // SX127x/SX126x demodulation floor: SF7 -7.5 dB ... SF12 -20 dB
+    }
+
+    LinkSettings decide(float snr, const LinkSettings& current, const LinkSettings& base, const LinkAdaptation& config) {
+        LinkSettings next = base;
+
+        // Fastest allowed spreading factor that keeps the target margin at full power. Stepping below the
+        // current one needs the hysteresis on top, stepping back up happens as soon as the margin is gone
+        int minSpreadingFactor = base.spreadingFactor;
+        if (config.minSpreadingFactor > 0 && config.minSpreadingFactor < base.spreadingFactor) minSpreadingFactor = config.minSpreadingFactor;
+        for (int sf = minSpreadingFactor; sf < base.spreadingFactor; sf++) {
+            float required = config.targetMargin + ((sf < current.spreadingFactor) ? config.hysteresis : 0);
+            if (snr - getRequiredSnr(sf) >= required) {
+                next.spreadingFactor = sf;
+                break;
+            }
+        }
+
+        // Whatever margin is left above the target is taken off the transmit power
+        float excess    = snr - getRequiredSnr(next.spreadingFactor) - config.targetMargin;
+        int minPower    = (config.minPower < base.power) ? config.minPower : base.power;
+        int power       = base.power - ((excess > 0) ? (int)excess : 0);
+        if (power < minPower) power = minPower;
+        if (next.spreadingFactor == current.spreadingFactor && power < current.power && current.power - power < config.hysteresis) {
+            power = current.power;
+        }
+        next.power = power;
+        return next;
+    }
+
+    void processPacket(const String& frame, const FrameHeader& header, int rssi, float snr) {
+        if (!Config.linkAdaptation.active) return;
+
+        int start, end;
+        if (!FRAME_Utils::getInfrastructureSender(frame, header, start, end)) return;
+
+        // SNR flattens out around +5..+10 dB on strong signals, above that RSSI over the noise floor keeps the estimate going
+        float sample = snr;
+        if (snr > LINK_SNR_SATURATION) {
+            float noiseFloor = -174.0 + 10.0 * log10f((float)currentLoRaType->signalBandwidth) + LINK_NOISE_FIGURE;
+            if (rssi - noiseFloor > sample) sample = rssi - noiseFloor;
+        }
+
+        uint32_t hash = hashCallsign(frame.c_str() + start, end - start);
+        int slot = 0;
+        for (int i = 0; i < LINK_MAX_STATIONS; i++) {
+            if (linkStations[i].hash == hash && linkStations[i].lastHeard != 0) {
+                slot = i;
+                break;
+            }
+            if (linkStations[i].lastHeard < linkStations[slot].lastHeard) slot = i;     // oldest gets replaced
+        }
+        if (linkStations[slot].hash == hash && linkStations[slot].lastHeard != 0) {
+            linkStations[slot].snr += LINK_SNR_ALPHA * (sample - linkStations[slot].snr);
+        } else {
+            linkStations[slot].hash = hash;
+            linkStations[slot].snr  = sample;
+        }
+        linkStations[slot].lastHeard = HAL::now();
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Link", "%s heard %.1f dB (avg %.1f dB)", frame.substring(start, end).c_str(), sample, linkStations[slot].snr);
+    }
+
+    float getBestSnr() {
+        float best = LINK_NO_SNR;
+        for (int i = 0; i < LINK_MAX_STATIONS; i++) {
+            if (linkStations[i].lastHeard != 0 && HAL::now() - linkStations[i].lastHeard < (uint32_t)LINK_STALE_TIME * 1000 && linkStations[i].snr > best) {
+                best = linkStations[i].snr;
+            }
+        }
+        return best;
+    }
+
+    LinkSettings getCurrentSettings() {
+        return (linkCurrent.spreadingFactor == 0) ? getBaseSettings() : linkCurrent;
+    }
+
+    LinkSettings getTxSettings() {
+        LinkSettings base = getBaseSettings();
+        if (!Config.linkAdaptation.active) return base;
+
+        LinkSettings current    = getCurrentSettings();
+        float snr               = getBestSnr();
+        LinkSettings next       = (snr == LINK_NO_SNR) ? base : decide(snr, current, base, Config.linkAdaptation);
+        if (next.power != current.power || next.spreadingFactor != current.spreadingFactor) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Link", "SF%d %ddBm -> SF%d %ddBm (best infrastructure SNR %.1f dB)",
+                        current.spreadingFactor, current.power, next.spreadingFactor, next.power, snr);
+        }
+        linkCurrent = next;
+        return next;
+    }
+
+    void reset() {
+        for (int i = 0; i < LINK_MAX_STATIONS; i++) {
+            linkStations[i].hash        = 0;
+            linkStations[i].snr         = 0;
+            linkStations[i].lastHeard   = 0;
+        }
+        linkCurrent = getBaseSettings();
+    }
+
+}
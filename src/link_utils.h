@@ -0,0 +1,35 @@
+#ifndef LINK_UTILS_H_
+#define LINK_UTILS_H_
+
+#include <Arduino.h>
+#include "configuration.h"
+#include "frame_utils.h"
+
+#define LINK_MAX_STATIONS       4
+#define LINK_SNR_ALPHA          0.25    // EWMA weight of a new SNR sample
+#define LINK_STALE_TIME         900     // seconds without infrastructure heard before falling back to the LoRa type settings
+#define LINK_SNR_SATURATION     5.0
+#define LINK_NOISE_FIGURE       6.0
+#define LINK_NO_SNR             -99.0
+
+struct LinkSettings {
+    int8_t      power;
+    uint8_t     spreadingFactor;
+};
+
+
+namespace LINK_Utils {
+
+    float           getRequiredSnr(int spreadingFactor);
+    // Control law, no hardware access: it can be driven from a host simulation
+    LinkSettings    decide(float snr, const LinkSettings& current, const LinkSettings& base, const LinkAdaptation& config);
+    void            processPacket(const String& frame, const FrameHeader& header, int rssi, float snr);
+    LinkSettings    getBaseSettings();
+    LinkSettings    getCurrentSettings();
+    LinkSettings    getTxSettings();
+    void            reset();
+    float           getBestSnr();
+
+}
+
+#endif
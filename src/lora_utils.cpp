@@ -1,9 +1,18 @@
+#include <driver/gpio.h>
 #include <RadioLib.h>
 #include <logger.h>
 #include <SPI.h>
 #include "notification_utils.h"
 #include "configuration.h"
 #include "boards_pinout.h"
+#include "link_utils.h"
+#include "afc_utils.h"
+#include "comment_utils.h"
+#include "ax25_utils.h"
+#include "telemetry_utils.h"
+#include "fec_utils.h"
+#include "power_utils.h"
+#include "boot_utils.h"
 #include "lora_utils.h"
 #include "display.h"
 
@@ -13,8 +22,34 @@ extern LoraType         *currentLoRaType;
 extern uint8_t          loraIndex;
 extern int              loraIndexSize;
 
-bool operationDone   = true;
-bool transmitFlag    = true;
+volatile bool       operationDone       = true;
+bool                transmitFlag        = true;
+
+TaskHandle_t        radioTaskHandle     = NULL;
+QueueHandle_t       loraTxQueue         = NULL;
+QueueHandle_t       loraRxQueue         = NULL;
+SemaphoreHandle_t   radioMutex          = NULL;
+
+int                 radioPower          = 0;
+uint32_t            linkAdaptedFrames   = 0;
+uint32_t            linkAirtimeSaved    = 0;    // ms
+uint32_t            framingFrames       = 0;
+uint32_t            framingBytesSaved   = 0;
+uint32_t            framingAirtimeSaved = 0;    // ms
+uint32_t            framingReceived     = 0;
+uint32_t            fecFrames           = 0;
+uint32_t            fecReceived         = 0;
+uint32_t            fecCorrected        = 0;    // bytes
+uint32_t            fecSalvaged         = 0;    // frames with a failed LoRa CRC
+
+bool                txActive            = false;    // frame on air, waiting for the Tx done interrupt
+uint32_t            txStartTime         = 0;
+uint32_t            txTimeout           = 0;        // ms, airtime plus margin
+uint32_t            txBaseAirtime       = 0;        // us at the LoRa type settings
+uint16_t            txLength            = 0;
+int8_t              txPower             = 0;
+uint8_t             txSpreadingFactor   = 0;
+bool                retunePending       = false;    // frequency or LoRa type changed while a frame was on air
 
 #if defined(HAS_SX1262)
     SX1262 radio = new Module(RADIO_CS_PIN, RADIO_DIO1_PIN, RADIO_RST_PIN, RADIO_BUSY_PIN);
@@ -32,10 +67,189 @@ bool transmitFlag    = true;
     LLCC68 radio = new Module(RADIO_CS_PIN, RADIO_DIO1_PIN, RADIO_RST_PIN, RADIO_BUSY_PIN);
 #endif
 
+#if defined(HAS_SX1278) || defined(HAS_SX1276)
+    #define RADIO_IRQ_PIN   RADIO_BUSY_PIN      // DIO0, passed to the Module in the busy position
+#else
+    #define RADIO_IRQ_PIN   RADIO_DIO1_PIN
+#endif
+
 namespace LoRa_Utils {
 
-    void setFlag(void) {
+    void IRAM_ATTR setFlag(void) {
         operationDone = true;
+        BaseType_t taskWoken = pdFALSE;
+        if (radioTaskHandle != NULL) vTaskNotifyGiveFromISR(radioTaskHandle, &taskWoken);
+        portYIELD_FROM_ISR(taskWoken);
+    }
+
+    static int setOutputPower(int power) {
+        radioPower = power;
+        #if (defined(HAS_SX1268) || defined(HAS_SX1262)) && !defined(HAS_1W_LORA)
+            return radio.setOutputPower(power + 2); // values available: 10, 17, 22 --> if 20 in tracker_conf.json it will be updated to 22.
+        #elif defined(HAS_SX1278) || defined(HAS_SX1276) || defined(HAS_1W_LORA)
+            return radio.setOutputPower(power);
+        #else
+            return RADIOLIB_ERR_NONE;
+        #endif
+    }
+
+    // Starts the frame and returns, the Tx done interrupt brings the radio task back to finishFrame(). Link
+    // adaptation settings travel with the frame, Rx always stays on the LoRa type spreading factor.
+    static void transmitFrame(const LoRaTxFrame& txFrame) {
+        txPower             = txFrame.power;
+        txSpreadingFactor   = txFrame.spreadingFactor;
+        txLength            = txFrame.length;
+        txBaseAirtime       = radio.getTimeOnAir(txFrame.length);
+        if (txFrame.power != radioPower) setOutputPower(txFrame.power);
+        if (txFrame.spreadingFactor != currentLoRaType->spreadingFactor) radio.setSpreadingFactor(txFrame.spreadingFactor);
+        uint32_t airtime = radio.getTimeOnAir(txFrame.length);
+        uint16_t framedLength = txFrame.length - (txFrame.fec ? 1 + FEC_PARITY : 0);
+        if (txFrame.textLength != framedLength) {
+            uint32_t textAirtime    = radio.getTimeOnAir(txFrame.textLength);
+            uint32_t framedAirtime  = radio.getTimeOnAir(framedLength);
+            framingAirtimeSaved += (textAirtime - framedAirtime) / 1000;
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Framing", "%d bytes instead of %d, airtime %u ms instead of %u ms",
+                        framedLength, txFrame.textLength, (unsigned int)(framedAirtime / 1000), (unsigned int)(textAirtime / 1000));
+        }
+
+        if (Config.ptt.active) {
+            digitalWrite(Config.ptt.io_pin, Config.ptt.reverse ? LOW : HIGH);
+            delay(Config.ptt.preDelay);
+        }
+        if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, HIGH);
+
+        transmitFlag    = true;
+        txActive        = true;
+        txStartTime     = millis();
+        txTimeout       = airtime / 1000 + LORA_TX_TIMEOUT_MARGIN;
+        int state = radio.startTransmit((uint8_t*)txFrame.data, txFrame.length);
+        if (state != RADIOLIB_ERR_NONE) {
+            Serial.print(F("failed, code "));
+            Serial.println(state);
+            operationDone = true;       // nothing goes on air, back to Rx on this pass
+        }
+    }
+
+    // With the mutex held. Settings requested during a transmission wait for its end instead of cutting the frame.
+    static void retune() {
+        radio.setFrequency((float)(currentLoRaType->frequency + AFC_Utils::getCorrection())/1000000);
+        radio.setSpreadingFactor(currentLoRaType->spreadingFactor);
+        float signalBandwidth = currentLoRaType->signalBandwidth/1000;
+        radio.setBandwidth(signalBandwidth);
+        radio.setCodingRate(currentLoRaType->codingRate4);
+        setOutputPower(currentLoRaType->power);
+        retunePending = false;
+    }
+
+    static void finishFrame(bool timedOut) {
+        txActive = false;
+        radio.finishTransmit();
+        if (timedOut) logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "LoRa Tx", "No Tx done after %u ms", (unsigned int)txTimeout);
+
+        if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, LOW);
+        if (Config.ptt.active) {
+            delay(Config.ptt.postDelay);
+            digitalWrite(Config.ptt.io_pin, Config.ptt.reverse ? HIGH : LOW);
+        }
+
+        if (txPower != currentLoRaType->power || txSpreadingFactor != currentLoRaType->spreadingFactor) {
+            uint32_t airtime = radio.getTimeOnAir(txLength);
+            if (txSpreadingFactor != currentLoRaType->spreadingFactor) radio.setSpreadingFactor(currentLoRaType->spreadingFactor);
+            linkAdaptedFrames++;
+            linkAirtimeSaved += (txBaseAirtime - airtime) / 1000;
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Link", "Tx SF%d %ddBm airtime %u ms (saved %u ms, total %u ms)",
+                        txSpreadingFactor, txPower, (unsigned int)(airtime / 1000), (unsigned int)((txBaseAirtime - airtime) / 1000), (unsigned int)linkAirtimeSaved);
+        }
+        if (retunePending) retune();
+    }
+
+    // Binary frames are handed on as TNC2 text, so everything above the radio only ever sees "\x3c\xff\x01" frames
+    static String decodeFrame(const uint8_t* data, size_t length) {
+        String  packet = "";
+        char    tnc2[AX25_MAX_FRAME_LENGTH];
+        size_t  tnc2Length = AX25_Utils::decodeLoRaFrame(data, length, tnc2, sizeof(tnc2));
+        if (tnc2Length > 0) {
+            framingReceived++;
+            packet.concat(tnc2, tnc2Length);
+        } else {
+            packet.concat((const char*)data, length);
+        }
+        return COMMENT_Utils::expandFrame(packet);
+    }
+
+    // "\x3c\xff\x02" + inner format byte + frame body + parity. The code covers the prefix as well, so a frame
+    // whose LoRa CRC failed is recognised once it has been corrected
+    static bool unwrapFec(uint8_t* data, size_t& length, bool crcFailed) {
+        if (length < 4 + FEC_PARITY || length > FEC_MAX_CODEWORD) return false;
+        int corrected = crcFailed ? FEC_Utils::decode(data, length) : 0;
+        if (corrected < 0 || data[0] != 0x3c || data[1] != 0xff || data[2] != 0x02) return false;
+        fecReceived++;
+        fecCorrected += corrected;
+        if (crcFailed) fecSalvaged++;
+        data[2] = data[3];
+        memmove(data + 3, data + 4, length - 4 - FEC_PARITY);
+        length -= 1 + FEC_PARITY;
+        return true;
+    }
+
+    static int readPayload(uint8_t* data, size_t& length) {
+        length = radio.getPacketLength();
+        if (length > LORA_MAX_PACKET_SIZE) length = LORA_MAX_PACKET_SIZE;
+        int state = radio.readData(data, length);
+        if (state == RADIOLIB_ERR_NONE) {
+            unwrapFec(data, length, false);
+        } else if (state == RADIOLIB_ERR_CRC_MISMATCH && unwrapFec(data, length, true)) {    // RadioLib reads the payload anyway
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "FEC", "Frame with failed CRC recovered");
+            state = RADIOLIB_ERR_NONE;
+        }
+        return state;
+    }
+
+    static void readFrame() {
+        LoRaRxFrame rxFrame;
+        size_t length;
+        int state = readPayload(rxFrame.data, length);
+        if (state == RADIOLIB_ERR_NONE) {
+            if (length > 0) {
+                rxFrame.length      = length;
+                rxFrame.rssi        = radio.getRSSI();
+                rxFrame.snr         = radio.getSNR();
+                rxFrame.freqError   = radio.getFrequencyError();
+                if (xQueueSend(loraRxQueue, &rxFrame, 0) != pdTRUE) {
+                    logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "LoRa Rx", "Rx queue full, frame dropped");
+                }
+            }
+        } else {
+            Serial.print(F("failed, code "));   // 7 = CRC mismatch
+            Serial.println(state);
+        }
+    }
+
+    // The radio task owns the SPI transceiver: it drains DIO interrupts into the Rx queue and
+    // transmits whatever loop() pushed into the Tx queue, so an SF12 transmission no longer
+    // stalls the display, keyboard, GPS parsing and Bluetooth bridge running in loop().
+    // The mutex is only held while the chip is serviced, never for the airtime of a frame.
+    static void radioTask(void *parameter) {
+        LoRaTxFrame txFrame;
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            xSemaphoreTake(radioMutex, portMAX_DELAY);
+            bool timedOut = txActive && !operationDone && millis() - txStartTime > txTimeout;
+            if (operationDone || timedOut) {
+                operationDone = false;
+                if (transmitFlag) {
+                    if (txActive) finishFrame(timedOut);
+                    radio.startReceive();
+                    transmitFlag = false;
+                } else {
+                    readFrame();
+                }
+            }
+            if (!txActive && xQueueReceive(loraTxQueue, &txFrame, 0) == pdTRUE) {
+                transmitFrame(txFrame);     // Tx done interrupt sends us back to finishFrame() and startReceive()
+            }
+            xSemaphoreGive(radioMutex);
+        }
     }
 
     void changeFreq() {
@@ -46,18 +260,16 @@ namespace LoRa_Utils {
         }
         currentLoRaType = &Config.loraTypes[loraIndex];
 
-        float freq = (float)currentLoRaType->frequency/1000000;
-        radio.setFrequency(freq);
-        radio.setSpreadingFactor(currentLoRaType->spreadingFactor);
-        float signalBandwidth = currentLoRaType->signalBandwidth/1000;
-        radio.setBandwidth(signalBandwidth);
-        radio.setCodingRate(currentLoRaType->codingRate4);
-        #if (defined(HAS_SX1268) || defined(HAS_SX1262)) && !defined(HAS_1W_LORA)
-            radio.setOutputPower(currentLoRaType->power + 2); // values available: 10, 17, 22 --> if 20 in tracker_conf.json it will be updated to 22.
-        #endif
-        #if defined(HAS_SX1278) || defined(HAS_SX1276) || defined(HAS_1W_LORA)
-            radio.setOutputPower(currentLoRaType->power);
-        #endif
+        xSemaphoreTake(radioMutex, portMAX_DELAY);
+        if (txActive) {
+            retunePending = true;
+        } else {
+            retune();
+            radio.startReceive();
+        }
+        xSemaphoreGive(radioMutex);
+        LINK_Utils::reset();
+        AFC_Utils::reset();
 
         String loraCountryFreq;
         switch (loraIndex) {
@@ -81,7 +293,7 @@ namespace LoRa_Utils {
     void setup() {
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "LoRa", "Set SPI pins!");
         SPI.begin(RADIO_SCLK_PIN, RADIO_MISO_PIN, RADIO_MOSI_PIN);
-        float freq = (float)currentLoRaType->frequency/1000000;
+        float freq = (float)(currentLoRaType->frequency + AFC_Utils::getCorrection())/1000000;
         #if defined(RADIO_HAS_XTAL)
             radio.XTAL = true;
         #endif
@@ -131,94 +343,159 @@ namespace LoRa_Utils {
         radio.setRxBoostedGainMode(true);
         #endif
 
+        radioPower = currentLoRaType->power;
+        LINK_Utils::reset();
+        TELEMETRY_Utils::publish(TELEMETRY_RX_PACKETS, 0);
+
         if (state == RADIOLIB_ERR_NONE) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "LoRa", "LoRa init done!");
         } else {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "LoRa", "Starting LoRa failed! State: %d", state);
             while (true);
-        }        
+        }
+
+        radioMutex  = xSemaphoreCreateMutex();
+        loraTxQueue = xQueueCreate(LORA_TX_QUEUE_SIZE, sizeof(LoRaTxFrame));
+        loraRxQueue = xQueueCreate(LORA_RX_QUEUE_SIZE, sizeof(LoRaRxFrame));
+        xTaskCreatePinnedToCore(radioTask, "radioTask", 4096, NULL, 3, &radioTaskHandle, 0);
+    }
+
+    void applyFrequencyCorrection() {
+        xSemaphoreTake(radioMutex, portMAX_DELAY);
+        if (txActive) {
+            retunePending = true;
+        } else {
+            radio.setFrequency((float)(currentLoRaType->frequency + AFC_Utils::getCorrection())/1000000);
+            radio.startReceive();       // retuning leaves the radio in standby
+        }
+        xSemaphoreGive(radioMutex);
     }
 
-    void sendNewPacket(const String& newPacket) {
+    void sendNewPacket(const String& newPacket, bool own) {
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "LoRa Tx","---> %s", newPacket.c_str());
         /*logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "LoRa","Send data: %s", newPacket.c_str());
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "LoRa","Send data: %s", newPacket.c_str());
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "LoRa","Send data: %s", newPacket.c_str());*/
 
-        if (Config.ptt.active) {
-            digitalWrite(Config.ptt.io_pin, Config.ptt.reverse ? LOW : HIGH);
-            delay(Config.ptt.preDelay);
+        LoRaTxFrame txFrame;
+        // repeated frames stay text for receivers without binary framing, as do non AX.25 callsigns and short ones
+        size_t textLength   = min((size_t)newPacket.length(), (size_t)LORA_MAX_PACKET_SIZE - 3) + 3;
+        txFrame.length      = AX25_Utils::encodeLoRaFrame(newPacket.c_str(), newPacket.length(), txFrame.data, LORA_MAX_PACKET_SIZE,
+                                                            own ? Config.loraFraming : LORA_FRAMING_TEXT);
+        txFrame.textLength  = textLength;
+        if (txFrame.data[2] != 0x01) {
+            framingFrames++;
+            framingBytesSaved += textLength - txFrame.length;
         }
-        if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, HIGH);
+        txFrame.fec             = false;
+        if (own && Config.loraFec && txFrame.length + 1 + FEC_PARITY <= FEC_MAX_CODEWORD) {
+            memmove(txFrame.data + 4, txFrame.data + 3, txFrame.length - 3);
+            txFrame.data[3] = txFrame.data[2];
+            txFrame.data[2] = 0x02;
+            txFrame.length += 1;
+            FEC_Utils::encode(txFrame.data, txFrame.length, txFrame.data + txFrame.length);
+            txFrame.length += FEC_PARITY;
+            txFrame.fec     = true;
+            fecFrames++;
+        }
+
+        LinkSettings settings   = own ? LINK_Utils::getTxSettings() : LINK_Utils::getBaseSettings();
+        txFrame.power           = settings.power;
+        txFrame.spreadingFactor = settings.spreadingFactor;
+
         if (Config.notification.buzzerActive && Config.notification.txBeep) NOTIFICATION_Utils::beaconTxBeep();
-        
-        int state = radio.transmit("\x3c\xff\x01" + newPacket);
-        transmitFlag = true;
-        if (state == RADIOLIB_ERR_NONE) {
-            //Serial.println(F("success!"));
+
+        if (xQueueSend(loraTxQueue, &txFrame, 0) == pdTRUE) {
+            xTaskNotifyGive(radioTaskHandle);
         } else {
-            Serial.print(F("failed, code "));
-            Serial.println(state);
-        }
-        
-        if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, LOW);
-        if (Config.ptt.active) {
-            delay(Config.ptt.postDelay);
-            digitalWrite(Config.ptt.io_pin, Config.ptt.reverse ? HIGH : LOW);
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "LoRa Tx", "Tx queue full, packet dropped");
         }
         #ifdef HAS_TFT
             cleanTFT();
         #endif
     }
 
+    bool isTxIdle() {
+        return loraTxQueue != NULL && uxQueueMessagesWaiting(loraTxQueue) == 0;
+    }
+
+    bool isTxDone() {
+        // The radio task dequeues and starts the frame under the mutex, transmitFlag then stays set through the
+        // airtime until the Tx done interrupt is handled
+        if (!isTxIdle() || xSemaphoreTake(radioMutex, 0) != pdTRUE) return false;
+        bool done = !transmitFlag;
+        xSemaphoreGive(radioMutex);
+        return done;
+    }
+
+    bool prepareSleep() {
+        if (radioMutex == NULL || xSemaphoreTake(radioMutex, 0) != pdTRUE) return false;
+        if (operationDone || txActive || !isTxIdle() || uxQueueMessagesWaiting(loraRxQueue) > 0 || digitalRead(RADIO_IRQ_PIN) == HIGH) {
+            xSemaphoreGive(radioMutex);
+            return false;
+        }
+        // The edge interrupt is not latched in light sleep: wake on the level instead, with the handler off meanwhile
+        gpio_intr_disable((gpio_num_t)RADIO_IRQ_PIN);
+        gpio_wakeup_enable((gpio_num_t)RADIO_IRQ_PIN, GPIO_INTR_HIGH_LEVEL);
+        return true;
+    }
+
+    void resumeFromSleep() {
+        gpio_wakeup_disable((gpio_num_t)RADIO_IRQ_PIN);
+        gpio_set_intr_type((gpio_num_t)RADIO_IRQ_PIN, GPIO_INTR_POSEDGE);
+        gpio_intr_enable((gpio_num_t)RADIO_IRQ_PIN);
+        if (digitalRead(RADIO_IRQ_PIN) == HIGH) operationDone = true;
+        xSemaphoreGive(radioMutex);
+        if (operationDone) xTaskNotifyGive(radioTaskHandle);
+    }
+
     void wakeRadio() {
+        xSemaphoreTake(radioMutex, portMAX_DELAY);
         radio.startReceive();
+        xSemaphoreGive(radioMutex);
     }
 
     ReceivedLoRaPacket receiveFromSleep() {
         ReceivedLoRaPacket receivedLoraPacket;
-        String packet = "";
-        int state = radio.readData(packet);
+        uint8_t data[LORA_MAX_PACKET_SIZE];
+        size_t  length;
+        xSemaphoreTake(radioMutex, portMAX_DELAY);
+        int state = readPayload(data, length);
         if (state == RADIOLIB_ERR_NONE) {
-            receivedLoraPacket.text       = packet;
+            receivedLoraPacket.text       = decodeFrame(data, length);
+            TELEMETRY_Utils::count(TELEMETRY_RX_PACKETS);
+            BOOT_Utils::firstRx();
             receivedLoraPacket.rssi       = radio.getRSSI();
             receivedLoraPacket.snr        = radio.getSNR();
             receivedLoraPacket.freqError  = radio.getFrequencyError();
         } else {
             //
         }
+        xSemaphoreGive(radioMutex);
         return receivedLoraPacket;
     }
 
     ReceivedLoRaPacket receivePacket() {
         ReceivedLoRaPacket receivedLoraPacket;
-        String packet = "";
-        if (operationDone) {
-            operationDone = false;
-            if (transmitFlag) {
-                radio.startReceive();
-                transmitFlag = false;
-            } else {
-                int state = radio.readData(packet);
-                if (state == RADIOLIB_ERR_NONE) {
-                    if(!packet.isEmpty()) {
-                        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "LoRa Rx","---> %s", packet.substring(3).c_str());
-                        receivedLoraPacket.text       = packet;
-                        receivedLoraPacket.rssi       = radio.getRSSI();
-                        receivedLoraPacket.snr        = radio.getSNR();
-                        receivedLoraPacket.freqError  = radio.getFrequencyError();
-                    }
-                } else {
-                    Serial.print(F("failed, code "));   // 7 = CRC mismatch
-                    Serial.println(state);
-                }
-            }
+        LoRaRxFrame rxFrame;
+        if (loraRxQueue != NULL && xQueueReceive(loraRxQueue, &rxFrame, 0) == pdTRUE) {
+            CPU_BOOST();    // FEC, frame and comment decoding, then the loop handles the packet
+            String packet = decodeFrame(rxFrame.data, rxFrame.length);
+            TELEMETRY_Utils::count(TELEMETRY_RX_PACKETS);
+            BOOT_Utils::firstRx();
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "LoRa Rx","---> %s", packet.substring(3).c_str());
+            receivedLoraPacket.text       = packet;
+            receivedLoraPacket.rssi       = rxFrame.rssi;
+            receivedLoraPacket.snr        = rxFrame.snr;
+            receivedLoraPacket.freqError  = rxFrame.freqError;
         }
         return receivedLoraPacket;
     }
 
     void sleepRadio() {
+        xSemaphoreTake(radioMutex, portMAX_DELAY);
         radio.sleep();
+        xSemaphoreGive(radioMutex);
     }
 
 }
\ No newline at end of file
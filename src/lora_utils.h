@@ -2,6 +2,12 @@
 #define LORA_UTILS_H_
 
 #include <Arduino.h>
+#include "ax25_codec.h"
+
+#define LORA_MAX_PACKET_SIZE    256
+#define LORA_TX_QUEUE_SIZE      6
+#define LORA_RX_QUEUE_SIZE      6
+#define LORA_TX_TIMEOUT_MARGIN  1000    // ms past the computed airtime before a missing Tx done interrupt is given up
 
 struct ReceivedLoRaPacket {
     String  text;
@@ -10,13 +16,36 @@ struct ReceivedLoRaPacket {
     int     freqError;
 };
 
+struct LoRaTxFrame {
+    uint16_t    length;
+    uint16_t    textLength;     // length as TNC2 text, to account the framing savings
+    bool        fec;
+    int8_t      power;
+    uint8_t     spreadingFactor;
+    uint8_t     data[LORA_MAX_PACKET_SIZE];
+};
+
+struct LoRaRxFrame {
+    uint16_t    length;
+    int         rssi;
+    float       snr;
+    int         freqError;
+    uint8_t     data[LORA_MAX_PACKET_SIZE];
+};
+
 
 namespace LoRa_Utils {
 
     void setFlag();
     void changeFreq();
     void setup();
-    void sendNewPacket(const String& newPacket);
+    void applyFrequencyCorrection();
+    void sendNewPacket(const String& newPacket, bool own = true);     // own frames are link adapted and use the configured framing
+    bool isTxIdle();
+    bool isTxDone();            // nothing queued and the last frame is off the air
+    // Light sleep: hold the radio task off the SPI bus and arm the DIO pin as a wake source, false if the radio is busy
+    bool prepareSleep();
+    void resumeFromSleep();
     void wakeRadio();
     ReceivedLoRaPacket receiveFromSleep();
     ReceivedLoRaPacket receivePacket();
@@ -7,9 +7,16 @@
 #include "APRSPacketLib.h"
 #include "battery_utils.h"
 #include "power_utils.h"
+#include "sleep_utils.h"
+#include "heap_utils.h"
+#include "boot_utils.h"
+#include "afc_utils.h"
+#include "link_utils.h"
 #include "menu_utils.h"
+#include "perf_utils.h"
 #include "msg_utils.h"
 #include "gps_utils.h"
+#include "geo_utils.h"
 #include "bme_utils.h"
 #include "display.h"
 #include "utils.h"
@@ -47,9 +54,27 @@ extern String               winlinkAliasComplete;
 extern bool                 winlinkCommentState;
 extern int                  wxModuleType;
 extern bool                 gpsIsActive;
+extern uint32_t             digiRepeated;
+extern uint32_t             digiDropped;
+extern uint32_t             digiCancelled;
+extern uint32_t             linkAdaptedFrames;
+extern uint32_t             linkAirtimeSaved;
+extern uint32_t             afcUpdates;
+extern uint32_t             framingFrames;
+extern uint32_t             framingBytesSaved;
+extern uint32_t             framingAirtimeSaved;
+extern uint32_t             framingReceived;
+extern uint32_t             fecFrames;
+extern uint32_t             fecReceived;
+extern uint32_t             fecCorrected;
+extern uint32_t             fecSalvaged;
 
 String      freqChangeWarning;
 uint8_t     lowBatteryPercent       = 21;
+uint8_t     diagnosticsPage         = 0;
+#ifdef PERF_PROFILING
+    uint8_t perfPage                = 0;
+#endif
 
 namespace MENU_Utils {
 
@@ -83,9 +108,12 @@ namespace MENU_Utils {
     }
 
     void showOnScreen() {
+        if (displayOverlayActive()) return;
+        PERF_SCOPE(PERF_DISPLAY);
+        HEAP_TRACK(HEAP_DISPLAY);
         String lastLine, firstLineDecoder, courseSpeedAltitude, speedPacketDec, coursePacketDec, pathDec;
         uint32_t lastMenuTime = millis() - menuTime;
-        if (!(menuDisplay==0) && !(menuDisplay==300) && !(menuDisplay==310) && !(menuDisplay==40) && !(menuDisplay>=500 && menuDisplay<=5100) && lastMenuTime > 30*1000) {
+        if (!(menuDisplay==0) && !(menuDisplay==300) && !(menuDisplay==310) && !(menuDisplay==320) && !(menuDisplay==40) && !(menuDisplay>=500 && menuDisplay<=5100) && lastMenuTime > 30*1000) {
             menuDisplay = 0;
             messageCallsign = "";
             messageText = "";
@@ -282,13 +310,17 @@ namespace MENU_Utils {
 
 //////////
             case 30:    //3.Stations ---> Packet Decoder
-                displayShow("STATIONS>", "", "> Packet Decoder", "  Near By Stations", "", "<Back");
+                displayShow("STATIONS>", "", "> Packet Decoder", "  Near By Stations", "  Diagnostics", "<Back");
                 break;
             case 31:    //3.Stations ---> Near By Stations
-                displayShow("STATIONS>", "", "  Packet Decoder", "> Near By Stations", "", "<Back");
+                displayShow("STATIONS>", "", "  Packet Decoder", "> Near By Stations", "  Diagnostics", "<Back");
+                break;
+            case 32:    //3.Stations ---> Diagnostics
+                displayShow("STATIONS>", "", "  Packet Decoder", "  Near By Stations", "> Diagnostics", "<Back");
                 break;
 
             case 300:   //3.Stations ---> Packet Decoder
+                MSG_Utils::decodeLastReceivedPacket();
                 if (lastReceivedPacket.sender != currentBeacon->callsign) {
                     firstLineDecoder = lastReceivedPacket.sender;
                     for(int i = firstLineDecoder.length(); i < 9; i++) {
@@ -315,8 +347,8 @@ namespace MENU_Utils {
                         }
                         courseSpeedAltitude += coursePacketDec;
                         
-                        double distanceKm = TinyGPSPlus::distanceBetween(gps.location.lat(), gps.location.lng(), lastReceivedPacket.latitude, lastReceivedPacket.longitude) / 1000.0;
-                        double courseTo   = TinyGPSPlus::courseTo(gps.location.lat(), gps.location.lng(), lastReceivedPacket.latitude, lastReceivedPacket.longitude);
+                        float distanceKm  = GEO_Utils::distanceBetween(gps.location.lat(), gps.location.lng(), lastReceivedPacket.latitude, lastReceivedPacket.longitude) / 1000.0f;
+                        float courseTo    = GEO_Utils::courseTo(gps.location.lat(), gps.location.lng(), lastReceivedPacket.latitude, lastReceivedPacket.longitude);
                         
                         if (lastReceivedPacket.path.length()>14) {
                             pathDec = "P:";
@@ -340,6 +372,85 @@ namespace MENU_Utils {
             case 310:    //3.Stations ---> Near By Stations
                 displayShow("NEAR BY >", STATION_Utils::getNearTracker(0), STATION_Utils::getNearTracker(1), STATION_Utils::getNearTracker(2), STATION_Utils::getNearTracker(3), "<Back");
                 break;
+            case 320:    //3.Stations ---> Diagnostics (Up/Down changes page)
+                if (diagnosticsPage == 0) {
+                    displayShow("DIAGNOST>",
+                                "Heap:" + String(HEAP_Utils::getFreeHeap() / 1024) + "k Min:" + String(HEAP_Utils::getMinFreeHeap() / 1024) + "k",
+                                "Block:" + String(HEAP_Utils::getLargestFreeBlock() / 1024) + "k Frag:" + String(HEAP_Utils::getFragmentation()) + "%",
+                                HEAP_Utils::getSubsystemLine(HEAP_PACKETLIB),
+                                HEAP_Utils::getSubsystemLine(HEAP_MESSAGES),
+                                "<Back");
+                } else if (diagnosticsPage == 1) {
+                    displayShow("DIAGNOST>",
+                                "Heap   alloc/calls",
+                                HEAP_Utils::getSubsystemLine(HEAP_DISPLAY),
+                                HEAP_Utils::getSubsystemLine(HEAP_BLE),
+                                HEAP_Utils::getSubsystemLine(HEAP_WEB),
+                                "<Back");
+                } else if (diagnosticsPage == 2) {
+                    displayShow("DIAGNOST>",
+                                "Digi " + checkProcessActive(digirepeaterActive) + " mode " + String(Config.digi.mode),
+                                "Repeated : " + String(digiRepeated),
+                                "Dropped  : " + String(digiDropped),
+                                "Cancelled: " + String(digiCancelled),
+                                "<Back");
+                } else if (diagnosticsPage == 3) {
+                    LinkSettings linkSettings = LINK_Utils::getCurrentSettings();
+                    float linkSnr = LINK_Utils::getBestSnr();
+                    displayShow("DIAGNOST>",
+                                "Link " + checkProcessActive(Config.linkAdaptation.active),
+                                "Infra SNR: " + ((linkSnr == LINK_NO_SNR) ? String("---") : String(linkSnr, 1) + "dB"),
+                                "Tx SF" + String(linkSettings.spreadingFactor) + " " + String(linkSettings.power) + "dBm",
+                                "Adapted  : " + String(linkAdaptedFrames),
+                                "<Back  Saved:" + String(linkAirtimeSaved / 1000) + "s");
+                } else if (diagnosticsPage == 4) {
+                    int afcCorrection = AFC_Utils::getCorrection();
+                    displayShow("DIAGNOST>",
+                                "AFC " + checkProcessActive(Config.afc.active),
+                                "Offset: " + String(afcCorrection > 0 ? "+" : "") + String(afcCorrection) + "Hz",
+                                "Ppm   : " + String(AFC_Utils::getOffsetPpm(), 2),
+                                "Median: " + String(AFC_Utils::getLastMedian()) + "Hz (" + String(AFC_Utils::getSampleCount()) + ")",
+                                "<Back  Updates:" + String(afcUpdates));
+                } else if (diagnosticsPage == 5) {
+                    const char* framing[] = {"TEXT", "AX.25", "PACKED"};
+                    displayShow("DIAGNOST>",
+                                "Framing " + String(framing[constrain(Config.loraFraming, 0, 2)]),
+                                "Tx binary: " + String(framingFrames),
+                                "Rx binary: " + String(framingReceived),
+                                "Bytes saved: " + String(framingBytesSaved),
+                                "<Back  Saved:" + String(framingAirtimeSaved / 1000) + "s");
+                } else if (diagnosticsPage == 6) {
+                    displayShow("DIAGNOST>",
+                                "FEC " + checkProcessActive(Config.loraFec),
+                                "Tx FEC   : " + String(fecFrames),
+                                "Rx FEC   : " + String(fecReceived),
+                                "Bytes fixed: " + String(fecCorrected),
+                                "<Back  Salvaged:" + String(fecSalvaged));
+                } else if (diagnosticsPage == 7) {
+                    uint32_t firstRxTime        = BOOT_Utils::getFirstRxTime();
+                    uint32_t firstBeaconTime    = BOOT_Utils::getFirstBeaconTime();
+                    displayShow("DIAGNOST>",
+                                "Boot  setup: " + String(BOOT_Utils::getPhaseTime(BOOT_DONE)) + "ms",
+                                "Radio ready: " + String(BOOT_Utils::getPhaseTime(BOOT_LORA)) + "ms",
+                                "First Rx   : " + (firstRxTime ? String(firstRxTime / 1000.0, 1) + "s" : String("--")),
+                                "First Tx   : " + (firstBeaconTime ? String(firstBeaconTime / 1000.0, 1) + "s" : String("--")),
+                                "<Back");
+                } else if (diagnosticsPage == 8) {
+                    displayShow("DIAGNOST>",
+                                "CPU " + String(POWER_Utils::isGovernorDfs() ? "DFS " : "manual ") + String(GOVERNOR_MIN_MHZ) + "-" + String(GOVERNOR_MAX_MHZ) + "MHz",
+                                "Idle    : " + String(POWER_Utils::getIdleShare()) + "%",
+                                "Boosted : " + String(POWER_Utils::getBoostShare()) + "%",
+                                "Asleep  : " + String(SLEEP_Utils::getSleepShare()) + "%",
+                                "<Back  Wakes:" + String(SLEEP_Utils::getWakeCount()));
+                } else {
+                    displayShow("DIAGNOST>",
+                                "Loop latency",
+                                "<10ms  : " + String(Utils::getLoopLatencyShare(10)) + "%",
+                                "<50ms  : " + String(Utils::getLoopLatencyShare(50)) + "%",
+                                "<100ms : " + String(Utils::getLoopLatencyShare(100)) + "%",
+                                "<Back  Max:" + String(Utils::getLoopLatencyMax()) + "ms");
+                }
+                break;
 
 //////////
             case 40:
@@ -512,6 +623,18 @@ namespace MENU_Utils {
             case 9001:  //  9. multiPress Menu
                 displayShow("__CONFIG__", "  Turn Tracker Off","> Config. WiFi AP",  "","",lastLine);
                 break;
+            #ifdef PERF_PROFILING
+            case 9100:  //  Hidden Profiler page ('P' on Main Menu)
+                {
+                    String perfLines[4];
+                    for (int i = 0; i < 4; i++) {
+                        uint8_t section = perfPage * 4 + i;
+                        if (section < PERF_SECTIONS) perfLines[i] = PERF_Utils::getStatsLine(section);
+                    }
+                    displayShow("_PERF ms__", perfLines[0], perfLines[1], perfLines[2], perfLines[3], "avg/p99/max Enter=CSV");
+                }
+                break;
+            #endif
 
 
 //////////
@@ -540,7 +663,7 @@ namespace MENU_Utils {
                         thirdRowMainMenu += " ";
                         thirdRowMainMenu += String(gps.location.lng(), 4);
                     } else {
-                        thirdRowMainMenu = String(Utils::getMaidenheadLocator(gps.location.lat(), gps.location.lng(), 8));
+                        thirdRowMainMenu = String(GEO_Utils::getMaidenheadLocator(gps.location.lat(), gps.location.lng(), 8));
                         thirdRowMainMenu += " LoRa[";
                         switch (loraIndex) {
                             case 0: thirdRowMainMenu += "Eu]"; break;
@@ -595,7 +718,9 @@ namespace MENU_Utils {
                     fourthRowMainMenu += "km/h  ";
                     fourthRowMainMenu += fourthRowCourse;
                     if (Config.bme.active && (time_now % 10 < 5) && wxModuleType != 0) {
-                        fourthRowMainMenu = BME_Utils::readDataSensor(1);
+                        char wx[32];
+                        BME_Utils::writeDataSensor(wx, sizeof(wx), 1);
+                        fourthRowMainMenu = wx;
                     }
                     if (MSG_Utils::getNumWLNKMails() > 0) {
                         fourthRowMainMenu = "** WLNK MAIL: ";
@@ -3,6 +3,8 @@
 
 #include <Arduino.h>
 
+#define DIAGNOSTICS_PAGES   10
+
 namespace MENU_Utils {
     
     const String checkBTType();
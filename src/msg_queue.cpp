@@ -0,0 +1,188 @@
+#include <vector>
+#include "sleep_utils.h"
+#include "hal_utils.h"
+#include "msg_utils.h"
+
+// Output buffer and ack retry ladder. Messages go out through sendMessage() and the time comes from HAL::now(),
+// so this file also builds on the host, where a test stands in for sendMessage() and runs the ladder on the
+// virtual clock.
+
+extern uint32_t             lastTxTime;
+extern uint8_t              winlinkStatus;
+extern int                  ackRequestNumber;
+
+std::vector<String>             outputMessagesBuffer;
+std::vector<String>             outputAckRequestBuffer;
+std::vector<String>             packet25SegBuffer;
+
+bool        ackRequestState     = false;
+String      ackCallsignRequest  = "";
+String      ackNumberRequest    = "";
+uint32_t    lastMsgRxTime       = HAL::now();
+uint32_t    lastRetryTime       = HAL::now();
+
+
+namespace MSG_Utils {
+
+    const String ackRequestNumberGenerator() {
+        ackRequestNumber++;
+        if (ackRequestNumber > 999) {
+            ackRequestNumber = 1;
+        }
+        return String(ackRequestNumber);
+    }
+
+    void addToOutputBuffer(uint8_t typeOfMessage, const String& station, const String& textMessage) {
+        bool alreadyInBuffer;
+        if (typeOfMessage == 1) {
+            alreadyInBuffer = false;
+            if (!outputMessagesBuffer.empty()) {
+                for (int i = 0; i < outputMessagesBuffer.size(); i++) {
+                    if (outputMessagesBuffer[i].indexOf(station + "," + textMessage) == 0) {
+                        alreadyInBuffer = true;
+                    }
+                }
+            }
+            if (!outputAckRequestBuffer.empty()) {
+                for (int j = 0; j < outputAckRequestBuffer.size(); j++) {
+                    if (outputAckRequestBuffer[j].indexOf(station + "," + textMessage) > 1) {
+                        alreadyInBuffer = true;
+                    }
+                }
+            }               
+            if (!alreadyInBuffer) {
+                outputMessagesBuffer.push_back(station + "," + textMessage + "{" + ackRequestNumberGenerator());
+            }
+        } else if (typeOfMessage == 0) {
+            alreadyInBuffer = false;
+            if (!outputMessagesBuffer.empty()) {
+                for (int k = 0; k < outputMessagesBuffer.size(); k++) {
+                    if (outputMessagesBuffer[k].indexOf(station + "," + textMessage) == 0) {
+                        alreadyInBuffer = true;
+                    }
+                }
+            }
+            if (!alreadyInBuffer) {
+                outputMessagesBuffer.push_back(station + "," + textMessage);
+            }
+        }
+    }
+
+    bool checkOutputBufferEmpty() {
+        if(outputMessagesBuffer.empty()) {
+            return true;
+        }
+        return false;
+    }
+
+    void processOutputBuffer() {
+        if (!outputMessagesBuffer.empty() || !outputAckRequestBuffer.empty()) SLEEP_Utils::wakeBy(HAL::now() + 1000);     // gaps and retries counted in seconds
+        if (!outputMessagesBuffer.empty() && (HAL::now() - lastMsgRxTime) >= 6000 && (HAL::now() - lastTxTime) > 3000) {
+            String addressee = outputMessagesBuffer[0].substring(0, outputMessagesBuffer[0].indexOf(","));
+            String message = outputMessagesBuffer[0].substring(outputMessagesBuffer[0].indexOf(",") + 1);
+            if (message.indexOf("{") > 0) {     // message with ack Request
+                outputAckRequestBuffer.push_back("6," + addressee + "," + message);  // 6 is for ack packets retries
+                outputMessagesBuffer.erase(outputMessagesBuffer.begin());
+            } else {                            // message without ack Request
+                sendMessage(addressee, message);
+                outputMessagesBuffer.erase(outputMessagesBuffer.begin());
+                lastTxTime = HAL::now();
+            }
+        }
+        if (outputAckRequestBuffer.empty()) {
+            ackRequestState = false;
+        } else if (!outputAckRequestBuffer.empty() && (HAL::now() - lastMsgRxTime) >= 4500 && (HAL::now() - lastTxTime) > 3000) {
+            bool sendRetry = false;
+            String triesLeft = outputAckRequestBuffer[0].substring(0 , outputAckRequestBuffer[0].indexOf(","));
+            switch (triesLeft.toInt()) {
+                case 6:
+                    sendRetry = true;
+                    ackRequestState = true;
+                    break;
+                case 5:
+                    if (HAL::now() - lastRetryTime > 30 * 1000) sendRetry = true;
+                    break;
+                case 4:
+                    if (HAL::now() - lastRetryTime > 60 * 1000) sendRetry = true;
+                    break;
+                case 3:
+                    if (HAL::now() - lastRetryTime > 120 * 1000) sendRetry = true;
+                    break;
+                case 2:
+                    if (HAL::now() - lastRetryTime > 120 * 1000) sendRetry = true;
+                    break;
+                case 1:
+                    if (HAL::now() - lastRetryTime > 120 * 1000) sendRetry = true;
+                    break;
+                case 0:
+                    if (HAL::now() - lastRetryTime > 30 * 1000) {
+                        ackRequestState = false;
+                        outputAckRequestBuffer.erase(outputAckRequestBuffer.begin());
+                        if (winlinkStatus > 0 && winlinkStatus < 5) {   // if not complete Winlink Challenge Process it will reset Login process
+                            winlinkStatus = 0;
+                        }                     
+                    }
+                    break;
+            }
+            if (sendRetry) {
+                String rest = outputAckRequestBuffer[0].substring(outputAckRequestBuffer[0].indexOf(",") + 1);
+                ackCallsignRequest = rest.substring(0, rest.indexOf(","));
+                String payload = rest.substring(rest.indexOf(",") + 1);
+                ackNumberRequest = payload.substring(payload.indexOf("{") + 1);                
+                sendMessage(ackCallsignRequest, payload);
+                lastTxTime = HAL::now();
+                lastRetryTime = HAL::now();
+                outputAckRequestBuffer[0] = String(triesLeft.toInt() - 1) + "," + ackCallsignRequest + "," + payload;
+            }
+        }
+    }
+
+    void clean25SegBuffer() {
+        if (!packet25SegBuffer.empty()) {
+            String deltaTimeString = packet25SegBuffer[0].substring(0, packet25SegBuffer[0].indexOf(","));
+            uint32_t deltaTime = deltaTimeString.toInt();
+            if ((HAL::now() - deltaTime) >  25 * 1000) {
+                packet25SegBuffer.erase(packet25SegBuffer.begin());
+            }
+        }
+    }
+
+    bool check25SegBuffer(const String& station, const String& textMessage) {
+        if (!packet25SegBuffer.empty()) {
+            bool shouldBeIgnored = false;
+            for (int i = 0; i < packet25SegBuffer.size(); i++) {
+                String temp = packet25SegBuffer[i].substring(packet25SegBuffer[i].indexOf(",") + 1);
+                String bufferStation = temp.substring(0, temp.indexOf(","));
+                String bufferMessage = temp.substring(temp.indexOf(",") + 1);
+                if (bufferStation == station && bufferMessage == textMessage) {
+                    shouldBeIgnored = true;
+                }
+            }
+            if (shouldBeIgnored) {
+                return false;
+            } else {
+                packet25SegBuffer.push_back(String(HAL::now()) + "," + station + "," + textMessage);
+                return true;
+            }
+        } else {
+            packet25SegBuffer.push_back(String(HAL::now()) + "," + station + "," + textMessage);
+            return true;
+        }
+    }
+
+    void holdOutputBuffer() {
+        lastMsgRxTime = HAL::now();
+    }
+
+    const String& getAckNumberRequest() {
+        return ackNumberRequest;
+    }
+
+    void checkAck(const String& station, const String& message) {
+        if (ackRequestState && message.indexOf("ack") == 0 && ackCallsignRequest == station && ackNumberRequest == message.substring(3)) {
+            outputAckRequestBuffer.erase(outputAckRequestBuffer.begin());
+            ackRequestState = false;
+        }
+    }
+
+}
@@ -1,11 +1,19 @@
 #include <TinyGPS++.h>
-#include <SPIFFS.h>
 #include "APRSPacketLib.h"
 #include "notification_utils.h"
 #include "bluetooth_utils.h"
 #include "winlink_utils.h"
 #include "configuration.h"
 #include "lora_utils.h"
+#include "perf_utils.h"
+#include "heap_utils.h"
+#include "hal_utils.h"
+#include "sleep_utils.h"
+#include "filter_utils.h"
+#include "afc_utils.h"
+#include "frame_utils.h"
+#include "digi_utils.h"
+#include "link_utils.h"
 #include "msg_utils.h"
 #include "gps_utils.h"
 #include "display.h"
@@ -14,6 +22,7 @@
 extern Beacon               *currentBeacon;
 extern logging::Logger      logger;
 extern Configuration        Config;
+extern TinyGPSPlus          gps;
 
 extern int                  menuDisplay;
 extern uint32_t             menuTime;
@@ -43,20 +52,17 @@ bool    noAPRSMsgWarning        = false;
 bool    noWLNKMsgWarning        = false;
 String  lastHeardTracker        = "NONE";
 
+String  lastReceivedFrame;
+int     lastReceivedFrameRssi       = 0;
+float   lastReceivedFrameSnr        = 0;
+int     lastReceivedFrameFreqError  = 0;
+bool    lastReceivedPacketDecoded   = false;
+
 std::vector<String>             loadedAPRSMessages;
 std::vector<String>             loadedWLNKMails;
-std::vector<String>             outputMessagesBuffer;
-std::vector<String>             outputAckRequestBuffer;
-std::vector<String>             packet25SegBuffer;
-
-bool        ackRequestState     = false;
-String      ackCallsignRequest  = "";
-String      ackNumberRequest    = "";
-uint32_t    lastMsgRxTime       = millis();
-uint32_t    lastRetryTime       = millis();
 
 bool        messageLed          = false;
-uint32_t    messageLedTime      = millis();
+uint32_t    messageLedTime      = HAL::now();
 
 
 namespace MSG_Utils {
@@ -82,100 +88,59 @@ namespace MSG_Utils {
     }
 
     void loadNumMessages() {
-        if(!SPIFFS.begin(true)) {
+        if(!HAL::mountStorage()) {
             Serial.println("An Error has occurred while mounting SPIFFS");
             return;
         }
 
-        File fileToReadAPRS = SPIFFS.open("/aprsMessages.txt");
-        if(!fileToReadAPRS) {
+        std::vector<String> v1;
+        if(!HAL::readLines("/aprsMessages.txt", v1)) {
             Serial.println("Failed to open APRS_Msg for reading");
             return;
         }
-
-        std::vector<String> v1;
-        while (fileToReadAPRS.available()) {
-            v1.push_back(fileToReadAPRS.readStringUntil('\n'));
-        }
-        fileToReadAPRS.close();
-
-        numAPRSMessages = 0;
-        for (String s1 : v1) {
-            numAPRSMessages++;
-        }
+        numAPRSMessages = v1.size();
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Number of APRS Messages : %s", String(numAPRSMessages));
-    
-        File fileToReadWLNK = SPIFFS.open("/winlinkMails.txt");
-        if(!fileToReadWLNK) {
-            Serial.println("Failed to open Winlink_Msg for reading");
-            return;
-        }
 
         std::vector<String> v2;
-        while (fileToReadWLNK.available()) {
-            v2.push_back(fileToReadWLNK.readStringUntil('\n'));
-        }
-        fileToReadWLNK.close();
-
-        numWLNKMessages = 0;
-        for (String s2 : v2) {
-            numWLNKMessages++;
+        if(!HAL::readLines("/winlinkMails.txt", v2)) {
+            Serial.println("Failed to open Winlink_Msg for reading");
+            return;
         }
+        numWLNKMessages = v2.size();
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Number of Winlink Mails : %s", String(numWLNKMessages));
     }
 
     void loadMessagesFromMemory(uint8_t typeOfMessage) {
-        File fileToRead;
         if (typeOfMessage == 0) {  // APRS
-            noAPRSMsgWarning = false;
-            if (numAPRSMessages == 0) {
-                noAPRSMsgWarning = true;
-            } else {
-                loadedAPRSMessages.clear();
-                fileToRead = SPIFFS.open("/aprsMessages.txt");
-            }
+            noAPRSMsgWarning = (numAPRSMessages == 0);
             if (noAPRSMsgWarning) {
                 displayShow("___INFO___", "", " NO APRS MSG SAVED", 1500);
             } else {
-                if(!fileToRead) {
+                loadedAPRSMessages.clear();
+                if(!HAL::readLines("/aprsMessages.txt", loadedAPRSMessages)) {
                     Serial.println("Failed to open file for reading");
-                    return;
                 }
-                while (fileToRead.available()) {
-                    loadedAPRSMessages.push_back(fileToRead.readStringUntil('\n'));
-                }
-                fileToRead.close();
             }
         } else if (typeOfMessage == 1) { // WLNK
-            noWLNKMsgWarning = false;
-            if (numWLNKMessages == 0) {
-                noWLNKMsgWarning = true;
-            } else {
-                loadedWLNKMails.clear();
-                fileToRead = SPIFFS.open("/winlinkMails.txt");
-            }
+            noWLNKMsgWarning = (numWLNKMessages == 0);
             if (noWLNKMsgWarning) {
                 displayShow("___INFO___", "", " NO WLNK MAILS SAVED", 1500);
             } else {
-                if(!fileToRead) {
+                loadedWLNKMails.clear();
+                if(!HAL::readLines("/winlinkMails.txt", loadedWLNKMails)) {
                     Serial.println("Failed to open file for reading");
-                    return;
-                }
-                while (fileToRead.available()) {
-                    loadedWLNKMails.push_back(fileToRead.readStringUntil('\n'));
                 }
-                fileToRead.close();
-            } 
-        }    
+            }
+        }
     }
 
     void ledNotification() {
-        uint32_t ledTimeDelta = millis() - messageLedTime;
+        uint32_t ledTimeDelta = HAL::now() - messageLedTime;
         if (messageLed && ledTimeDelta > 5 * 1000) {
             digitalWrite(Config.notification.ledMessagePin, HIGH);
-            messageLedTime = millis();
+            messageLedTime = HAL::now();
         }
-        uint32_t ledOnDelta = millis() - messageLedTime;
+        uint32_t ledOnDelta = HAL::now() - messageLedTime;
         if (messageLed && ledOnDelta > 1 * 1000) {
             digitalWrite(Config.notification.ledMessagePin, LOW);
         }
@@ -185,14 +150,14 @@ namespace MSG_Utils {
     }
 
     void deleteFile(uint8_t typeOfFile) {
-        if(!SPIFFS.begin(true)) {
+        if(!HAL::mountStorage()) {
             Serial.println("An Error has occurred while mounting SPIFFS");
             return;
         }
         if (typeOfFile == 0) {  //APRS
-            SPIFFS.remove("/aprsMessages.txt");
+            HAL::removeFile("/aprsMessages.txt");
         } else if (typeOfFile == 1) {   //WLNK
-            SPIFFS.remove("/winlinkMails.txt");
+            HAL::removeFile("/winlinkMails.txt");
         }    
         if (Config.notification.ledMessage) {
             messageLed = false;
@@ -201,42 +166,31 @@ namespace MSG_Utils {
 
     void saveNewMessage(uint8_t typeMessage, const String& station, const String& newMessage) {
         String message = newMessage;
-        if (typeMessage == 0 && lastMessageSaved != message) {   //APRS
-            File fileToAppendAPRS = SPIFFS.open("/aprsMessages.txt", FILE_APPEND);
-            if(!fileToAppendAPRS) {
-                Serial.println("There was an error opening the file for appending");
-                return;
-            }
-            message.trim();
-            if(!fileToAppendAPRS.println(station + "," + message)) {
-                Serial.println("File append failed");
-            }
-            lastMessageSaved = message;
+        if ((typeMessage != 0 && typeMessage != 1) || lastMessageSaved == message) return;
+        message.trim();
+        bool saved;
+        if (typeMessage == 0) {     //APRS
+            saved = HAL::appendLine("/aprsMessages.txt", station + "," + message);
+        } else {                    //WLNK
+            saved = HAL::appendLine("/winlinkMails.txt", message);
+        }
+        if (!saved) {
+            Serial.println("File append failed");
+            return;
+        }
+        lastMessageSaved = message;
+        if (typeMessage == 0) {
             numAPRSMessages++;
-            fileToAppendAPRS.close();
-            if (Config.notification.ledMessage) {
-                messageLed = true;
-            }
-        } else if (typeMessage == 1 && lastMessageSaved != message) {    //WLNK
-            File fileToAppendWLNK = SPIFFS.open("/winlinkMails.txt", FILE_APPEND);
-            if(!fileToAppendWLNK) {
-                Serial.println("There was an error opening the file for appending");
-                return;
-            }
-            message.trim();
-            if(!fileToAppendWLNK.println(message)) {
-                Serial.println("File append failed");
-            }
-            lastMessageSaved = message;
+        } else {
             numWLNKMessages++;
-            fileToAppendWLNK.close();
-            if (Config.notification.ledMessage) {
-                messageLed = true;
-            }
+        }
+        if (Config.notification.ledMessage) {
+            messageLed = true;
         }
     }
 
     void sendMessage(const String& station, const String& textMessage) {
+        HEAP_TRACK(HEAP_MESSAGES);
         String newPacket = APRSPacketLib::generateMessagePacket(currentBeacon->callsign, "APLRT1", Config.path, station, textMessage);
         #if HAS_TFT
         cleanTFT();
@@ -245,7 +199,7 @@ namespace MSG_Utils {
             displayShow("<<ACK Tx>>", "", "", 500);
         } else if (station.indexOf("CA2RXU-15") == 0 && textMessage.indexOf("wrl") == 0) {
             displayShow("<WEATHER>","", "--- Sending Query ---",  1000);
-            wxRequestTime = millis();
+            wxRequestTime = HAL::now();
             wxRequestStatus = true;
         } else {
             if (station == "WLNK-1") {
@@ -257,187 +211,82 @@ namespace MSG_Utils {
         LoRa_Utils::sendNewPacket(newPacket);
     }
 
-    const String ackRequestNumberGenerator() {
-        ackRequestNumber++;
-        if (ackRequestNumber > 999) {
-            ackRequestNumber = 1;
+    static void trimReceivedMessage() {
+        if (lastReceivedPacket.message.indexOf("\x3c\xff\x01") != -1) {
+            lastReceivedPacket.message = lastReceivedPacket.message.substring(0, lastReceivedPacket.message.indexOf("\x3c\xff\x01"));
         }
-        return String(ackRequestNumber);
     }
 
-    void addToOutputBuffer(uint8_t typeOfMessage, const String& station, const String& textMessage) {
-        bool alreadyInBuffer;
-        if (typeOfMessage == 1) {
-            alreadyInBuffer = false;
-            if (!outputMessagesBuffer.empty()) {
-                for (int i = 0; i < outputMessagesBuffer.size(); i++) {
-                    if (outputMessagesBuffer[i].indexOf(station + "," + textMessage) == 0) {
-                        alreadyInBuffer = true;
-                    }
-                }
-            }
-            if (!outputAckRequestBuffer.empty()) {
-                for (int j = 0; j < outputAckRequestBuffer.size(); j++) {
-                    if (outputAckRequestBuffer[j].indexOf(station + "," + textMessage) > 1) {
-                        alreadyInBuffer = true;
-                    }
-                }
-            }               
-            if (!alreadyInBuffer) {
-                outputMessagesBuffer.push_back(station + "," + textMessage + "{" + ackRequestNumberGenerator());
-            }
-        } else if (typeOfMessage == 0) {
-            alreadyInBuffer = false;
-            if (!outputMessagesBuffer.empty()) {
-                for (int k = 0; k < outputMessagesBuffer.size(); k++) {
-                    if (outputMessagesBuffer[k].indexOf(station + "," + textMessage) == 0) {
-                        alreadyInBuffer = true;
-                    }
-                }
-            }
-            if (!alreadyInBuffer) {
-                outputMessagesBuffer.push_back(station + "," + textMessage);
-            }
-        }
-    }
-
-    bool checkOutputBufferEmpty() {
-        if(outputMessagesBuffer.empty()) {
-            return true;
-        }
-        return false;
-    }
-
-    void processOutputBuffer() {
-        if (!outputMessagesBuffer.empty() && (millis() - lastMsgRxTime) >= 6000 && (millis() - lastTxTime) > 3000) {
-            String addressee = outputMessagesBuffer[0].substring(0, outputMessagesBuffer[0].indexOf(","));
-            String message = outputMessagesBuffer[0].substring(outputMessagesBuffer[0].indexOf(",") + 1);
-            if (message.indexOf("{") > 0) {     // message with ack Request
-                outputAckRequestBuffer.push_back("6," + addressee + "," + message);  // 6 is for ack packets retries
-                outputMessagesBuffer.erase(outputMessagesBuffer.begin());
-            } else {                            // message without ack Request
-                sendMessage(addressee, message);
-                outputMessagesBuffer.erase(outputMessagesBuffer.begin());
-                lastTxTime = millis();
-            }
-        }
-        if (outputAckRequestBuffer.empty()) {
-            ackRequestState = false;
-        } else if (!outputAckRequestBuffer.empty() && (millis() - lastMsgRxTime) >= 4500 && (millis() - lastTxTime) > 3000) {
-            bool sendRetry = false;
-            String triesLeft = outputAckRequestBuffer[0].substring(0 , outputAckRequestBuffer[0].indexOf(","));
-            switch (triesLeft.toInt()) {
-                case 6:
-                    sendRetry = true;
-                    ackRequestState = true;
-                    break;
-                case 5:
-                    if (millis() - lastRetryTime > 30 * 1000) sendRetry = true;
-                    break;
-                case 4:
-                    if (millis() - lastRetryTime > 60 * 1000) sendRetry = true;
-                    break;
-                case 3:
-                    if (millis() - lastRetryTime > 120 * 1000) sendRetry = true;
-                    break;
-                case 2:
-                    if (millis() - lastRetryTime > 120 * 1000) sendRetry = true;
-                    break;
-                case 1:
-                    if (millis() - lastRetryTime > 120 * 1000) sendRetry = true;
-                    break;
-                case 0:
-                    if (millis() - lastRetryTime > 30 * 1000) {
-                        ackRequestNumber = false;
-                        outputAckRequestBuffer.erase(outputAckRequestBuffer.begin());
-                        if (winlinkStatus > 0 && winlinkStatus < 5) {   // if not complete Winlink Challenge Process it will reset Login process
-                            winlinkStatus = 0;
-                        }                     
-                    }
-                    break;
-            }
-            if (sendRetry) {
-                String rest = outputAckRequestBuffer[0].substring(outputAckRequestBuffer[0].indexOf(",") + 1);
-                ackCallsignRequest = rest.substring(0, rest.indexOf(","));
-                String payload = rest.substring(rest.indexOf(",") + 1);
-                ackNumberRequest = payload.substring(payload.indexOf("{") + 1);                
-                sendMessage(ackCallsignRequest, payload);
-                lastTxTime = millis();
-                lastRetryTime = millis();
-                outputAckRequestBuffer[0] = String(triesLeft.toInt() - 1) + "," + ackCallsignRequest + "," + payload;
-            }
-        }
-    }
-
-    void clean25SegBuffer() {
-        if (!packet25SegBuffer.empty()) {
-            String deltaTimeString = packet25SegBuffer[0].substring(0, packet25SegBuffer[0].indexOf(","));
-            uint32_t deltaTime = deltaTimeString.toInt();
-            if ((millis() - deltaTime) >  25 * 1000) {
-                packet25SegBuffer.erase(packet25SegBuffer.begin());
-            }
-        }
+    void decodeLastReceivedPacket() {
+        if (lastReceivedPacketDecoded || lastReceivedFrame.isEmpty()) return;
+        HEAP_TRACK(HEAP_PACKETLIB);
+        lastReceivedPacket = APRSPacketLib::processReceivedPacket(lastReceivedFrame, lastReceivedFrameRssi, lastReceivedFrameSnr, lastReceivedFrameFreqError);
+        trimReceivedMessage();
+        lastReceivedPacketDecoded = true;
     }
 
-    bool check25SegBuffer(const String& station, const String& textMessage) {
-        if (!packet25SegBuffer.empty()) {
-            bool shouldBeIgnored = false;
-            for (int i = 0; i < packet25SegBuffer.size(); i++) {
-                String temp = packet25SegBuffer[i].substring(packet25SegBuffer[i].indexOf(",") + 1);
-                String bufferStation = temp.substring(0, temp.indexOf(","));
-                String bufferMessage = temp.substring(temp.indexOf(",") + 1);
-                if (bufferStation == station && bufferMessage == textMessage) {
-                    shouldBeIgnored = true;
-                }
-            }
-            if (shouldBeIgnored) {
-                return false;
-            } else {
-                packet25SegBuffer.push_back(String(millis()) + "," + station + "," + textMessage);
-                return true;
-            }
-        } else {
-            packet25SegBuffer.push_back(String(millis()) + "," + station + "," + textMessage);
-            return true;
-        }
-    }
-    
     void checkReceivedMessage(ReceivedLoRaPacket packet) {
+        PERF_SCOPE(PERF_MSG_RX);
         if(packet.text.isEmpty()) {
             return;
         }
+        HEAP_TRACK(HEAP_MESSAGES);
         if (packet.text.substring(0,3) == "\x3c\xff\x01") {              // its an APRS packet
             //Serial.println(packet.text); // only for debug
-            lastReceivedPacket = APRSPacketLib::processReceivedPacket(packet.text.substring(3),packet.rssi, packet.snr, packet.freqError);
-            if (lastReceivedPacket.sender!=currentBeacon->callsign) {
+            const String frame = packet.text.substring(3);
+
+            // Route on the header alone, the full decode only runs when a consumer needs the decoded fields
+            FrameHeader header = FRAME_Utils::classify(frame);
+            if (!header.valid) return;
+            LINK_Utils::processPacket(frame, header, packet.rssi, packet.snr);
+            AFC_Utils::processPacket(frame, header, packet.snr, packet.freqError);
+            DIGI_Utils::processPacket(frame, header);
+
+            const FrameHeader content = header.thirdParty ? FRAME_Utils::classify(frame, header.payloadStart + 2) : header;
+            if (!content.valid) return;
+            const String sender = FRAME_Utils::getSource(frame, content);
+            if (sender != currentBeacon->callsign) {
+
+                // Receive filter gates station list, notifications and display. Messages for us always pass
+                bool messageForUs   = FRAME_Utils::isAddressedTo(frame, content, currentBeacon->callsign);
+                APRSPacket filterDecoded;
+                bool filterDecodedValid = false;
+                if (!messageForUs && FILTER_Utils::isActive()) {
+                    FILTER_Utils::setPosition(gps.location.isValid(), gps.location.lat(), gps.location.lng());
+                    if (!FILTER_Utils::passes(frame, content, currentBeacon->callsign, filterDecoded, filterDecodedValid)) return;
+                }
 
-                if (lastReceivedPacket.message.indexOf("\x3c\xff\x01") != -1) {
-                    lastReceivedPacket.message = lastReceivedPacket.message.substring(0, lastReceivedPacket.message.indexOf("\x3c\xff\x01"));
+                lastReceivedFrame           = frame;
+                lastReceivedFrameRssi       = packet.rssi;
+                lastReceivedFrameSnr        = packet.snr;
+                lastReceivedFrameFreqError  = packet.freqError;
+                lastReceivedPacketDecoded   = false;
+                if (filterDecodedValid) {
+                    lastReceivedPacket              = filterDecoded;
+                    lastReceivedPacket.rssi         = packet.rssi;
+                    lastReceivedPacket.snr          = packet.snr;
+                    lastReceivedPacket.freqError    = packet.freqError;
+                    trimReceivedMessage();
+                    lastReceivedPacketDecoded       = true;
                 }
 
-                if (check25SegBuffer(lastReceivedPacket.sender, lastReceivedPacket.message)) {
-                    if (digirepeaterActive && lastReceivedPacket.addressee != currentBeacon->callsign) {
-                        String digiRepeatedPacket = APRSPacketLib::generateDigiRepeatedPacket(packet.text, currentBeacon->callsign, Config.path);
-                        if (digiRepeatedPacket == "X") {
-                            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Main", "%s", "Packet won't be Repeated (Missing WIDEn-N)");
-                        } else {
-                            delay(500);
-                            LoRa_Utils::sendNewPacket(digiRepeatedPacket);
-                        }
-                    }
-                    lastHeardTracker = lastReceivedPacket.sender;
+                String payload = frame.substring(content.payloadStart + 1);
+                if (payload.indexOf("\x3c\xff\x01") != -1) {
+                    payload = payload.substring(0, payload.indexOf("\x3c\xff\x01"));
+                }
 
-                    if (lastReceivedPacket.type == 1 && lastReceivedPacket.addressee == currentBeacon->callsign) {
+                if (check25SegBuffer(sender, payload)) {
+                    lastHeardTracker = sender;
 
-                        if (ackRequestState && lastReceivedPacket.message.indexOf("ack") == 0) {
-                            if (ackCallsignRequest == lastReceivedPacket.sender && ackNumberRequest == lastReceivedPacket.message.substring(lastReceivedPacket.message.indexOf("ack") + 3)) {
-                                outputAckRequestBuffer.erase(outputAckRequestBuffer.begin());
-                                ackRequestState = false;
-                            }
-                        }
+                    bool stationUpdate  = (content.type == 0 || content.type == 4) && !Config.simplifiedTrackerMode;
+                    if (messageForUs || stationUpdate) decodeLastReceivedPacket();
+
+                    if (messageForUs) {
+
+                        checkAck(lastReceivedPacket.sender, lastReceivedPacket.message);
                         if (lastReceivedPacket.message.indexOf("{") >= 0) {
                             MSG_Utils::addToOutputBuffer(0, lastReceivedPacket.sender, "ack" + lastReceivedPacket.message.substring(lastReceivedPacket.message.indexOf("{") + 1));
-                            lastMsgRxTime = millis();
+                            holdOutputBuffer();
                             lastReceivedPacket.message = lastReceivedPacket.message.substring(0, lastReceivedPacket.message.indexOf("{"));
                         }
 
@@ -445,7 +294,7 @@ namespace MSG_Utils {
                             NOTIFICATION_Utils::messageBeep();
                         }
                         if (lastReceivedPacket.message.indexOf("ping") == 0 || lastReceivedPacket.message.indexOf("Ping") == 0 || lastReceivedPacket.message.indexOf("PING") == 0) {
-                            lastMsgRxTime = millis();
+                            holdOutputBuffer();
                             MSG_Utils::addToOutputBuffer(0, lastReceivedPacket.sender, "pong, 73!");
                         }
 
@@ -484,45 +333,45 @@ namespace MSG_Utils {
                             menuTime = millis();
                         } else if (lastReceivedPacket.sender == "WLNK-1") {
                             if (winlinkStatus == 0 && !Config.simplifiedTrackerMode) {
-                                lastMsgRxTime = millis();
+                                holdOutputBuffer();
                                 if (lastReceivedPacket.message.indexOf("ack") != 0) {
                                     saveNewMessage(0, lastReceivedPacket.sender, lastReceivedPacket.message);
                                 }                                    
-                            } else if (winlinkStatus == 1 && ackNumberRequest == lastReceivedPacket.message.substring(lastReceivedPacket.message.indexOf("ack") + 3)) {
+                            } else if (winlinkStatus == 1 && getAckNumberRequest() == lastReceivedPacket.message.substring(lastReceivedPacket.message.indexOf("ack") + 3)) {
                                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Winlink","---> Waiting Challenge");
-                                lastMsgRxTime = millis();
+                                holdOutputBuffer();
                                 winlinkStatus = 2;
                                 menuDisplay = 500;
                             } else if ((winlinkStatus >= 1 || winlinkStatus <= 3) &&lastReceivedPacket.message.indexOf("Login [") == 0) {
                                 WINLINK_Utils::processWinlinkChallenge(lastReceivedPacket.message.substring(lastReceivedPacket.message.indexOf("[")+1,lastReceivedPacket.message.indexOf("]")));
                                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Challenge Received/Processed/Sended");
-                                lastMsgRxTime = millis();
+                                holdOutputBuffer();
                                 winlinkStatus = 3;
                                 menuDisplay = 501;
-                            } else if (winlinkStatus == 3 && ackNumberRequest == lastReceivedPacket.message.substring(lastReceivedPacket.message.indexOf("ack") + 3)) {
+                            } else if (winlinkStatus == 3 && getAckNumberRequest() == lastReceivedPacket.message.substring(lastReceivedPacket.message.indexOf("ack") + 3)) {
                                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Winlink","---> Challenge Ack Received");
-                                lastMsgRxTime = millis();
+                                holdOutputBuffer();
                                 winlinkStatus = 4;
                                 menuDisplay = 502;
                             } else if (lastReceivedPacket.message.indexOf("Login valid for") > 0) {
                                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Login Succesfull");
-                                lastMsgRxTime = millis();
+                                holdOutputBuffer();
                                 winlinkStatus = 5;
                                 displayShow("_WINLINK_>", "", " LOGGED !!!!", 2000);
                                 menuDisplay = 5000;
                             } else if (winlinkStatus == 5 && lastReceivedPacket.message.indexOf("Log off successful") == 0 ) {
                                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Log Out");
-                                lastMsgRxTime = millis();
+                                holdOutputBuffer();
                                 displayShow("_WINLINK_>", "", "    LOG OUT !!!", 2000);
                                 winlinkStatus = 0;
                             } else if ((winlinkStatus == 5) && (lastReceivedPacket.message.indexOf("Log off successful") == -1) && (lastReceivedPacket.message.indexOf("Login valid") == -1) && (lastReceivedPacket.message.indexOf("Login [") == -1) && (lastReceivedPacket.message.indexOf("ack") == -1)) {
-                                lastMsgRxTime = millis();
+                                holdOutputBuffer();
                                 displayShow("<WLNK Rx >", "", lastReceivedPacket.message, 3000);
                                 saveNewMessage(1, lastReceivedPacket.sender, lastReceivedPacket.message);
                             } 
                         } else {
                             if (!Config.simplifiedTrackerMode) {
-                                lastMsgRxTime = millis();
+                                holdOutputBuffer();
 
                                 #ifdef HAS_TFT
                                     displayMessage(lastReceivedPacket.sender,lastReceivedPacket.message, 26, false, 3000);
@@ -536,7 +385,7 @@ namespace MSG_Utils {
                             }
                         }
                     } else {
-                        if ((lastReceivedPacket.type == 0 || lastReceivedPacket.type == 4) && !Config.simplifiedTrackerMode) {
+                        if (stationUpdate && (lastReceivedPacket.type == 0 || lastReceivedPacket.type == 4)) {
                             GPS_Utils::calculateDistanceCourse(lastReceivedPacket.sender, lastReceivedPacket.latitude, lastReceivedPacket.longitude);
                         }
                         if (Config.notification.buzzerActive && Config.notification.stationBeep && !digirepeaterActive) {
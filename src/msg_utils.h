@@ -21,8 +21,12 @@ namespace MSG_Utils {
     void    addToOutputBuffer(uint8_t typeOfMessage, const String& station, const String& textMessage);
     bool    checkOutputBufferEmpty();
     void    processOutputBuffer();
+    void    holdOutputBuffer();                         // a message was just heard, leave the channel to the reply for a while
+    const String& getAckNumberRequest();
+    void    checkAck(const String& station, const String& message);
     void    clean25SegBuffer();
     bool    check25SegBuffer(const String& station, const String& textMessage);
+    void    decodeLastReceivedPacket();
     void    checkReceivedMessage(ReceivedLoRaPacket packetReceived);
     
 }
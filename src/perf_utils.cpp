@@ -0,0 +1,99 @@
+#ifdef PERF_PROFILING
+
+#include <algorithm>
+#include "power_utils.h"
+#include "perf_utils.h"
+
+#ifdef GOVERNOR_NO_BOOST
+    #define PERF_BOOSTS     "off"       // 80 MHz reference run
+#else
+    #define PERF_BOOSTS     "on"
+#endif
+
+extern uint32_t     displayRefreshes;
+extern uint32_t     displaySkipped;
+extern uint32_t     displayBytesPushed;
+
+struct PerfStats {
+    uint32_t    count;
+    uint64_t    total;
+    uint32_t    minTime;
+    uint32_t    maxTime;
+    uint8_t     ringIndex;
+    uint32_t    ring[PERF_RING_SIZE];
+};
+
+PerfStats   perfStats[PERF_SECTIONS];
+
+const char  *perfSectionNames[PERF_SECTIONS] = {"Loop", "Batt", "SmrtB", "Buttn", "Keybd", "LoRaRx", "BtPhon", "MsgRx", "MsgTx", "Statn", "BtLoRa", "GPS", "Beacon", "Disp"};
+
+
+namespace PERF_Utils {
+
+    void record(uint8_t section, uint32_t elapsed) {
+        if (section >= PERF_SECTIONS) return;
+        PerfStats &stats = perfStats[section];
+        if (stats.count == 0 || elapsed < stats.minTime) stats.minTime = elapsed;
+        if (elapsed > stats.maxTime) stats.maxTime = elapsed;
+        stats.count++;
+        stats.total += elapsed;
+        stats.ring[stats.ringIndex] = elapsed;
+        stats.ringIndex = (stats.ringIndex + 1) % PERF_RING_SIZE;
+    }
+
+    void getStats(uint8_t section, uint32_t &minTime, uint32_t &avgTime, uint32_t &maxTime, uint32_t &p99Time) {
+        const PerfStats &stats = perfStats[section];
+        if (stats.count == 0) {
+            minTime = avgTime = maxTime = p99Time = 0;
+            return;
+        }
+        minTime = stats.minTime;
+        maxTime = stats.maxTime;
+        avgTime = stats.total / stats.count;
+
+        uint32_t samples[PERF_RING_SIZE];
+        uint8_t numSamples = stats.count < PERF_RING_SIZE ? stats.count : PERF_RING_SIZE;
+        memcpy(samples, stats.ring, numSamples * sizeof(uint32_t));
+        std::sort(samples, samples + numSamples);
+        p99Time = samples[(numSamples * 99 + 99) / 100 - 1];
+    }
+
+    const String getSectionName(uint8_t section) {
+        return (section < PERF_SECTIONS) ? perfSectionNames[section] : "";
+    }
+
+    const String getStatsLine(uint8_t section) {
+        uint32_t minTime, avgTime, maxTime, p99Time;
+        getStats(section, minTime, avgTime, maxTime, p99Time);
+        String line = getSectionName(section);
+        for (int i = line.length(); i < 7; i++) {
+            line += " ";
+        }
+        line += String(avgTime / 1000.0, 1);
+        line += "/";
+        line += String(p99Time / 1000.0, 1);
+        line += "/";
+        line += String(maxTime / 1000.0, 1);
+        return line;
+    }
+
+    void dumpCSV() {
+        Serial.println("section,count,min_us,avg_us,max_us,p99_us");
+        for (uint8_t i = 0; i < PERF_SECTIONS; i++) {
+            uint32_t minTime, avgTime, maxTime, p99Time;
+            getStats(i, minTime, avgTime, maxTime, p99Time);
+            Serial.printf("%s,%u,%u,%u,%u,%u\n", perfSectionNames[i], (unsigned int)perfStats[i].count, (unsigned int)minTime, (unsigned int)avgTime, (unsigned int)maxTime, (unsigned int)p99Time);
+        }
+        Serial.printf("# display refreshes=%u skipped=%u pushed=%u per_refresh=%u\n", (unsigned int)displayRefreshes, (unsigned int)displaySkipped,
+                        (unsigned int)displayBytesPushed, (unsigned int)(displayRefreshes > 0 ? displayBytesPushed / displayRefreshes : 0));
+        Serial.printf("# governor=%s boosts=%s boost=%u%% idle=%u%%\n", POWER_Utils::isGovernorDfs() ? "dfs" : "manual", PERF_BOOSTS,
+                        (unsigned int)POWER_Utils::getBoostShare(), (unsigned int)POWER_Utils::getIdleShare());
+    }
+
+    void reset() {
+        memset(perfStats, 0, sizeof(perfStats));
+    }
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef PERF_UTILS_H_
+#define PERF_UTILS_H_
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Section profiler on the esp_timer microsecond clock, which keeps its rate when the governor moves the CPU
+// between 80 and 240 MHz mid-section. Enable with "-DPERF_PROFILING" in build_flags, otherwise
+// every PERF_* macro expands to nothing and the module is compiled out.
+
+enum PerfSection {
+    PERF_LOOP,
+    PERF_BATTERY,
+    PERF_SMARTBEACON,
+    PERF_BUTTON,
+    PERF_KEYBOARD,
+    PERF_LORA_RX,
+    PERF_BT_TO_PHONE,
+    PERF_MSG_RX,
+    PERF_MSG_TX,
+    PERF_STATIONS,
+    PERF_BT_TO_LORA,
+    PERF_GPS,
+    PERF_BEACON,
+    PERF_DISPLAY,
+    PERF_SECTIONS
+};
+
+#ifdef PERF_PROFILING
+
+#define PERF_RING_SIZE  64
+
+namespace PERF_Utils {
+
+    void    record(uint8_t section, uint32_t elapsed);      // us
+    void    getStats(uint8_t section, uint32_t &minTime, uint32_t &avgTime, uint32_t &maxTime, uint32_t &p99Time);
+    const String getSectionName(uint8_t section);
+    const String getStatsLine(uint8_t section);
+    void    dumpCSV();
+    void    reset();
+
+    class ScopeTimer {
+    public:
+        explicit ScopeTimer(uint8_t section) : section(section), start((uint32_t)esp_timer_get_time()) {}
+        ~ScopeTimer() { record(section, (uint32_t)esp_timer_get_time() - start); }
+    private:
+        uint8_t     section;
+        uint32_t    start;
+    };
+
+}
+
+#define PERF_BEGIN(section)     uint32_t perfStart_##section = (uint32_t)esp_timer_get_time()
+#define PERF_END(section)       PERF_Utils::record(section, (uint32_t)esp_timer_get_time() - perfStart_##section)
+#define PERF_SCOPE(section)     PERF_Utils::ScopeTimer perfScope_##section(section)
+
+#else
+
+#define PERF_BEGIN(section)
+#define PERF_END(section)
+#define PERF_SCOPE(section)
+
+#endif
+
+#endif
@@ -1,14 +1,24 @@
+#include <esp_timer.h>
 #include <SPI.h>
 #include "notification_utils.h"
 #include "configuration.h"
 #include "boards_pinout.h"
 #include "power_utils.h"
+#include "telemetry_utils.h"
 #include "lora_utils.h"
 #include "ble_utils.h"
 #include "gps_utils.h"
 #include "display.h"
 #include "logger.h"
 
+#ifdef CONFIG_PM_ENABLE
+    #include "esp_pm.h"
+    #if CONFIG_IDF_TARGET_ESP32S3
+        typedef esp_pm_config_esp32s3_t governor_config_t;
+    #else
+        typedef esp_pm_config_esp32_t   governor_config_t;
+    #endif
+#endif
 
 #if !defined(TTGO_T_Beam_S3_SUPREME_V3) && !defined(HELTEC_WIRELESS_TRACKER)
     #define I2C_SDA 21
@@ -43,6 +53,18 @@ bool        pmuInterrupt;
 float       lora32BatReadingCorr    = 6.5; // % of correction to higher value to reflect the real battery voltage (adjust this to your needs)
 bool        disableGPS;
 
+bool        governorActive          = false;
+bool        governorDfs             = false;
+uint8_t     governorBoosts          = 0;
+uint32_t    governorBoostEndTime    = 0;
+int64_t     governorStartTime       = 0;    // us, esp_timer
+int64_t     governorBoostStartTime  = 0;
+int64_t     governorIdleTime        = 0;
+int64_t     governorBoostTime       = 0;
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t    governorBoostLock   = NULL;
+#endif
+
 
 namespace POWER_Utils {
 
@@ -162,8 +184,17 @@ namespace POWER_Utils {
         static unsigned int rate_limit_check_battery = 0;
         if (!(rate_limit_check_battery++ % 60)) BatteryIsConnected = isBatteryConnected();
         if (BatteryIsConnected) {
-            batteryVoltage                  = String(getBatteryVoltage(), 2);
-            batteryChargeDischargeCurrent   = String(getBatteryChargeDischargeCurrent(), 0);
+            float   voltage = getBatteryVoltage();
+            double  current = getBatteryChargeDischargeCurrent();
+            batteryVoltage                  = String(voltage, 2);
+            batteryChargeDischargeCurrent   = String(current, 0);
+            TELEMETRY_Utils::publish(TELEMETRY_BATTERY, voltage);
+            #ifdef HAS_AXP192
+                TELEMETRY_Utils::publish(TELEMETRY_CURRENT, current);      // AXP2101 reports a percentage instead
+            #endif
+            #if defined(HAS_AXP192) || defined(HAS_AXP2101)
+                TELEMETRY_Utils::publishBit(TELEMETRY_BIT_CHARGING, isCharging());
+            #endif
         }
     }
 
@@ -227,6 +258,18 @@ namespace POWER_Utils {
         gpsIsActive = false;
     }
 
+    // Main supply off with the GNSS backup supply kept on, so time and ephemeris survive for a hot start. The
+    // T-Beam v1.x has a backup cell on the module; the Heltec tracker has no backup supply and starts cold.
+    void backupGPS() {
+        #ifdef HAS_AXP2101
+            PMU.setButtonBatteryChargeVoltage(3300);
+            PMU.enableButtonBatteryCharge();        // VBACKUP, GNSS RTC supply
+        #endif
+        #if defined(HAS_AXP192) || defined(HAS_AXP2101) || defined(HELTEC_WIRELESS_TRACKER)
+            deactivateGPS();
+        #endif
+    }
+
     void activateLoRa() {
         #ifdef HAS_AXP192
             PMU.setLDO2Voltage(3300);
@@ -454,12 +497,76 @@ namespace POWER_Utils {
         #endif
     }
 
-    void lowerCpuFrequency() {
-        if (setCpuFrequencyMhz(80)) {
-            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "CPU frequency set to 80MHz");
-        } else {
+    void setupGovernor() {
+        #ifdef CONFIG_PM_ENABLE
+            governor_config_t pmConfig;
+            pmConfig.max_freq_mhz       = GOVERNOR_MAX_MHZ;
+            pmConfig.min_freq_mhz       = GOVERNOR_MIN_MHZ;
+            pmConfig.light_sleep_enable = false;
+            governorDfs = esp_pm_configure(&pmConfig) == ESP_OK && esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "boost", &governorBoostLock) == ESP_OK;
+        #endif
+        if (!governorDfs && !setCpuFrequencyMhz(GOVERNOR_MIN_MHZ)) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Main", "CPU frequency unchanged");
+            return;
+        }
+        governorActive      = true;
+        governorStartTime   = esp_timer_get_time();
+        #ifdef GOVERNOR_NO_BOOST
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Main", "CPU governor %s, boosts off at %dMHz", governorDfs ? "DFS" : "manual", GOVERNOR_MIN_MHZ);
+        #else
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Main", "CPU governor %s %d-%dMHz", governorDfs ? "DFS" : "manual", GOVERNOR_MIN_MHZ, GOVERNOR_MAX_MHZ);
+        #endif
+    }
+
+    void boostBegin() {
+        if (!governorActive || governorBoosts++ > 0) return;
+        governorBoostStartTime = esp_timer_get_time();
+        #ifdef GOVERNOR_NO_BOOST
+            return;
+        #endif
+        #ifdef CONFIG_PM_ENABLE
+            if (governorDfs) {
+                esp_pm_lock_acquire(governorBoostLock);
+                return;
+            }
+        #endif
+        if (getCpuFrequencyMhz() != GOVERNOR_MAX_MHZ) setCpuFrequencyMhz(GOVERNOR_MAX_MHZ);
+    }
+
+    void boostEnd() {
+        if (!governorActive || governorBoosts == 0 || --governorBoosts > 0) return;
+        governorBoostTime       += esp_timer_get_time() - governorBoostStartTime;
+        governorBoostEndTime    = millis();
+        #if defined(CONFIG_PM_ENABLE) && !defined(GOVERNOR_NO_BOOST)
+            if (governorDfs) esp_pm_lock_release(governorBoostLock);
+        #endif
+    }
+
+    void idle() {
+        if (!governorActive) return;
+        if (!governorDfs && governorBoosts == 0 && millis() - governorBoostEndTime >= GOVERNOR_HOLD_MS && getCpuFrequencyMhz() != GOVERNOR_MIN_MHZ) {
+            setCpuFrequencyMhz(GOVERNOR_MIN_MHZ);
         }
+        int64_t start = esp_timer_get_time();
+        vTaskDelay(1);
+        governorIdleTime += esp_timer_get_time() - start;
+    }
+
+    bool isGovernorDfs() {
+        return governorDfs;
+    }
+
+    static uint8_t governorShare(int64_t time) {
+        int64_t elapsed = esp_timer_get_time() - governorStartTime;
+        return (governorActive && elapsed > 0) ? (uint8_t)(100 * time / elapsed) : 0;
+    }
+
+    uint8_t getIdleShare() {
+        return governorShare(governorIdleTime);
+    }
+
+    uint8_t getBoostShare() {
+        return governorShare(governorBoostTime);
     }
 
     void shutdown() {
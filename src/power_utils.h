@@ -8,6 +8,10 @@
     #include <Wire.h>
 #endif
 
+#define GOVERNOR_MIN_MHZ    80      // APB stays at 80 MHz down to here, so UART, SPI and I2C timing never changes
+#define GOVERNOR_MAX_MHZ    240
+#define GOVERNOR_HOLD_MS    100     // without DFS, how long the clock stays up after the last boost ends
+
 namespace POWER_Utils {
 
     double  getBatteryVoltage();
@@ -29,6 +33,7 @@ namespace POWER_Utils {
 
     void    activateGPS();
     void    deactivateGPS();
+    void    backupGPS();        // deep sleep: main supply off, backup supply on
 
     void    activateLoRa();
     void    deactivateLoRa();
@@ -38,9 +43,28 @@ namespace POWER_Utils {
     bool    begin(TwoWire &port);
     void    setup();
 
-    void    lowerCpuFrequency();
+    // CPU governor. With ESP-IDF power management (DFS) the clock is up while any task runs and down while all of
+    // them wait; without it the loop runs at GOVERNOR_MIN_MHZ and boosts switch the clock by hand. Boosts are taken
+    // from the loop task only, around bursts of work. "-DGOVERNOR_NO_BOOST" keeps the clock at GOVERNOR_MIN_MHZ
+    // while boosts are still counted: the 80 MHz reference for a profiler A/B run.
+    void    setupGovernor();
+    void    boostBegin();
+    void    boostEnd();
+    void    idle();                                 // end of every loop(): yield one tick so the CPU can wait
+    bool    isGovernorDfs();
+    uint8_t getIdleShare();                         // % of time since setupGovernor()
+    uint8_t getBoostShare();
+
+    class CpuBoost {
+    public:
+        CpuBoost() { boostBegin(); }
+        ~CpuBoost() { boostEnd(); }
+    };
+
     void    shutdown();
   
 }
 
+#define CPU_BOOST()     POWER_Utils::CpuBoost cpuBoost
+
 #endif
@@ -1,12 +1,91 @@
+#include <driver/rtc_io.h>
+#include <driver/gpio.h>
+#include <TinyGPS++.h>
+#include <sys/time.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <logger.h>
+#include "smartbeacon_utils.h"
+#include "configuration.h"
+#include "boards_pinout.h"
 #include "sleep_utils.h"
 #include "power_utils.h"
+#include "boot_utils.h"
+#include "lora_utils.h"
+#include "gps_utils.h"
+#include "geo_utils.h"
+#include "hal_utils.h"
+#include "display.h"
+#include "utils.h"
 
 
+extern Configuration    Config;
+extern logging::Logger  logger;
 extern uint32_t         lastGPSTime;
 extern bool             gpsIsActive;
+extern bool             bluetoothActive;
+extern bool             keyboardConnected;
+extern bool             messageLed;
+extern bool             displayState;
+extern int              menuDisplay;
+extern TinyGPSPlus      gps;
+extern uint8_t          myBeaconsIndex;
+extern uint8_t          loraIndex;
+extern bool             sendUpdate;
+extern bool             smartBeaconActive;
+extern uint32_t         lastTxTime;
+extern double           lastTxLat;
+extern double           lastTxLng;
+extern double           currentHeading;
+extern double           previousHeading;
+extern int              ackRequestNumber;
+extern int              telemetrySequence;
+extern uint8_t          updateCounter;
+extern uint8_t          commentCounter;
+extern int32_t          afcOffsetPpb;
+extern SmartBeaconValues    currentSmartBeaconValues;
+
+#define DEEP_SLEEP_MAGIC    0x44534C50
+
+// What a beacon-only wake needs from the previous one, everything else is rebuilt by setup()
+struct DeepSleepState {
+    uint32_t    magic;
+    uint8_t     beaconsIndex;
+    uint8_t     loraIndex;
+    uint8_t     updateCounter;
+    uint8_t     commentCounter;
+    double      lastTxLat;
+    double      lastTxLng;
+    double      heading;
+    int64_t     lastTxClock;        // us of gettimeofday(), which keeps counting through deep sleep, 0: never sent
+    int         telemetrySequence;
+    int         ackRequestNumber;
+    int32_t     afcOffsetPpb;
+    uint32_t    cycles;
+    uint32_t    missedFixes;
+    uint32_t    awakeTime;          // ms from wake to sleep of the last cycle
+    uint32_t    fixTime;            // ms from wake to fix of the last cycle, 0: none
+};
+
+RTC_DATA_ATTR DeepSleepState    deepSleepState;
 
 bool gpsShouldSleep     = false;
 
+bool        sleepDeadlineSet        = false;
+uint32_t    sleepDeadline           = 0;
+uint32_t    sleepAwakeUntil         = 0;
+uint32_t    sleepWakeups            = 0;
+uint32_t    sleepLogTime            = 0;
+uint32_t    sleepReportWakeups      = 0;
+int64_t     sleepStartTime          = 0;    // us, esp_timer
+int64_t     sleepTime               = 0;
+int64_t     sleepReportStart        = 0;
+int64_t     sleepReportSlept        = 0;
+
+bool        deepSleepWake           = false;
+bool        deepSleepButtonWake     = false;
+uint32_t    deepSleepFixTime        = 0;
+
 
 namespace SLEEP_Utils {
 
@@ -14,7 +93,7 @@ namespace SLEEP_Utils {
         #ifdef HAS_GPS_CTRL
             if (gpsIsActive) {
                 POWER_Utils::deactivateGPS();
-                lastGPSTime = millis();
+                lastGPSTime = HAL::now();
                 //
                 Serial.println("GPS SLEEPING");
                 //
@@ -40,4 +119,232 @@ namespace SLEEP_Utils {
         }
     }
 
-}
\ No newline at end of file
+    void wakeBy(uint32_t deadline) {
+        if (!sleepDeadlineSet || (int32_t)(deadline - sleepDeadline) < 0) {
+            sleepDeadline       = deadline;
+            sleepDeadlineSet    = true;
+        }
+    }
+
+    static bool canLightSleep(uint32_t now) {
+        if (!Config.lightSleep || (int32_t)(sleepAwakeUntil - now) > 0) return false;
+        if (Config.bluetooth.type == 0 || Config.bluetooth.type == 2 || bluetoothActive) return false;     // the controller would drop the link
+        if (Config.tdma.active || keyboardConnected) return false;                                         // slot timing, polled keyboard
+        if (menuDisplay != 0 || displayOverlayActive() || messageLed) return false;
+        #ifdef HAS_TFT
+            if (displayState) return false;     // the backlight PWM stops in light sleep
+        #endif
+        return true;
+    }
+
+    static void reportSleep() {
+        int64_t now     = esp_timer_get_time();
+        int64_t elapsed = now - sleepReportStart;
+        if (elapsed > 0) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Sleep", "Light sleep %u%% of the last %u min, %u wakeups",
+                        (unsigned int)(100 * (sleepTime - sleepReportSlept) / elapsed), (unsigned int)(elapsed / 60000000), (unsigned int)(sleepWakeups - sleepReportWakeups));
+        }
+        sleepReportStart    = now;
+        sleepReportSlept    = sleepTime;
+        sleepReportWakeups  = sleepWakeups;
+        sleepLogTime        = HAL::now();
+    }
+
+    static void lightSleep(uint32_t ms) {
+        if (!LoRa_Utils::prepareSleep()) {     // radio busy or a frame waiting
+            POWER_Utils::idle();
+            return;
+        }
+        esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+        #ifdef BUTTON_PIN
+            gpio_wakeup_enable((gpio_num_t)BUTTON_PIN, GPIO_INTR_LOW_LEVEL);
+        #endif
+        #if defined(GPS_TX) && GPS_TX >= 0
+            if (gpsIsActive) gpio_wakeup_enable((gpio_num_t)GPS_TX, GPIO_INTR_LOW_LEVEL);     // start bit of a burst that came early
+        #endif
+        esp_sleep_enable_gpio_wakeup();
+        Serial.flush();
+
+        int64_t start = esp_timer_get_time();
+        esp_light_sleep_start();
+        int64_t slept = esp_timer_get_time() - start;
+        sleepTime += slept;
+        Utils::skipLoopLatency((uint32_t)slept);
+        sleepWakeups++;
+        bool pinWakeup = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+
+        #ifdef BUTTON_PIN
+            gpio_wakeup_disable((gpio_num_t)BUTTON_PIN);
+            gpio_set_intr_type((gpio_num_t)BUTTON_PIN, GPIO_INTR_DISABLE);
+        #endif
+        #if defined(GPS_TX) && GPS_TX >= 0
+            if (gpsIsActive) {
+                gpio_wakeup_disable((gpio_num_t)GPS_TX);
+                gpio_set_intr_type((gpio_num_t)GPS_TX, GPIO_INTR_DISABLE);
+            }
+        #endif
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+        LoRa_Utils::resumeFromSleep();
+        if (pinWakeup) sleepAwakeUntil = HAL::now() + LIGHT_SLEEP_HOLD_MS;
+    }
+
+    void checkLightSleep() {
+        uint32_t now        = HAL::now();
+        uint32_t deadline   = now + LIGHT_SLEEP_MAX_MS;
+        if (sleepDeadlineSet && (int32_t)(sleepDeadline - deadline) < 0) deadline = sleepDeadline;
+        sleepDeadlineSet = false;
+        if (gpsIsActive) {
+            uint32_t burstTime = GPS_Utils::getNextBurstTime();
+            if ((int32_t)(burstTime - deadline) < 0) deadline = burstTime;
+        }
+
+        if (Config.lightSleep) {
+            if (sleepStartTime == 0) {
+                sleepStartTime      = esp_timer_get_time();
+                sleepReportStart    = sleepStartTime;
+                sleepLogTime        = now;
+            } else if (now - sleepLogTime >= LIGHT_SLEEP_REPORT_MS) {
+                reportSleep();
+            }
+        }
+
+        if (!canLightSleep(now) || (int32_t)(deadline - now) < LIGHT_SLEEP_MIN_MS) {
+            POWER_Utils::idle();
+            return;
+        }
+        lightSleep(deadline - now);
+    }
+
+    uint8_t getSleepShare() {
+        int64_t elapsed = esp_timer_get_time() - sleepStartTime;
+        return (sleepStartTime != 0 && elapsed > 0) ? (uint8_t)(100 * sleepTime / elapsed) : 0;
+    }
+
+    uint32_t getWakeCount() {
+        return sleepWakeups;
+    }
+
+    static int64_t systemClock() {
+        struct timeval now;
+        gettimeofday(&now, nullptr);
+        return (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+    }
+
+    bool restoreDeepSleepState() {
+        esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+        bool valid = deepSleepState.magic == DEEP_SLEEP_MAGIC;
+        deepSleepState.magic = 0;      // a reset or the shutdown sleep never resumes a stale cycle
+        if (!Config.deepSleep.active || !valid) return false;
+        if (cause != ESP_SLEEP_WAKEUP_TIMER && cause != ESP_SLEEP_WAKEUP_EXT0 && cause != ESP_SLEEP_WAKEUP_EXT1) return false;
+
+        deepSleepWake       = true;
+        deepSleepButtonWake = cause == ESP_SLEEP_WAKEUP_EXT0;
+        myBeaconsIndex      = deepSleepState.beaconsIndex < Config.beacons.size() ? deepSleepState.beaconsIndex : 0;
+        loraIndex           = deepSleepState.loraIndex < Config.loraTypes.size() ? deepSleepState.loraIndex : 0;
+        updateCounter       = deepSleepState.updateCounter;
+        commentCounter      = deepSleepState.commentCounter;
+        lastTxLat           = deepSleepState.lastTxLat;
+        lastTxLng           = deepSleepState.lastTxLng;
+        previousHeading     = deepSleepState.heading;
+        currentHeading      = deepSleepState.heading;
+        telemetrySequence   = deepSleepState.telemetrySequence;
+        ackRequestNumber    = deepSleepState.ackRequestNumber;
+        afcOffsetPpb        = deepSleepState.afcOffsetPpb;
+        if (deepSleepState.lastTxClock != 0) {
+            lastTxTime = HAL::now() - (uint32_t)((systemClock() - deepSleepState.lastTxClock) / 1000);
+        }
+        sendUpdate          = false;       // checkDeepSleep() decides once there is a fix
+
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Sleep", "Deep sleep wake %u by %s, last cycle %u ms awake, fix after %u ms, %u missed fixes",
+                    (unsigned int)deepSleepState.cycles, cause == ESP_SLEEP_WAKEUP_TIMER ? "timer" : deepSleepButtonWake ? "button" : "motion",
+                    (unsigned int)deepSleepState.awakeTime, (unsigned int)deepSleepState.fixTime, (unsigned int)deepSleepState.missedFixes);
+        return true;
+    }
+
+    bool isDeepSleepWake() {
+        return deepSleepWake;
+    }
+
+    static void deepSleep() {
+        uint32_t awakeTime = HAL::now();
+        if (deepSleepState.magic != DEEP_SLEEP_MAGIC && !deepSleepWake) {     // first cycle after power on
+            deepSleepState.cycles       = 0;
+            deepSleepState.missedFixes  = 0;
+            deepSleepState.lastTxClock  = 0;
+        }
+        if (BOOT_Utils::getFirstBeaconTime() != 0) {
+            deepSleepState.lastTxClock  = systemClock() - (int64_t)(awakeTime - lastTxTime) * 1000;
+        }
+        if (deepSleepFixTime == 0) deepSleepState.missedFixes++;
+        deepSleepState.beaconsIndex         = myBeaconsIndex;
+        deepSleepState.loraIndex            = loraIndex;
+        deepSleepState.updateCounter        = updateCounter;
+        deepSleepState.commentCounter       = commentCounter;
+        deepSleepState.lastTxLat            = lastTxLat;
+        deepSleepState.lastTxLng            = lastTxLng;
+        deepSleepState.heading              = previousHeading;
+        deepSleepState.telemetrySequence    = telemetrySequence;
+        deepSleepState.ackRequestNumber     = ackRequestNumber;
+        deepSleepState.afcOffsetPpb         = afcOffsetPpb;
+        deepSleepState.cycles++;
+        deepSleepState.awakeTime            = awakeTime;
+        deepSleepState.fixTime              = deepSleepFixTime;
+        deepSleepState.magic                = DEEP_SLEEP_MAGIC;
+
+        uint32_t intervalS  = Config.deepSleep.interval * 60;
+        uint32_t sleepS     = intervalS > awakeTime / 1000 + DEEP_SLEEP_MIN_S ? intervalS - awakeTime / 1000 : DEEP_SLEEP_MIN_S;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Sleep", "Deep sleep for %u s after %u ms awake, fix after %u ms",
+                    (unsigned int)sleepS, (unsigned int)awakeTime, (unsigned int)deepSleepFixTime);
+
+        Config.saveSnapshot();
+        LoRa_Utils::sleepRadio();
+        POWER_Utils::deactivateLoRa();
+        GPS_Utils::enterBackup(sleepS * 1000);     // hot start on the next wake
+        POWER_Utils::backupGPS();
+        displayToggle(false);
+
+        esp_sleep_enable_timer_wakeup((uint64_t)sleepS * 1000000);
+        gpio_num_t motionPin = (gpio_num_t)Config.deepSleep.motionPin;
+        if (Config.deepSleep.motionPin >= 0 && rtc_gpio_is_valid_gpio(motionPin) && gpio_get_level(motionPin) == 0) {     // still moving: timer only
+            esp_sleep_enable_ext1_wakeup(1ULL << motionPin, ESP_EXT1_WAKEUP_ANY_HIGH);
+        }
+        #ifdef BUTTON_PIN
+            if (rtc_gpio_is_valid_gpio((gpio_num_t)BUTTON_PIN)) esp_sleep_enable_ext0_wakeup((gpio_num_t)BUTTON_PIN, 0);
+        #endif
+        Serial.flush();
+        esp_deep_sleep_start();
+    }
+
+    static bool beaconDue() {
+        if (!deepSleepWake || deepSleepButtonWake || !smartBeaconActive) return true;
+        if (lastTxLat == 0.0 && lastTxLng == 0.0) return true;
+        if (HAL::now() - lastTxTime >= (uint32_t)Config.standingUpdateTime * 60 * 1000) return true;
+        return GEO_Utils::distanceBetween(gps.location.lat(), gps.location.lng(), lastTxLat, lastTxLng) >= currentSmartBeaconValues.minTxDist;
+    }
+
+    void checkDeepSleep() {
+        if (!Config.deepSleep.active) return;
+        uint32_t now        = HAL::now();
+        uint32_t fixBudget  = (uint32_t)Config.deepSleep.fixTimeout * 1000;
+
+        if (BOOT_Utils::getFirstBeaconTime() != 0) {
+            if (LoRa_Utils::isTxDone() || now >= fixBudget + DEEP_SLEEP_TX_MARGIN_MS) deepSleep();
+            return;
+        }
+        if (deepSleepFixTime == 0 && gps.location.isValid() && gps.location.age() < 2000) {
+            deepSleepFixTime = now;
+            if (!sendUpdate && !beaconDue()) {
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Sleep", "Fix after %u ms, no beacon due", (unsigned int)now);
+                deepSleep();
+            }
+            sendUpdate = true;
+        }
+        if (deepSleepFixTime == 0 && now >= fixBudget) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Sleep", "No fix within %d s", Config.deepSleep.fixTimeout);
+            deepSleep();
+        }
+        if (now >= fixBudget + DEEP_SLEEP_TX_MARGIN_MS) deepSleep();     // fix found but the beacon never went out
+        wakeBy(deepSleepFixTime == 0 ? fixBudget : fixBudget + DEEP_SLEEP_TX_MARGIN_MS);
+    }
+
+}
@@ -3,12 +3,32 @@
 
 #include <Arduino.h>
 
+#define LIGHT_SLEEP_MIN_MS      20          // shorter waits are left to POWER_Utils::idle()
+#define LIGHT_SLEEP_MAX_MS      5000        // checks that register no deadline still run this often
+#define LIGHT_SLEEP_HOLD_MS     500         // awake after a radio, GPS or button wake so the frame, burst or press is handled
+#define LIGHT_SLEEP_REPORT_MS   (5 * 60 * 1000)
+#define DEEP_SLEEP_MIN_S        10          // a wake that ran past the interval still rests this long
+#define DEEP_SLEEP_TX_MARGIN_MS 30000       // beyond the fix budget for the beacon to go out before sleep is forced
+
 namespace SLEEP_Utils {
 
     void gpsSleep();
     void gpsWakeUp();
     void checkIfGPSShouldSleep();
 
+    // Light sleep at the end of loop(). Time-based checks register the HAL::now() time they must run by on every
+    // pass; the sleeper waits for the earliest of them, the next GPS burst, the radio DIO interrupt or the button.
+    void        wakeBy(uint32_t deadline);
+    void        checkLightSleep();
+    uint8_t     getSleepShare();            // % of time since the first pass
+    uint32_t    getWakeCount();
+
+    // Beacon-only deep sleep (Config.deepSleep): each wake waits for a fix within the budget, sends one beacon if
+    // the smart beacon rules ask for it and sleeps again. Beacon state survives the sleep in RTC memory.
+    bool        restoreDeepSleepState();    // true on a wake from our own deep sleep, call before the rest of setup()
+    bool        isDeepSleepWake();
+    void        checkDeepSleep();
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,6 +1,8 @@
 #include "smartbeacon_utils.h"
 #include "configuration.h"
 #include "winlink_utils.h"
+#include "hal_utils.h"
+#include "sleep_utils.h"
 
 extern Configuration    Config;
 extern Beacon           *currentBeacon;
@@ -47,15 +49,16 @@ namespace SMARTBEACON_Utils {
 
     void checkFixedBeaconTime() {
         if (!smartBeaconActive) {
-            uint32_t lastTxSmartBeacon = millis() - lastTxTime;
+            uint32_t lastTxSmartBeacon = HAL::now() - lastTxTime;
             if (lastTxSmartBeacon >= Config.nonSmartBeaconRate * 60 * 1000) {
                 sendUpdate = true;
             }
+            SLEEP_Utils::wakeBy(lastTxTime + Config.nonSmartBeaconRate * 60 * 1000);
         }
     }
 
     void checkState() {
-        if (wxRequestStatus && (millis() - wxRequestTime) > 20000) {
+        if (wxRequestStatus && (HAL::now() - wxRequestTime) > 20000) {
             wxRequestStatus = false;
         }
         if(winlinkStatus == 0 && !wxRequestStatus) {
@@ -1,5 +1,4 @@
 #include <TinyGPS++.h>
-#include <SPIFFS.h>
 #include "APRSPacketLib.h"
 #include "station_utils.h"
 #include "battery_utils.h"
@@ -7,8 +6,14 @@
 #include "boards_pinout.h"
 #include "power_utils.h"
 #include "sleep_utils.h"
+#include "heap_utils.h"
+#include "hal_utils.h"
 #include "lora_utils.h"
+#include "perf_utils.h"
 #include "bme_utils.h"
+#include "comment_utils.h"
+#include "telemetry_utils.h"
+#include "boot_utils.h"
 #include "display.h"
 #include "logger.h"
 #include "ble_utils.h"
@@ -46,9 +51,8 @@ bool	    sendStandingUpdate      = false;
 uint8_t     updateCounter           = 100;
 
 
-bool        sendStartTelemetry      = true;
 uint32_t    lastTelemetryTx         = 0;
-uint32_t    telemetryTx             = millis();
+uint32_t    telemetryTx             = HAL::now();
 
 uint32_t    lastDeleteListenedTracker;
 
@@ -83,7 +87,7 @@ namespace STATION_Utils {
 
     void deleteListenedTrackersbyTime() {
         for (int a = 0; a < 4; a++) {                       // clean nearTrackers[] after time
-            if (nearTrackers[a].callsign != "" && (millis() - nearTrackers[a].lastTime > Config.rememberStationTime * 60 * 1000)) {
+            if (nearTrackers[a].callsign != "" && (HAL::now() - nearTrackers[a].lastTime > Config.rememberStationTime * 60 * 1000)) {
                 nearTrackers[a].callsign    = "";
                 nearTrackers[a].distance    = 0.0;
                 nearTrackers[a].course      = 0;
@@ -100,11 +104,11 @@ namespace STATION_Utils {
                 }
             }
         }
-        lastDeleteListenedTracker = millis();
+        lastDeleteListenedTracker = HAL::now();
     }
 
     void checkListenedTrackersByTimeAndDelete() {
-        if (millis() - lastDeleteListenedTracker > Config.rememberStationTime * 60 * 1000) {
+        if (HAL::now() - lastDeleteListenedTracker > Config.rememberStationTime * 60 * 1000) {
             deleteListenedTrackersbyTime();
         }
     }
@@ -116,7 +120,7 @@ namespace STATION_Utils {
         for (int a = 0; a < 4; a++) {                       // check if callsign is in nearTrackers[]
             if (nearTrackers[a].callsign == callsign) {
                 callsignInNearTrackers  = true;
-                nearTrackers[a].lastTime = millis();        // update listened millis()
+                nearTrackers[a].lastTime = HAL::now();        // update listened HAL::now()
                 if (nearTrackers[a].distance != distance) { // update distance if needed
                     nearTrackers[a].distance    = distance;
                     shouldSortbyDistance        = true;
@@ -132,7 +136,7 @@ namespace STATION_Utils {
                     nearTrackers[b].callsign    = callsign;
                     nearTrackers[b].distance    = distance;
                     nearTrackers[b].course      = int(course);
-                    nearTrackers[b].lastTime    = millis();
+                    nearTrackers[b].lastTime    = HAL::now();
                     break;
                 }
             }
@@ -146,7 +150,7 @@ namespace STATION_Utils {
                         nearTrackers[c].callsign    = callsign;
                         nearTrackers[c].distance    = distance;
                         nearTrackers[c].course      = int(course);
-                        nearTrackers[c].lastTime    = millis();
+                        nearTrackers[c].lastTime    = HAL::now();
                         break;
                     }
                 }
@@ -176,46 +180,19 @@ namespace STATION_Utils {
                 SLEEP_Utils::gpsWakeUp();
             }
         }
+        if (!sendUpdate) SLEEP_Utils::wakeBy(lastTxTime + Config.standingUpdateTime * 60 * 1000);
     }
 
     void sendBeacon(uint8_t type) {
-        if (sendStartTelemetry && Config.battery.sendVoltage && Config.battery.voltageAsTelemetry) {                
-            String sender = currentBeacon->callsign;
-            for (int i = sender.length(); i < 9; i++) {
-                sender += ' ';
-            }
-            String basePacket = currentBeacon->callsign;
-            basePacket += ">APLRT1";
-            if (Config.path != "") {
-                basePacket += ",";
-                basePacket += Config.path;
-            }
-            basePacket += "::";
-            basePacket += sender;
-            basePacket += ":";
-
-            String tempPacket = basePacket;
-            tempPacket += "EQNS.0,0.01,0";
-            LoRa_Utils::sendNewPacket(tempPacket);
-            delay(3000);
-
-            tempPacket = basePacket;
-            tempPacket += "UNIT.VDC";
-            LoRa_Utils::sendNewPacket(tempPacket);
-            delay(3000);
-
-            tempPacket = basePacket;
-            tempPacket += "PARM.V_Batt";
-            LoRa_Utils::sendNewPacket(tempPacket);
-            delay(3000);
-            sendStartTelemetry = false;
-        }
-
+        PERF_SCOPE(PERF_BEACON);
+        HEAP_TRACK(HEAP_PACKETLIB);
         String packet;
         if (Config.bme.sendTelemetry && wxModuleFound && type == 1) { // WX
             packet = APRSPacketLib::generateGPSBeaconPacket(currentBeacon->callsign, "APLRT1", Config.path, "/", APRSPacketLib::encodeGPS(gps.location.lat(),gps.location.lng(), gps.course.deg(), 0.0, currentBeacon->symbol, Config.sendAltitude, gps.altitude.feet(), sendStandingUpdate, "Wx"));
             if (wxModuleType != 0) {
-                packet += BME_Utils::readDataSensor(0);
+                char wx[64];
+                BME_Utils::writeDataSensor(wx, sizeof(wx), 0);
+                packet += wx;
             } else {
                 packet += ".../...g...t...";
             }            
@@ -265,11 +242,15 @@ namespace STATION_Utils {
                 comment += "%";
             #endif
         }
+        int commentStart = -1;
         if (comment != "" || (Config.battery.sendVoltage && Config.battery.voltageAsTelemetry)) {
             updateCounter++;
             if (updateCounter >= sendCommentAfterXBeacons) {
-                if (comment != "") packet += comment;
-                if (Config.battery.sendVoltage && Config.battery.voltageAsTelemetry) packet += BATTERY_Utils::generateEncodedTelemetry(batteryVoltage.toFloat());
+                if (comment != "") {
+                    commentStart = packet.length();
+                    packet += comment;
+                }
+                if (Config.battery.sendVoltage && Config.battery.voltageAsTelemetry) packet += TELEMETRY_Utils::generateEncodedTelemetry();
                 updateCounter = 0;
             }
         }
@@ -277,7 +258,9 @@ namespace STATION_Utils {
             cleanTFT();
         #endif
         displayShow("<<< TX >>>", "", packet,100);
-        LoRa_Utils::sendNewPacket(packet);
+        LoRa_Utils::sendNewPacket(COMMENT_Utils::compressComment(packet, commentStart, comment.length()));
+        TELEMETRY_Utils::beaconSent();
+        BOOT_Utils::firstBeacon();
         
         if (Config.bluetooth.type == 0 || Config.bluetooth.type == 2) {
             BLE_Utils::sendToPhone(packet);
@@ -289,7 +272,7 @@ namespace STATION_Utils {
             previousHeading = currentHeading;
             lastTxDistance  = 0.0;
         }
-        lastTxTime  = millis();
+        lastTxTime  = HAL::now();
         sendUpdate  = false;
         #ifdef HAS_TFT
             cleanTFT(); 
@@ -305,12 +288,12 @@ namespace STATION_Utils {
     }
 
     void checkTelemetryTx() {
-        if (Config.bme.active && Config.bme.sendTelemetry && sendStandingUpdate) {
-            lastTx = millis() - lastTxTime;
-            telemetryTx = millis() - lastTelemetryTx;
+        if (Config.bme.active && Config.bme.sendTelemetry && sendStandingUpdate && !TELEMETRY_Utils::carriesWeather()) {
+            lastTx = HAL::now() - lastTxTime;
+            telemetryTx = HAL::now() - lastTelemetryTx;
             if ((lastTelemetryTx == 0 || telemetryTx > 10 * 60 * 1000) && lastTx > 10 * 1000) {
                 sendBeacon(1);
-                lastTelemetryTx = millis();
+                lastTelemetryTx = HAL::now();
             }
         }
     }
@@ -322,19 +305,13 @@ namespace STATION_Utils {
         } else {
             filePath = "/freqIndex.txt";
         }
-        File fileIndex = SPIFFS.open(filePath, "w");
-        if(!fileIndex) {
-            return;
-        }
-        String dataToSave = String(index);
-        if (fileIndex.println(dataToSave)) {
+        if (HAL::writeLine(filePath, String(index))) {
             if (type == 0) {
                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "New Callsign Index saved to SPIFFS");
             } else {
                 logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "New Frequency Index saved to SPIFFS");
             }
-        } 
-        fileIndex.close();
+        }
     }
 
     void loadIndex(uint8_t type) {
@@ -344,21 +321,14 @@ namespace STATION_Utils {
         } else {
             filePath = "/freqIndex.txt";
         }
-        File fileIndex = SPIFFS.open(filePath);
-        if(!fileIndex) {
-            return;
+        String firstLine;
+        if (!HAL::readLine(filePath, firstLine)) return;
+        if (type == 0) {
+            myBeaconsIndex = firstLine.toInt();
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Callsign Index: %s", firstLine.c_str());
         } else {
-            while (fileIndex.available()) {
-                String firstLine = fileIndex.readStringUntil('\n');
-                if (type == 0) {
-                    myBeaconsIndex = firstLine.toInt();
-                    logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Callsign Index: %s", firstLine);
-                } else {
-                    loraIndex = firstLine.toInt();
-                    logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "LoRa", "LoRa Freq Index: %s", firstLine);
-                }
-            }
-            fileIndex.close();
+            loraIndex = firstLine.toInt();
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "LoRa", "LoRa Freq Index: %s", firstLine.c_str());
         }
     }
 
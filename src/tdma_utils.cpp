@@ -0,0 +1,90 @@
+#include <TinyGPS++.h>
+#include <logger.h>
+#include "configuration.h"
+#include "boards_pinout.h"
+#include "hal_utils.h"
+#include "tdma_utils.h"
+
+
+extern Configuration        Config;
+extern Beacon               *currentBeacon;
+extern TinyGPSPlus          gps;
+extern logging::Logger      logger;
+
+uint16_t            tdmaSlot                = 0;
+uint16_t            tdmaSlots               = 1;
+String              tdmaCallsign            = "";
+uint32_t            tdmaSyncMillis          = 0;
+uint32_t            tdmaSyncTime            = 0;        // ms of the UTC day at tdmaSyncMillis
+volatile uint32_t   tdmaPpsMillis           = 0;
+
+
+namespace TDMA_Utils {
+
+    #ifdef GPS_PPS
+    static void IRAM_ATTR ppsISR() {
+        tdmaPpsMillis = millis();
+    }
+    #endif
+
+    static void computeSlot() {
+        tdmaSlots = Config.tdma.frameLength / Config.tdma.slotLength;
+        if (tdmaSlots == 0) tdmaSlots = 1;
+        if (Config.tdma.slot >= 0) {
+            tdmaSlot = Config.tdma.slot % tdmaSlots;
+        } else {
+            uint32_t hash = 2166136261;             // FNV-1a
+            for (unsigned int i = 0; i < currentBeacon->callsign.length(); i++) {
+                hash ^= (uint8_t)currentBeacon->callsign[i];
+                hash *= 16777619;
+            }
+            tdmaSlot = hash % tdmaSlots;
+        }
+        tdmaCallsign = currentBeacon->callsign;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "TDMA", "%s owns slot %d of %d (%d s frame)", tdmaCallsign.c_str(), tdmaSlot, tdmaSlots, Config.tdma.frameLength);
+    }
+
+    void setup() {
+        if (!Config.tdma.active) return;
+        computeSlot();
+        #ifdef GPS_PPS
+            pinMode(GPS_PPS, INPUT);
+            attachInterrupt(digitalPinToInterrupt(GPS_PPS), ppsISR, RISING);
+        #endif
+    }
+
+    void syncTime() {
+        if (!Config.tdma.active || !gps.time.isValid()) return;
+        // NMEA time stamps the second edge, the sentence itself arrives a few hundred ms later. With PPS wired
+        // the edge was caught by the interrupt, otherwise the sentence arrival is the best reference there is
+        uint32_t now        = HAL::now();
+        uint32_t reference  = now;
+        uint32_t ppsMillis  = tdmaPpsMillis;
+        if (ppsMillis != 0 && now - ppsMillis < 1000) reference = ppsMillis;
+        tdmaSyncTime    = ((uint32_t)gps.time.hour() * 3600 + gps.time.minute() * 60 + gps.time.second()) * 1000 + gps.time.centisecond() * 10;
+        tdmaSyncMillis  = reference;
+    }
+
+    bool isSynced() {
+        return tdmaSyncMillis != 0 && HAL::now() - tdmaSyncMillis < (uint32_t)TDMA_SYNC_TIMEOUT * 1000;
+    }
+
+    bool isMySlot() {
+        if (!Config.tdma.active || !isSynced()) return true;       // without GPS time every moment is ours
+        if (tdmaCallsign != currentBeacon->callsign) computeSlot();
+
+        uint32_t frameMs    = (uint32_t)Config.tdma.frameLength * 1000;
+        uint32_t now        = (tdmaSyncTime + (HAL::now() - tdmaSyncMillis)) % frameMs;
+        uint32_t slotStart  = (uint32_t)tdmaSlot * Config.tdma.slotLength * 1000;
+        return (now + frameMs - slotStart) % frameMs < TDMA_TX_WINDOW;
+    }
+
+    uint16_t getSlot() {
+        return tdmaSlot;
+    }
+
+    uint16_t getSlots() {
+        return tdmaSlots;
+    }
+
+}
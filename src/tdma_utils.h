@@ -0,0 +1,21 @@
+#ifndef TDMA_UTILS_H_
+#define TDMA_UTILS_H_
+
+#include <Arduino.h>
+
+#define TDMA_TX_WINDOW          500     // ms after the slot start a beacon may still begin
+#define TDMA_SYNC_TIMEOUT       1800    // seconds the millis() clock is trusted after the last GPS time
+
+
+namespace TDMA_Utils {
+
+    void        setup();
+    void        syncTime();
+    bool        isSynced();
+    bool        isMySlot();
+    uint16_t    getSlot();
+    uint16_t    getSlots();
+
+}
+
+#endif
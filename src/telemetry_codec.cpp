@@ -0,0 +1,226 @@
+#include <math.h>
+#include <string.h>
+#include "telemetry_codec.h"
+
+struct TelemetryDefinition {
+    const char* name;           // PARM
+    const char* unit;           // UNIT
+    const char* equation;       // EQNS a,b,c: value = a * x^2 + b * x + c
+    float       step;           // b and c of the equation, for the encoder
+    float       base;
+    bool        counter;
+};
+
+// One table for every channel the tracker reports, indexed by TelemetryChannel. The encoder and the definition
+// frames both walk a slot layout over it, so the order on air always matches what PARM/UNIT/EQNS announce.
+const TelemetryDefinition telemetryDefinitions[TELEMETRY_CHANNELS] = {
+    { "V_Batt", "VDC",  "0,0.01,0",    0.01,   0,      false },
+    { "I_Batt", "mA",   "0,1,-2000",   1,      -2000,  false },
+    { "Temp",   "C",    "0,0.1,-50",   0.1,    -50,    false },
+    { "Pres",   "hPa",  "0,0.1,500",   0.1,    500,    false },
+    { "Hum",    "%",    "0,0.1,0",     0.1,    0,      false },
+    { "Rx",     "pkt",  "0,1,0",       1,      0,      true  },
+    { "Heap",   "kB",   "0,0.1,0",     0.1,    0,      false }
+};
+const char  *telemetryBitNames[TELEMETRY_BITS]  = {"Chg"};
+const char  *telemetryBitUnits[TELEMETRY_BITS]  = {"on"};
+
+#define TELEMETRY_NO_CHANNEL    0xFF
+#define TELEMETRY_WEATHER       ((1 << TELEMETRY_TEMPERATURE) | (1 << TELEMETRY_PRESSURE) | (1 << TELEMETRY_HUMIDITY))
+
+float       telemetryValues[TELEMETRY_CHANNELS];
+uint16_t    telemetryPublished      = 0;        // bit per channel
+uint8_t     telemetryBits           = 0;
+uint8_t     telemetryBitsPublished  = 0;
+uint8_t     announcedSlots[TELEMETRY_MAX_ANALOG]    = {TELEMETRY_NO_CHANNEL, TELEMETRY_NO_CHANNEL, TELEMETRY_NO_CHANNEL, TELEMETRY_NO_CHANNEL, TELEMETRY_NO_CHANNEL};
+uint8_t     announcedBits           = 0;        // what the definition frames describe
+uint8_t     frameSlots[TELEMETRY_MAX_ANALOG]        = {TELEMETRY_NO_CHANNEL, TELEMETRY_NO_CHANNEL, TELEMETRY_NO_CHANNEL, TELEMETRY_NO_CHANNEL, TELEMETRY_NO_CHANNEL};
+uint8_t     frameBits               = 0;        // what the frames carry, the announced layout once its definitions are out
+uint8_t     definitionsPending      = TELEMETRY_DEFINITION_ALL;
+
+
+namespace TELEMETRY_Utils {
+
+    static int clampValue(int value) {
+        return value < 0 ? 0 : (value > TELEMETRY_MAX_VALUE ? TELEMETRY_MAX_VALUE : value);
+    }
+
+    static void appendBase91(char* telemetry, size_t& length, int value) {
+        value = clampValue(value);
+        telemetry[length++] = value / 91 + 33;
+        telemetry[length++] = value % 91 + 33;
+    }
+
+    static bool append(char* text, size_t size, size_t& length, const char* value) {
+        size_t valueLength = strlen(value);
+        if (length + valueLength > size) return false;
+        memcpy(text + length, value, valueLength);
+        length += valueLength;
+        return true;
+    }
+
+    size_t encode(uint16_t sequence, const uint16_t* analog, uint8_t analogCount, int digital, char* telemetry, size_t size) {
+        if (analogCount == 0 || analogCount > TELEMETRY_MAX_ANALOG || digital > 255) return 0;
+        uint8_t pairs = 1 + (digital >= 0 ? TELEMETRY_MAX_ANALOG + 1 : analogCount);
+        if (size < 2 + 2 * (size_t)pairs) return 0;
+
+        size_t length = 0;
+        telemetry[length++] = '|';
+        appendBase91(telemetry, length, sequence);
+        for (uint8_t i = 0; i < TELEMETRY_MAX_ANALOG; i++) {
+            if (i < analogCount) {
+                appendBase91(telemetry, length, analog[i]);
+            } else if (digital >= 0) {
+                appendBase91(telemetry, length, 0);
+            }
+        }
+        if (digital >= 0) appendBase91(telemetry, length, digital);
+        telemetry[length++] = '|';
+        return length;
+    }
+
+    void publish(uint8_t channel, float value) {
+        if (channel >= TELEMETRY_CHANNELS || isnan(value)) return;
+        telemetryValues[channel]    = value;
+        telemetryPublished          |= 1 << channel;
+    }
+
+    void count(uint8_t channel) {
+        if (channel >= TELEMETRY_CHANNELS) return;
+        if (!(telemetryPublished & (1 << channel))) telemetryValues[channel] = 0;
+        telemetryValues[channel]++;
+        telemetryPublished |= 1 << channel;
+    }
+
+    void publishBit(uint8_t bit, bool value) {
+        if (bit >= TELEMETRY_BITS) return;
+        if (value) {
+            telemetryBits |= 1 << bit;
+        } else {
+            telemetryBits &= ~(1 << bit);
+        }
+        telemetryBitsPublished |= 1 << bit;
+    }
+
+    void reset() {
+        telemetryPublished      = 0;
+        telemetryBits           = 0;
+        telemetryBitsPublished  = 0;
+        announcedBits           = 0;
+        frameBits               = 0;
+        memset(announcedSlots, TELEMETRY_NO_CHANNEL, sizeof(announcedSlots));
+        memset(frameSlots, TELEMETRY_NO_CHANNEL, sizeof(frameSlots));
+        definitionsPending      = TELEMETRY_DEFINITION_ALL;
+    }
+
+    static uint16_t slotChannels(const uint8_t* slots) {
+        uint16_t channels = 0;
+        for (uint8_t i = 0; i < TELEMETRY_MAX_ANALOG; i++) {
+            if (slots[i] != TELEMETRY_NO_CHANNEL) channels |= 1 << slots[i];
+        }
+        return channels;
+    }
+
+    // Published channels take a free slot, or the slot of the lowest priority channel after them. True if the layout changed.
+    static bool updateLayout() {
+        bool changed = false;
+        for (uint8_t channel = 0; channel < TELEMETRY_CHANNELS; channel++) {
+            if (!(telemetryPublished & (1 << channel)) || (slotChannels(announcedSlots) & (1 << channel))) continue;
+            int slot = -1;
+            for (uint8_t i = 0; i < TELEMETRY_MAX_ANALOG; i++) {
+                if (announcedSlots[i] == TELEMETRY_NO_CHANNEL) {
+                    slot = i;
+                    break;
+                }
+                if (announcedSlots[i] > channel && (slot == -1 || announcedSlots[i] > announcedSlots[slot])) slot = i;
+            }
+            if (slot == -1) continue;
+            announcedSlots[slot]    = channel;
+            changed                 = true;
+        }
+        if (telemetryBitsPublished != announcedBits) {
+            announcedBits   = telemetryBitsPublished;
+            changed         = true;
+        }
+        return changed;
+    }
+
+    static void adoptLayout() {
+        memcpy(frameSlots, announcedSlots, sizeof(frameSlots));
+        frameBits = announcedBits;
+    }
+
+    size_t encodeFrame(int& sequence, char* telemetry, size_t size) {
+        if (updateLayout()) {
+            announceDefinitions();
+            if (slotChannels(frameSlots) == 0) adoptLayout();      // nothing described on air yet, nothing to hold
+        }
+
+        uint16_t    analog[TELEMETRY_MAX_ANALOG];
+        uint8_t     analogCount = 0;
+        for (uint8_t i = 0; i < TELEMETRY_MAX_ANALOG && frameSlots[i] != TELEMETRY_NO_CHANNEL; i++) {
+            uint8_t channel = frameSlots[i];
+            const TelemetryDefinition& row = telemetryDefinitions[channel];
+            analog[analogCount++] = clampValue((int)((telemetryValues[channel] - row.base) / row.step + 0.5));
+            if (row.counter) telemetryValues[channel] = 0;
+        }
+
+        size_t length = encode(sequence, analog, analogCount, frameBits ? telemetryBits : -1, telemetry, size);
+        sequence++;
+        if (sequence >= TELEMETRY_SEQUENCE_WRAP) {
+            sequence = 0;
+        }
+        return length;
+    }
+
+    bool framesCarryWeather() {
+        uint16_t weather = telemetryPublished & TELEMETRY_WEATHER;
+        return weather != 0 && (slotChannels(frameSlots) & weather) == weather;
+    }
+
+    bool hasDefinitions() {
+        return slotChannels(announcedSlots) != 0;
+    }
+
+    void announceDefinitions() {
+        definitionsPending = TELEMETRY_DEFINITION_ALL;
+    }
+
+    uint8_t nextDefinition() {
+        if (!announcedBits) definitionsPending &= ~TELEMETRY_DEFINITION_BITS;
+        return definitionsPending & -definitionsPending;
+    }
+
+    size_t definitionText(uint8_t definition, char* text, size_t size) {
+        size_t length = 0;
+        if (definition == TELEMETRY_DEFINITION_BITS) {
+            return append(text, size, length, "BITS.11111111,LoRa APRS Tracker") ? length : 0;
+        }
+        if (!append(text, size, length, (definition == TELEMETRY_DEFINITION_PARM) ? "PARM." : (definition == TELEMETRY_DEFINITION_UNIT) ? "UNIT." : "EQNS.")) return 0;
+
+        uint8_t fields = 0;
+        for (; fields < TELEMETRY_MAX_ANALOG && announcedSlots[fields] != TELEMETRY_NO_CHANNEL; fields++) {
+            if (fields > 0 && !append(text, size, length, ",")) return 0;
+            const TelemetryDefinition& row = telemetryDefinitions[announcedSlots[fields]];
+            if (!append(text, size, length, (definition == TELEMETRY_DEFINITION_PARM) ? row.name : (definition == TELEMETRY_DEFINITION_UNIT) ? row.unit : row.equation)) return 0;
+        }
+        if (definition != TELEMETRY_DEFINITION_EQNS && announcedBits) {     // bit labels follow all five analog fields
+            for (; fields < TELEMETRY_MAX_ANALOG; fields++) {
+                if (!append(text, size, length, ",")) return 0;
+            }
+            for (uint8_t bit = 0; bit < TELEMETRY_BITS && (announcedBits >> bit); bit++) {
+                if (!append(text, size, length, ",")) return 0;
+                if ((announcedBits & (1 << bit)) && !append(text, size, length, (definition == TELEMETRY_DEFINITION_PARM) ? telemetryBitNames[bit] : telemetryBitUnits[bit])) return 0;
+            }
+        }
+        return length;
+    }
+
+    bool definitionSent(uint8_t definition) {
+        definitionsPending &= ~definition;
+        if (definitionsPending != 0) return false;
+        adoptLayout();
+        return true;
+    }
+
+}
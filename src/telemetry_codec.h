@@ -0,0 +1,66 @@
+#ifndef TELEMETRY_CODEC_H_
+#define TELEMETRY_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Channel registry, slot layout and base91 encoder of the comment telemetry. Nothing here touches the Arduino core
+// or the radio, so the native env tests it on the host; telemetry_utils.h sends what it produces.
+
+#define TELEMETRY_MAX_ANALOG            5                       // analog pairs of the |ss1122334455dd| extension
+#define TELEMETRY_MAX_LENGTH            16                      // bars, sequence, five analog pairs and the digital pair
+#define TELEMETRY_MAX_VALUE             (91 * 91 - 1)
+#define TELEMETRY_SEQUENCE_WRAP         1000
+
+#define TELEMETRY_DEFINITION_PARM       0x01
+#define TELEMETRY_DEFINITION_UNIT       0x02
+#define TELEMETRY_DEFINITION_EQNS       0x04
+#define TELEMETRY_DEFINITION_BITS       0x08
+#define TELEMETRY_DEFINITION_ALL        0x0F
+
+// Channel registry, in priority order. A published channel keeps the slot it got in the frame; when all
+// TELEMETRY_MAX_ANALOG slots are taken it displaces the lowest priority channel after it, if any.
+enum TelemetryChannel {
+    TELEMETRY_BATTERY,
+    TELEMETRY_CURRENT,
+    TELEMETRY_TEMPERATURE,
+    TELEMETRY_PRESSURE,
+    TELEMETRY_HUMIDITY,
+    TELEMETRY_RX_PACKETS,
+    TELEMETRY_HEAP,
+    TELEMETRY_CHANNELS
+};
+
+enum TelemetryBit {
+    TELEMETRY_BIT_CHARGING,
+    TELEMETRY_BITS
+};
+
+
+namespace TELEMETRY_Utils {
+
+    // Base91 comment telemetry as specified: sequence and analog values 0..8280 as two characters each, the
+    // digital byte as a sixth pair when digital >= 0, with missing analog channels sent as 0. 0 if it does not fit.
+    size_t  encode(uint16_t sequence, const uint16_t* analog, uint8_t analogCount, int digital, char* telemetry, size_t size);
+
+    void    publish(uint8_t channel, float value);      // latest value, in the unit of the channel definition
+    void    count(uint8_t channel);                     // counter channels, back to 0 once a frame carried them
+    void    publishBit(uint8_t bit, bool value);
+    void    reset();                                    // no channel published, nothing announced
+
+    // The frame for the next beacon, sequence is advanced and wraps at TELEMETRY_SEQUENCE_WRAP. A new layout is
+    // only used once all of its definitions have been sent, until then frames keep the previous one.
+    size_t  encodeFrame(int& sequence, char* telemetry, size_t size);
+    bool    framesCarryWeather();                       // every published BME channel has a slot in the frames
+
+    // Definition frames: the lowest pending one (0 when none), its message text ("PARM.V_Batt,..."), and marking
+    // it sent, which returns true once all are out and the frames switch to the announced layout.
+    bool    hasDefinitions();
+    void    announceDefinitions();
+    uint8_t nextDefinition();
+    size_t  definitionText(uint8_t definition, char* text, size_t size);
+    bool    definitionSent(uint8_t definition);
+
+}
+
+#endif
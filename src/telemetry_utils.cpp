@@ -0,0 +1,78 @@
+#include <logger.h>
+#include "telemetry_utils.h"
+#include "configuration.h"
+#include "lora_utils.h"
+#include "hal_utils.h"
+#include "sleep_utils.h"
+
+extern Configuration    Config;
+extern Beacon           *currentBeacon;
+extern logging::Logger  logger;
+extern uint32_t         lastTxTime;
+
+int         telemetrySequence       = random(1,999);
+bool        definitionAllowed       = false;
+uint32_t    definitionsTime         = 0;
+
+
+namespace TELEMETRY_Utils {
+
+    String generateEncodedTelemetry() {
+        char    telemetry[TELEMETRY_MAX_LENGTH];
+        size_t  length = encodeFrame(telemetrySequence, telemetry, sizeof(telemetry));
+        String encoded;
+        encoded.concat(telemetry, length);
+        return encoded;
+    }
+
+    bool carriesWeather() {
+        return Config.battery.sendVoltage && Config.battery.voltageAsTelemetry && framesCarryWeather();
+    }
+
+    static String generateDefinition(uint8_t definition) {
+        String sender = currentBeacon->callsign;
+        for (int i = sender.length(); i < 9; i++) {
+            sender += ' ';
+        }
+        String packet = currentBeacon->callsign;
+        packet += ">APLRT1";
+        if (Config.path != "") {
+            packet += ",";
+            packet += Config.path;
+        }
+        packet += "::";
+        packet += sender;
+        packet += ":";
+        char    text[80];
+        size_t  length = definitionText(definition, text, sizeof(text));
+        packet.concat(text, length);
+        return packet;
+    }
+
+    void beaconSent() {
+        definitionAllowed = true;
+    }
+
+    void checkDefinitions() {
+        if (!Config.battery.sendVoltage || !Config.battery.voltageAsTelemetry || !hasDefinitions()) return;
+        if (nextDefinition() == 0) {
+            if (HAL::now() - definitionsTime < TELEMETRY_DEFINITION_PERIOD) {
+                SLEEP_Utils::wakeBy(definitionsTime + TELEMETRY_DEFINITION_PERIOD);
+                return;
+            }
+            announceDefinitions();
+        }
+        // Lowest priority: after a beacon, never next to one and never ahead of frames already queued
+        if (definitionAllowed) SLEEP_Utils::wakeBy(lastTxTime + TELEMETRY_DEFINITION_GAP);
+        if (!definitionAllowed || HAL::now() - lastTxTime < TELEMETRY_DEFINITION_GAP || !LoRa_Utils::isTxIdle()) return;
+
+        uint8_t definition = nextDefinition();
+        LoRa_Utils::sendNewPacket(generateDefinition(definition));
+        definitionAllowed = false;
+        if (definitionSent(definition)) {
+            definitionsTime = HAL::now();
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Telemetry", "Definitions announced");
+        }
+    }
+
+}
@@ -0,0 +1,23 @@
+#ifndef TELEMETRY_UTILS_H_
+#define TELEMETRY_UTILS_H_
+
+#include <Arduino.h>
+#include "telemetry_codec.h"
+
+#define TELEMETRY_DEFINITION_PERIOD     (4 * 60 * 60 * 1000)    // ms between announcements of PARM/UNIT/EQNS
+#define TELEMETRY_DEFINITION_GAP        (30 * 1000)             // ms of quiet after our last beacon before a definition goes out
+
+
+namespace TELEMETRY_Utils {
+
+    String  generateEncodedTelemetry();
+    bool    carriesWeather();                           // every BME channel rides in the telemetry, no separate WX beacon needed
+
+    // Definition frames go out one per beacon, when the Tx queue is idle, again every TELEMETRY_DEFINITION_PERIOD
+    // and whenever the slot layout changes. Frames keep the previous layout until the new one is fully announced.
+    void    beaconSent();
+    void    checkDefinitions();
+
+}
+
+#endif
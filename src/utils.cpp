@@ -1,6 +1,9 @@
+#include <logger.h>
 #include "APRSPacketLib.h"
 #include "configuration.h"
 #include "lora_utils.h"
+#include "hal_utils.h"
+#include "sleep_utils.h"
 #include "display.h"
 #include "utils.h"
 
@@ -18,42 +21,20 @@ extern String               versionDate;
 extern bool                 flashlight;
 
 extern bool                 statusState;
+extern logging::Logger      logger;
 
-uint32_t    statusTime              = millis();
+uint32_t    statusTime              = HAL::now();
+
+const uint32_t  loopLatencyLimits[LOOP_LATENCY_BUCKETS - 1] = {1, 2, 5, 10, 20, 50, 100, 500, 1000};   // ms
+uint32_t    loopLatencyHistogram[LOOP_LATENCY_BUCKETS];
+uint32_t    loopLatencyLast[LOOP_LATENCY_BUCKETS];     // the previous report window, for the diagnostics screen
+uint32_t    loopLatencyMax          = 0;
+uint32_t    loopLatencyLastMax      = 0;
+uint32_t    lastLoopTime            = 0;
+uint32_t    loopLatencyLogTime      = 0;
 
 namespace Utils {
   
-    static char locator[11];    // letterize and getMaidenheadLocator functions are Copyright (c) 2021 Mateusz Salwach - MIT License
-
-    static char letterize(int x) {
-        return (char) x + 65;
-    }
-
-    char *getMaidenheadLocator(double lat, double lon, uint8_t size) {
-        double LON_F[]={20,2.0,0.083333,0.008333,0.0003472083333333333};
-        double LAT_F[]={10,1.0,0.0416665,0.004166,0.0001735833333333333};
-        int i;
-        lon += 180;
-        lat += 90;
-
-        if (size <= 0 || size > 10) size = 6;
-        size/=2; size*=2;
-
-        for (i = 0; i < size/2; i++) {
-            if (i % 2 == 1) {
-                locator[i*2] = (char) (lon/LON_F[i] + '0');
-                locator[i*2+1] = (char) (lat/LAT_F[i] + '0');
-            } else {
-                locator[i*2] = letterize((int) (lon/LON_F[i]));
-                locator[i*2+1] = letterize((int) (lat/LAT_F[i]));
-            }
-            lon = fmod(lon, LON_F[i]);
-            lat = fmod(lat, LAT_F[i]);
-        }
-        locator[i*2]=0;
-        return locator;
-    }
-
     static String padding(unsigned int number, unsigned int width) {
         String result;
         String num(number);
@@ -85,12 +66,12 @@ namespace Utils {
 
     void checkStatus() {
         if (statusState) {
-            lastTx = millis() - lastTxTime;
-            uint32_t statusTx = millis() - statusTime;
+            lastTx = HAL::now() - lastTxTime;
+            uint32_t statusTx = HAL::now() - statusTime;
             if (statusTx > 10 * 60 * 1000 && lastTx > 10 * 1000) {
                 LoRa_Utils::sendNewPacket(APRSPacketLib::generateStatusPacket(currentBeacon->callsign, "APLRT1", Config.path, "https://github.com/richonguzman/LoRa_APRS_Tracker " + versionDate));
                 statusState = false;
-                lastTxTime = millis();
+                lastTxTime = HAL::now();
             }
         }
     }
@@ -101,6 +82,7 @@ namespace Utils {
             displayToggle(false);
             displayState = false;
         }
+        if (displayEcoMode && displayState) SLEEP_Utils::wakeBy(displayTime + Config.display.timeout * 1000);
     }
 
     String getSmartBeaconState() {
@@ -115,5 +97,53 @@ namespace Utils {
             digitalWrite(Config.notification.ledFlashlightPin, LOW);
         }       
     }
+
+    void checkLoopLatency() {
+        uint32_t now = micros();
+        if (lastLoopTime != 0) {
+            uint32_t latency = (now - lastLoopTime) / 1000;
+            int bucket = 0;
+            while (bucket < LOOP_LATENCY_BUCKETS - 1 && latency >= loopLatencyLimits[bucket]) {
+                bucket++;
+            }
+            loopLatencyHistogram[bucket]++;
+            if (latency > loopLatencyMax) loopLatencyMax = latency;
+        }
+        lastLoopTime = now;
+
+        if (millis() - loopLatencyLogTime >= LOOP_LATENCY_REPORT_MS) {
+            char    histogram[LOOP_LATENCY_BUCKETS * 20];
+            size_t  length = 0;
+            for (int i = 0; i < LOOP_LATENCY_BUCKETS; i++) {
+                length += snprintf(histogram + length, sizeof(histogram) - length, "%s%u:%u ", (i < LOOP_LATENCY_BUCKETS - 1) ? "<" : ">=",
+                                    (unsigned int)loopLatencyLimits[(i < LOOP_LATENCY_BUCKETS - 1) ? i : i - 1], (unsigned int)loopLatencyHistogram[i]);
+                loopLatencyLast[i]      = loopLatencyHistogram[i];
+                loopLatencyHistogram[i] = 0;
+            }
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Loop", "Latency ms %smax:%u", histogram, (unsigned int)loopLatencyMax);
+            loopLatencyLastMax  = loopLatencyMax;
+            loopLatencyMax      = 0;
+            loopLatencyLogTime  = millis();
+        }
+    }
+
+    uint8_t getLoopLatencyShare(uint32_t limit) {
+        const uint32_t* histogram = loopLatencyLogTime != 0 ? loopLatencyLast : loopLatencyHistogram;     // last full window once there is one
+        uint32_t passes = 0;
+        uint32_t faster = 0;
+        for (int i = 0; i < LOOP_LATENCY_BUCKETS; i++) {
+            passes += histogram[i];
+            if (i < LOOP_LATENCY_BUCKETS - 1 && loopLatencyLimits[i] <= limit) faster += histogram[i];
+        }
+        return passes > 0 ? (uint8_t)(100ULL * faster / passes) : 0;
+    }
+
+    uint32_t getLoopLatencyMax() {
+        return loopLatencyLogTime != 0 ? loopLatencyLastMax : loopLatencyMax;
+    }
+
+    void skipLoopLatency(uint32_t us) {
+        if (lastLoopTime != 0) lastLoopTime += us;
+    }
   
 }
\ No newline at end of file
@@ -4,15 +4,21 @@
 #include <Arduino.h>
 #include <TimeLib.h>
 
+#define LOOP_LATENCY_BUCKETS    10
+#define LOOP_LATENCY_REPORT_MS  (5 * 60 * 1000)
+
 namespace Utils {
 
-    char    *getMaidenheadLocator(double lat, double lon, uint8_t size);
     String  createDateString(time_t t);
     String  createTimeString(time_t t);
     void    checkStatus();
     void    checkDisplayEcoMode();
     String  getSmartBeaconState();
     void    checkFlashlight();
+    void    checkLoopLatency();
+    uint8_t     getLoopLatencyShare(uint32_t limit);    // % of loop passes shorter than limit ms, limit one of the bucket bounds
+    uint32_t    getLoopLatencyMax();
+    void        skipLoopLatency(uint32_t us);           // time the loop spent asleep on purpose, not a stall
 
 }
 
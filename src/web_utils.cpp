@@ -1,5 +1,6 @@
 #include <ArduinoJson.h>
 #include "configuration.h"
+#include "heap_utils.h"
 #include "web_utils.h"
 #include "display.h"
 #include "utils.h"
@@ -59,6 +60,7 @@ namespace WEB_Utils {
     }
 
     void handleReadConfiguration(AsyncWebServerRequest *request) {
+        HEAP_TRACK(HEAP_WEB);
 
         File file = SPIFFS.open("/tracker_conf.json");
         
@@ -81,6 +83,7 @@ namespace WEB_Utils {
     }
 
     void handleWriteConfiguration(AsyncWebServerRequest *request) {
+        HEAP_TRACK(HEAP_WEB);
         Serial.println("Got new config from www");
 
         //  Beacons
@@ -0,0 +1,125 @@
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+// Just enough of the Arduino core for the hardware independent modules to build on a host. ARDUINO stays
+// undefined, so hal_utils.h switches to its virtual clock.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+typedef uint8_t byte;
+
+using std::min;
+using std::max;
+
+#define constrain(amount, low, high)    ((amount) < (low) ? (low) : ((amount) > (high) ? (high) : (amount)))
+
+inline bool isDigit(char c) { return isdigit((uint8_t)c); }
+inline bool isAlpha(char c) { return isalpha((uint8_t)c); }
+inline bool isAlphaNumeric(char c) { return isalnum((uint8_t)c); }
+inline bool isUpperCase(char c) { return isupper((uint8_t)c); }
+
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const char* text, unsigned int length) : value(text, length) {}
+    String(const std::string& text) : value(text) {}
+    String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+    String(double number, unsigned int decimals = 2) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, number);
+        value = buffer;
+    }
+
+    unsigned int length() const { return value.length(); }
+    bool isEmpty() const { return value.empty(); }
+    const char* c_str() const { return value.c_str(); }
+    void reserve(unsigned int size) { value.reserve(size); }
+
+    char charAt(unsigned int index) const { return index < value.length() ? value[index] : 0; }
+    void setCharAt(unsigned int index, char c) { if (index < value.length()) value[index] = c; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return value[index]; }
+
+    int indexOf(char c, unsigned int from = 0) const { return found(value.find(c, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const { return found(value.find(text.value, from)); }
+    int lastIndexOf(char c) const { return found(value.rfind(c)); }
+    int lastIndexOf(const String& text) const { return found(value.rfind(text.value)); }
+
+    String substring(unsigned int start) const { return substring(start, value.length()); }
+    String substring(unsigned int start, unsigned int end) const {
+        if (end > value.length()) end = value.length();
+        if (start > end) start = end;
+        return String(value.substr(start, end - start));
+    }
+
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.length(), prefix.value) == 0; }
+    bool startsWith(const String& prefix, unsigned int offset) const {
+        return offset <= value.length() && value.compare(offset, prefix.value.length(), prefix.value) == 0;
+    }
+    bool endsWith(const String& suffix) const {
+        return value.length() >= suffix.value.length() && value.compare(value.length() - suffix.value.length(), suffix.value.length(), suffix.value) == 0;
+    }
+    bool equals(const String& other) const { return value == other.value; }
+
+    bool concat(const String& text) { value += text.value; return true; }
+    bool concat(const char* text, unsigned int length) { value.append(text, length); return true; }
+    bool concat(const uint8_t* data, unsigned int length) { value.append((const char*)data, length); return true; }
+    bool concat(char c) { value += c; return true; }
+
+    String& operator+=(const String& text) { value += text.value; return *this; }
+    String& operator+=(const char* text) { value += text; return *this; }
+    String& operator+=(char c) { value += c; return *this; }
+    String& operator+=(int number) { value += std::to_string(number); return *this; }
+    String& operator+=(unsigned int number) { value += std::to_string(number); return *this; }
+    String& operator+=(long number) { value += std::to_string(number); return *this; }
+    String& operator+=(unsigned long number) { value += std::to_string(number); return *this; }
+
+    void toUpperCase() { for (char& c : value) c = toupper((uint8_t)c); }
+    void toLowerCase() { for (char& c : value) c = tolower((uint8_t)c); }
+    void trim() {
+        size_t start = value.find_first_not_of(" \t\r\n");
+        size_t end = value.find_last_not_of(" \t\r\n");
+        value = (start == std::string::npos) ? "" : value.substr(start, end - start + 1);
+    }
+    void replace(const String& from, const String& to) {
+        if (from.value.empty()) return;
+        for (size_t position = 0; (position = value.find(from.value, position)) != std::string::npos; position += to.value.length()) {
+            value.replace(position, from.value.length(), to.value);
+        }
+    }
+    void remove(unsigned int index) { if (index < value.length()) value.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < value.length()) value.erase(index, count); }
+
+    long toInt() const { return atol(value.c_str()); }
+    float toFloat() const { return atof(value.c_str()); }
+    double toDouble() const { return atof(value.c_str()); }
+
+    friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+    friend String operator+(const String& a, const char* b) { return String(a.value + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.value); }
+    friend String operator+(const String& a, char b) { return String(a.value + b); }
+    friend bool operator==(const String& a, const String& b) { return a.value == b.value; }
+    friend bool operator==(const String& a, const char* b) { return a.value == b; }
+    friend bool operator!=(const String& a, const String& b) { return a.value != b.value; }
+    friend bool operator!=(const String& a, const char* b) { return a.value != b; }
+    friend bool operator<(const String& a, const String& b) { return a.value < b.value; }
+
+private:
+    std::string value;
+
+    static int found(size_t position) { return position == std::string::npos ? -1 : (int)position; }
+};
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HOST_FS_H_
+#define HOST_FS_H_
+
+// configuration.h includes the Arduino file system header, nothing in it is used on the host
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef HOST_LOGGER_H_
+#define HOST_LOGGER_H_
+
+#include <stdio.h>
+
+// esp-logger on the host: only warnings and errors are printed, so test output stays readable
+
+namespace logging {
+
+    enum class LoggerLevel {
+        LOGGER_LEVEL_DEBUG,
+        LOGGER_LEVEL_INFO,
+        LOGGER_LEVEL_WARN,
+        LOGGER_LEVEL_ERROR
+    };
+
+    class Logger {
+    public:
+        template <typename... Arguments>
+        void log(LoggerLevel level, const char* module, const char* format, Arguments... arguments) {
+            if (level < LoggerLevel::LOGGER_LEVEL_WARN) return;
+            printf("[%s] ", module);
+            printf(format, arguments...);
+            printf("\n");
+        }
+
+        void log(LoggerLevel level, const char* module, const char* text) {
+            if (level < LoggerLevel::LOGGER_LEVEL_WARN) return;
+            printf("[%s] %s\n", module, text);
+        }
+    };
+
+}
+
+#endif
@@ -1,3 +1,4 @@
+// Reference copy of lib/KISS_TO_TNC2 from before AX25_Utils replaced it, only built by test_ax25
 // http://en.wikipedia.org/wiki/KISS_(TNC)#Special_Characters
 // http://k4kpk.com/notes-on-aprs-kiss-and-setting-up-a-tnc-x-igate-and-digipeater
 
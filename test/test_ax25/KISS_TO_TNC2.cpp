@@ -1,3 +1,4 @@
+// Reference copy of lib/KISS_TO_TNC2 from before AX25_Utils replaced it, only built by test_ax25
 #include "KISS_TO_TNC2.h"
 
 String encode_address_ax25(String tnc2Address);
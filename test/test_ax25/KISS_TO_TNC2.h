@@ -1,3 +1,4 @@
+// Reference copy of lib/KISS_TO_TNC2 from before AX25_Utils replaced it, only built by test_ax25
 #include <Arduino.h>
 #include "KISS.h"
 
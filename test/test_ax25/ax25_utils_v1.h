@@ -0,0 +1,14 @@
+// Reference copy of the String based src/ax25_utils from before the buffer codec, only built by test_ax25
+#ifndef AX25_UTILS_V1_H_
+#define AX25_UTILS_V1_H_
+
+#include <Arduino.h>
+
+namespace AX25_Utils_v1 {
+
+    String          encodeKISS(const String& frame);
+    String          decodeKISS(const String& inputFrame, bool& dataFrame);
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include <unity.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "ax25_utils.h"
+#include "ax25_utils_v1.h"
+#include "KISS_TO_TNC2.h"
+
+// AX25_Utils against the two String based implementations it replaced, kept next to this test as they were:
+// lib/KISS_TO_TNC2 (encode_kiss/decode_kiss) and the old src/ax25_utils (AX25_Utils_v1). Random valid TNC2
+// frames must encode to the same KISS bytes in all three and decode back to the same text.
+
+static std::mt19937 generator(40);
+
+static int randomInt(int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(generator);
+}
+
+static String randomAddress(bool relay) {
+    static const char characters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    String address;
+    int length = randomInt(1, 6);
+    for (int i = 0; i < length; i++) address += characters[randomInt(0, i == 0 ? 25 : 35)];
+    int ssid = randomInt(0, 15);
+    if (ssid > 0 && randomInt(0, 1)) {
+        address += "-";
+        address += ssid;
+    }
+    if (relay && randomInt(0, 2) == 0) address += "*";
+    return address;
+}
+
+static String randomFrame() {
+    String frame = randomAddress(false) + ">" + randomAddress(false);
+    int digipeaters = randomInt(0, AX25_MAX_DIGIPEATERS);
+    for (int i = 0; i < digipeaters; i++) frame += "," + randomAddress(true);
+    frame += ":";
+    int length = randomInt(0, 200);
+    for (int i = 0; i < length; i++) {
+        int kind = randomInt(0, 9);
+        if (kind == 0) {
+            frame += (char)FEND;
+        } else if (kind == 1) {
+            frame += (char)FESC;
+        } else if (kind == 2) {
+            frame += (char)randomInt(0x80, 0xFF);
+        } else {
+            frame += (char)randomInt(0x20, 0x7E);
+        }
+    }
+    return frame;
+}
+
+static String encodeNew(const String& frame) {
+    uint8_t kiss[AX25_MAX_FRAME_LENGTH];
+    size_t  length = AX25_Utils::encodeKISS(frame.c_str(), frame.length(), kiss, sizeof(kiss));
+    return String((const char*)kiss, length);
+}
+
+static String decodeNew(const String& kiss, bool& dataFrame) {
+    char    frame[AX25_MAX_FRAME_LENGTH];
+    size_t  length = AX25_Utils::decodeKISS((const uint8_t*)kiss.c_str(), kiss.length(), frame, sizeof(frame), dataFrame);
+    return String(frame, length);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_round_trip_against_both_previous_codecs() {
+    for (int n = 0; n < 20000; n++) {
+        String frame    = randomFrame();
+        String kiss     = encodeNew(frame);
+        TEST_ASSERT_TRUE_MESSAGE(kiss.length() > 0, frame.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(kiss == AX25_Utils_v1::encodeKISS(frame), frame.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(kiss == encode_kiss(frame), frame.c_str());
+        TEST_ASSERT_TRUE(kiss == AX25_Utils::encodeKISS(frame));
+
+        bool dataFrame = false;
+        TEST_ASSERT_TRUE_MESSAGE(decodeNew(kiss, dataFrame) == frame, frame.c_str());
+        TEST_ASSERT_TRUE(dataFrame);
+        TEST_ASSERT_TRUE(AX25_Utils::decodeKISS(kiss, dataFrame) == frame);
+        TEST_ASSERT_TRUE(AX25_Utils_v1::decodeKISS(kiss, dataFrame) == frame);
+        TEST_ASSERT_TRUE(decode_kiss(kiss, dataFrame) == frame);
+    }
+}
+
+void test_malformed_text_is_rejected() {
+    uint8_t kiss[AX25_MAX_FRAME_LENGTH];
+    const char* frames[] = {
+        "N0CALL-16>APLRT1:ssid over 15",
+        "TOOLONG1>APLRT1:callsign over 6",
+        "N0CALL>APLRT1,A,B,C,D,E,F,G,H,I:nine digipeaters",
+        "N0CALL>APLRT1 no payload",
+        "N0CALL APLRT1:no destination",
+        "N0CALL*>APLRT1:digipeated source",
+        ">APLRT1:no source",
+        "N0CALL>APLRT1,:empty digipeater",
+        "N0CALL->APLRT1:empty ssid",
+    };
+    for (const char* frame : frames) {
+        TEST_ASSERT_EQUAL_MESSAGE(0, AX25_Utils::encodeKISS(frame, strlen(frame), kiss, sizeof(kiss)), frame);
+        TEST_ASSERT_TRUE_MESSAGE(AX25_Utils::encodeKISS(String(frame)).isEmpty(), frame);
+    }
+    const char* frame = "N0CALL>APLRT1:fits exactly";
+    size_t length = AX25_Utils::encodeKISS(frame, strlen(frame), kiss, sizeof(kiss));
+    TEST_ASSERT_EQUAL(length, AX25_Utils::encodeKISS(frame, strlen(frame), kiss, length));
+    TEST_ASSERT_EQUAL(0, AX25_Utils::encodeKISS(frame, strlen(frame), kiss, length - 1));
+}
+
+void test_malformed_kiss_is_rejected() {
+    String kiss = encodeNew("N0CALL>APLRT1,WIDE1-1:payload");
+    bool dataFrame;
+    char frame[AX25_MAX_FRAME_LENGTH];
+
+    String badEscape = kiss.substring(0, kiss.length() - 1) + (char)FESC + "A" + (char)FEND;
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeKISS((const uint8_t*)badEscape.c_str(), badEscape.length(), frame, sizeof(frame), dataFrame));
+    String truncated = kiss.substring(0, 10) + (char)FEND;
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeKISS((const uint8_t*)truncated.c_str(), truncated.length(), frame, sizeof(frame), dataFrame));
+    String unterminated = kiss.substring(0, kiss.length() - 1);
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeKISS((const uint8_t*)unterminated.c_str(), unterminated.length(), frame, sizeof(frame), dataFrame));
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeKISS((const uint8_t*)kiss.c_str(), kiss.length(), frame, 10, dataFrame));
+}
+
+void test_command_frames_decode_to_nothing() {
+    // KISS_TO_TNC2 passed command frames on as raw bytes, AX25_Utils returns "" and leaves dataFrame false
+    String command = String((char)FEND) + (char)0x01 + (char)0x32 + (char)FEND;      // TXDELAY 500 ms
+    bool dataFrame = true;
+    TEST_ASSERT_TRUE(decode_kiss(command, dataFrame) == command);
+    TEST_ASSERT_FALSE(dataFrame);
+    dataFrame = true;
+    TEST_ASSERT_TRUE(AX25_Utils::decodeKISS(command, dataFrame).isEmpty());
+    TEST_ASSERT_FALSE(dataFrame);
+}
+
+void test_buffer_with_several_frames() {
+    String first    = "N0CALL>APLRT1:first";
+    String second   = "N0CALL-7>APLRT1,WIDE1-1:second";
+    String command  = String((char)FEND) + (char)0x01 + (char)0x32 + (char)FEND;
+    String buffer   = command + String((char)FEND) + encodeNew(first) + encodeNew(second);
+
+    bool dataFrame;
+    TEST_ASSERT_TRUE(AX25_Utils::decodeKISS(buffer, dataFrame) == first);
+    TEST_ASSERT_TRUE(dataFrame);
+
+    size_t offset = 0;
+    const uint8_t* kiss;
+    size_t kissLength;
+    std::vector<String> frames;
+    while (AX25_Utils::nextKISSFrame((const uint8_t*)buffer.c_str(), buffer.length(), offset, kiss, kissLength)) {
+        frames.push_back(String((const char*)kiss, kissLength));
+    }
+    TEST_ASSERT_EQUAL(3, frames.size());
+    TEST_ASSERT_TRUE(frames[0] == command);
+    TEST_ASSERT_TRUE(decodeNew(frames[1], dataFrame) == first);
+    TEST_ASSERT_TRUE(decodeNew(frames[2], dataFrame) == second);
+}
+
+void test_benchmark() {
+    std::vector<String> frames;
+    for (int i = 0; i < 5000; i++) frames.push_back(randomFrame());
+    volatile size_t sink = 0;
+    bool dataFrame;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const String& frame : frames) sink = sink + decode_kiss(encode_kiss(frame), dataFrame).length();
+    auto library = std::chrono::steady_clock::now();
+    for (const String& frame : frames) sink = sink + AX25_Utils_v1::decodeKISS(AX25_Utils_v1::encodeKISS(frame), dataFrame).length();
+    auto previous = std::chrono::steady_clock::now();
+    uint8_t kiss[AX25_MAX_FRAME_LENGTH];
+    char    text[AX25_MAX_FRAME_LENGTH];
+    for (const String& frame : frames) {
+        size_t length = AX25_Utils::encodeKISS(frame.c_str(), frame.length(), kiss, sizeof(kiss));
+        sink = sink + AX25_Utils::decodeKISS(kiss, length, text, sizeof(text), dataFrame);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double libraryNs    = std::chrono::duration<double, std::nano>(library - start).count() / frames.size();
+    double previousNs   = std::chrono::duration<double, std::nano>(previous - library).count() / frames.size();
+    double bufferNs     = std::chrono::duration<double, std::nano>(end - previous).count() / frames.size();
+    char message[128];
+    snprintf(message, sizeof(message), "encode + decode per frame: KISS_TO_TNC2 %.0f ns, old AX25_Utils %.0f ns, buffers %.0f ns",
+                libraryNs, previousNs, bufferNs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(bufferNs < libraryNs && bufferNs < previousNs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_against_both_previous_codecs);
+    RUN_TEST(test_malformed_text_is_rejected);
+    RUN_TEST(test_malformed_kiss_is_rejected);
+    RUN_TEST(test_command_frames_decode_to_nothing);
+    RUN_TEST(test_buffer_with_several_frames);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,155 @@
+#include <unity.h>
+#include <chrono>
+#include <vector>
+#include <logger.h>
+
+// filter_utils.cpp logs through the firmware logger, so it is built into this test instead of the shared native sources
+#include "filter_utils.cpp"
+
+logging::Logger     logger;
+
+// Each term on its own and in combination, then the cost of classify + filter per frame against the full decode the
+// station list would otherwise run on every frame.
+
+static const String ownCall     = "CA2RXU-7";
+static const String nearby      = "SQ2CPA-9>APLRT1,WIDE1-1:=5213.78N/02100.73E>Mobile";         // Warsaw
+static const String faraway     = "LU1ABC-9>APLRT1,WIDE1-1:=3436.00S/05822.00W>Mobile";         // Buenos Aires
+static const String status      = "SQ2CPA-9>APLRT1,WIDE1-1:>QRV 438.775";
+static const String telemetry   = "SQ2CPA-9>APLRT1,WIDE1-1:T#012,412,000,000,000,000,00000000";
+static const String weather     = "SQ2CPA-13>APLRW1:=5213.78N/02100.73E_090/005g010t050";
+static const String message     = "LU1ABC-9>APLRT1,WIDE1-1::SQ2CPA-9 :hello{12";
+static const String forUs       = "LU1ABC-9>APLRT1,WIDE1-1::CA2RXU-7 :hello{13";
+static const String repeated    = "LU1ABC-9>APLRT1,DIGI-1*,WIDE2-1:>heard through DIGI-1";
+static const String requested   = "LU1ABC-9>APLRT1,DIGI-1,WIDE2-1:>not repeated yet";
+
+static bool passes(const String& frame) {
+    FrameHeader header = FRAME_Utils::classify(frame);
+    APRSPacket  decoded;
+    bool        isDecoded = false;
+    return FILTER_Utils::passes(frame, header, ownCall, decoded, isDecoded);
+}
+
+void setUp() {
+    FILTER_Utils::setPosition(true, 52.2297, 21.0122);
+}
+
+void tearDown() {
+    FILTER_Utils::compile("");
+}
+
+void test_range_terms() {
+    FILTER_Utils::compile("m/50");
+    TEST_ASSERT_TRUE(passes(nearby));
+    TEST_ASSERT_FALSE(passes(faraway));
+    TEST_ASSERT_FALSE(passes(status));                  // no position, nothing to measure
+    FILTER_Utils::setPosition(false, 0, 0);
+    TEST_ASSERT_FALSE(passes(nearby));                  // no fix, m/ matches nothing
+
+    FILTER_Utils::compile("r/-34.6/-58.4/100");
+    TEST_ASSERT_TRUE(passes(faraway));
+    TEST_ASSERT_FALSE(passes(nearby));
+}
+
+void test_buddy_and_prefix_terms() {
+    FILTER_Utils::compile("b/SQ2CPA-9/LU1*");
+    TEST_ASSERT_TRUE(passes(nearby));
+    TEST_ASSERT_TRUE(passes(faraway));
+    TEST_ASSERT_FALSE(passes(weather));                 // SQ2CPA-13, no wildcard on the first pattern
+
+    FILTER_Utils::compile("p/sq");                      // patterns are upper cased
+    TEST_ASSERT_TRUE(passes(nearby));
+    TEST_ASSERT_TRUE(passes(weather));
+    TEST_ASSERT_FALSE(passes(faraway));
+}
+
+void test_type_terms() {
+    FILTER_Utils::compile("t/s");
+    TEST_ASSERT_TRUE(passes(status));
+    TEST_ASSERT_FALSE(passes(nearby));
+    FILTER_Utils::compile("t/tw");
+    TEST_ASSERT_TRUE(passes(telemetry));
+    TEST_ASSERT_TRUE(passes(weather));
+    TEST_ASSERT_FALSE(passes(status));
+    FILTER_Utils::compile("t/m");
+    TEST_ASSERT_TRUE(passes(message));
+    TEST_ASSERT_FALSE(passes(nearby));
+}
+
+void test_digipeater_terms() {
+    FILTER_Utils::compile("d/DIGI-1");
+    TEST_ASSERT_TRUE(passes(repeated));
+    TEST_ASSERT_FALSE(passes(requested));               // DIGI-1 asked for, but has not repeated it
+    FILTER_Utils::compile("d/WIDE*");
+    TEST_ASSERT_FALSE(passes(repeated));                // WIDE2-1 comes after the last '*'
+    FILTER_Utils::compile("d/DIGI*");
+    TEST_ASSERT_TRUE(passes(repeated));
+}
+
+void test_exclusions() {
+    FILTER_Utils::compile("-t/t");
+    TEST_ASSERT_FALSE(passes(telemetry));
+    TEST_ASSERT_TRUE(passes(status));                   // only exclusions: everything else passes
+
+    FILTER_Utils::compile("m/50 -b/SQ2CPA-13");
+    TEST_ASSERT_TRUE(passes(nearby));
+    TEST_ASSERT_FALSE(passes(weather));                 // in range, but excluded
+    TEST_ASSERT_FALSE(passes(faraway));
+}
+
+void test_messages_for_us_always_pass() {
+    FILTER_Utils::compile("-p/LU m/50 t/s");
+    TEST_ASSERT_TRUE(passes(forUs));
+    TEST_ASSERT_FALSE(passes(message));
+    String thirdParty = "IGATE-10>APLRG1,WIDE1-1:}LU1ABC-9>APLRT1,TCPIP,IGATE-10*::CA2RXU-7 :via igate";
+    FrameHeader header  = FRAME_Utils::classify(thirdParty);
+    FrameHeader content = FRAME_Utils::classify(thirdParty, header.payloadStart + 2);
+    APRSPacket  decoded;
+    bool        isDecoded = false;
+    TEST_ASSERT_TRUE(FILTER_Utils::passes(thirdParty, content, ownCall, decoded, isDecoded));
+}
+
+void test_rejected_terms() {
+    FILTER_Utils::compile("x/1 b/ t/z r/1/2");          // unknown, empty, no known type, missing range
+    TEST_ASSERT_FALSE(FILTER_Utils::isActive());
+    FILTER_Utils::compile("b/A1/A2/A3/A4/A5/A6/A7/A8/SQ2CPA-9");
+    TEST_ASSERT_FALSE(FILTER_Utils::isActive());        // nine patterns: rejected rather than cut to eight
+    FILTER_Utils::compile("b/A1/A2/A3/A4/A5/A6/A7/SQ2CPA-9");
+    TEST_ASSERT_TRUE(passes(nearby));
+}
+
+void test_benchmark() {
+    std::vector<String> frames;
+    const String corpus[] = {nearby, faraway, status, telemetry, weather, message, repeated, requested};
+    for (int i = 0; i < 4000; i++) frames.push_back(corpus[i % 8]);
+    FILTER_Utils::compile("m/50 b/LU1ABC-9 t/m -t/t d/DIGI-1");
+    volatile int sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const String& frame : frames) {
+        APRSPacket decoded = APRSPacketLib::processReceivedPacket(frame, 0, 0, 0);
+        sink = sink + decoded.sender.length();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (const String& frame : frames) sink = sink + passes(frame);
+    auto end = std::chrono::steady_clock::now();
+
+    double decodeNs = std::chrono::duration<double, std::nano>(middle - start).count() / frames.size();
+    double filterNs = std::chrono::duration<double, std::nano>(end - middle).count() / frames.size();
+    char message[96];
+    snprintf(message, sizeof(message), "full decode %.0f ns, classify + filter %.0f ns per frame", decodeNs, filterNs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(filterNs < decodeNs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_range_terms);
+    RUN_TEST(test_buddy_and_prefix_terms);
+    RUN_TEST(test_type_terms);
+    RUN_TEST(test_digipeater_terms);
+    RUN_TEST(test_exclusions);
+    RUN_TEST(test_messages_for_us_always_pass);
+    RUN_TEST(test_rejected_terms);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
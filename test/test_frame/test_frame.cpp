@@ -0,0 +1,123 @@
+#include <unity.h>
+#include <chrono>
+#include <vector>
+#include <APRSPacketLib.h>
+#include "frame_utils.h"
+
+// FRAME_Utils::classify() against the full APRSPacketLib decode it routes around: same source, path, type and
+// symbol on a mixed corpus, then the time per frame of both on the same corpus.
+
+static std::vector<String> corpus() {
+    std::vector<String> frames;
+    String compressed = APRSPacketLib::encodeGPS(52.2297, 21.0122, 90, 30, ">", true, 120, false, "GPS");
+    frames.push_back(APRSPacketLib::generateGPSBeaconPacket("CA2RXU-7", "APLRT1", "WIDE1-1", "/", compressed));
+    frames.push_back(APRSPacketLib::generateMiceGPSBeacon("111", "SQ2CPA-9", "[", "/", "WIDE1-1", -33.4489, -70.6693, 180, 12, 560));
+    frames.push_back(APRSPacketLib::generateMessagePacket("CA2RXU-7", "APLRT1", "WIDE1-1", "SQ2CPA-9", "hello{12"));
+    frames.push_back(APRSPacketLib::generateStatusPacket("CA2RXU-7", "APLRT1", "WIDE1-1", "QRV 438.775"));
+    frames.push_back("SQ2CPA-9>APLRT1,WIDE1-1:=5213.78N/02100.73E>123/045/A=000350 Mobile");
+    frames.push_back("SQ2CPA-9>APLRT1:>no path");
+    frames.push_back("SQ2CPA-9>APLRT1,DIGI-1*,WIDE2-1:>heard through DIGI-1");
+    frames.push_back("SQ2CPA-9>APLRT1,DIGI-1*,DIGI-2*:>heard through DIGI-2");
+    frames.push_back("SQ2CPA-9>APLRT1,WIDE1-1:T#012,412,000,000,000,000,00000000");
+    frames.push_back("CA2RXU-7>APLRT1,WIDE1-1:;LEADER   *092345z4903.50N/07201.75W>088/036");
+    frames.push_back("DIGI-1>APLRD1:=5213.78NL02100.73E#LoRa digi");
+    frames.push_back("IGATE-10>APLRG1,WIDE1-1:}SQ2CPA-9>APLRT1,TCPIP,IGATE-10*::CA2RXU-7 :from the internet");
+    return frames;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_header_matches_full_decode() {
+    for (const String& frame : corpus()) {
+        FrameHeader header = FRAME_Utils::classify(frame);
+        TEST_ASSERT_TRUE_MESSAGE(header.valid, frame.c_str());
+        FrameHeader content = header.thirdParty ? FRAME_Utils::classify(frame, header.payloadStart + 2) : header;
+        TEST_ASSERT_TRUE_MESSAGE(content.valid, frame.c_str());
+
+        APRSPacket decoded = APRSPacketLib::processReceivedPacket(frame, 0, 0, 0);
+        TEST_ASSERT_EQUAL_MESSAGE(decoded.type, content.type, frame.c_str());
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(decoded.sender.c_str(), FRAME_Utils::getSource(frame, content).c_str(), frame.c_str());
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(decoded.path.c_str(), FRAME_Utils::getPath(frame, content).c_str(), frame.c_str());
+        if (content.type == 0 || content.type == 4) {
+            TEST_ASSERT_EQUAL_MESSAGE(decoded.symbol[0], FRAME_Utils::getSymbol(frame, content), frame.c_str());
+        }
+        if (content.type == 1) {
+            TEST_ASSERT_TRUE(FRAME_Utils::isAddressedTo(frame, content, decoded.addressee));
+        }
+    }
+}
+
+void test_malformed_frames_are_rejected() {
+    TEST_ASSERT_FALSE(FRAME_Utils::classify("").valid);
+    TEST_ASSERT_FALSE(FRAME_Utils::classify("SQ2CPA-9>APLRT1").valid);
+    TEST_ASSERT_FALSE(FRAME_Utils::classify(">APLRT1:>status").valid);
+    TEST_ASSERT_FALSE(FRAME_Utils::classify("SQ2CPA-9>APLRT1:").valid);
+    TEST_ASSERT_FALSE(FRAME_Utils::classify("SQ2CPA-9 APLRT1:>status").valid);
+}
+
+void test_addressee_needs_exact_padded_match() {
+    String frame = APRSPacketLib::generateMessagePacket("CA2RXU-7", "APLRT1", "WIDE1-1", "SQ2CPA-9", "hello");
+    FrameHeader header = FRAME_Utils::classify(frame);
+    TEST_ASSERT_TRUE(FRAME_Utils::isAddressedTo(frame, header, "SQ2CPA-9"));
+    TEST_ASSERT_FALSE(FRAME_Utils::isAddressedTo(frame, header, "SQ2CPA"));
+    TEST_ASSERT_FALSE(FRAME_Utils::isAddressedTo(frame, header, "SQ2CPA-10"));
+    TEST_ASSERT_FALSE(FRAME_Utils::isAddressedTo(frame, header, "CA2RXU-7"));
+}
+
+void test_infrastructure_sender() {
+    int start, end;
+    String frame = "SQ2CPA-9>APLRT1,DIGI-1*,DIGI-2*,WIDE2-1:>status";
+    TEST_ASSERT_TRUE(FRAME_Utils::getInfrastructureSender(frame, FRAME_Utils::classify(frame), start, end));
+    TEST_ASSERT_EQUAL_STRING("DIGI-2", frame.substring(start, end).c_str());
+
+    frame = "DIGI-1>APLRD1:=5213.78NL02100.73E#LoRa digi";
+    TEST_ASSERT_TRUE(FRAME_Utils::getInfrastructureSender(frame, FRAME_Utils::classify(frame), start, end));
+    TEST_ASSERT_EQUAL_STRING("DIGI-1", frame.substring(start, end).c_str());
+
+    frame = "IGATE-10>APLRG1,WIDE1-1:}SQ2CPA-9>APLRT1,TCPIP,IGATE-10*::CA2RXU-7 :hi";
+    TEST_ASSERT_TRUE(FRAME_Utils::getInfrastructureSender(frame, FRAME_Utils::classify(frame), start, end));
+    TEST_ASSERT_EQUAL_STRING("IGATE-10", frame.substring(start, end).c_str());
+
+    frame = "SQ2CPA-9>APLRT1,WIDE1-1:=5213.78N/02100.73E>Mobile";
+    TEST_ASSERT_FALSE(FRAME_Utils::getInfrastructureSender(frame, FRAME_Utils::classify(frame), start, end));
+}
+
+void test_benchmark() {
+    // Mostly beacons, as on a busy channel
+    std::vector<String> base = corpus();
+    std::vector<String> frames;
+    for (int i = 0; i < 2000; i++) {
+        frames.push_back(base[i % 2]);
+        frames.push_back(base[i % base.size()]);
+    }
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const String& frame : frames) {
+        APRSPacket decoded = APRSPacketLib::processReceivedPacket(frame, 0, 0, 0);
+        sink = sink + decoded.sender.length();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (const String& frame : frames) {
+        FrameHeader header = FRAME_Utils::classify(frame);
+        sink = sink + FRAME_Utils::getSource(frame, header).length();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double decodeNs     = std::chrono::duration<double, std::nano>(middle - start).count() / frames.size();
+    double classifyNs   = std::chrono::duration<double, std::nano>(end - middle).count() / frames.size();
+    char message[96];
+    snprintf(message, sizeof(message), "full decode %.0f ns, classify %.0f ns per frame", decodeNs, classifyNs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(classifyNs < decodeNs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_matches_full_decode);
+    RUN_TEST(test_malformed_frames_are_rejected);
+    RUN_TEST(test_addressee_needs_exact_padded_match);
+    RUN_TEST(test_infrastructure_sender);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include "ax25_codec.h"
+
+// The on-air framings against each other: every frame must come back from the air as the TNC2 text it was sent
+// as, whichever format the sender picked, and the binary ones must cost less airtime on the frames a tracker sends.
+// Only ax25_codec.h is used, so a dependency on the Arduino core would break this build.
+
+static std::mt19937 generator(41);
+
+static int randomInt(int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(generator);
+}
+
+static std::string randomAddress(bool relay) {
+    static const char characters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::string address;
+    int length = randomInt(1, 6);
+    for (int i = 0; i < length; i++) address += characters[randomInt(0, i == 0 ? 25 : 35)];
+    int ssid = randomInt(0, 15);
+    if (ssid > 0) address += "-" + std::to_string(ssid);
+    if (relay && randomInt(0, 1)) address += "*";
+    return address;
+}
+
+static std::string randomFrame() {
+    std::string frame = randomAddress(false) + ">" + randomAddress(false);
+    int digipeaters = randomInt(0, AX25_MAX_DIGIPEATERS);
+    for (int i = 0; i < digipeaters; i++) frame += "," + randomAddress(true);
+    frame += ":";
+    int length = randomInt(0, 120);
+    for (int i = 0; i < length; i++) frame += (char)randomInt(0x00, 0xFF);      // binary payloads are not escaped
+    return frame;
+}
+
+static std::string onAir(const std::string& frame, uint8_t framing) {
+    uint8_t data[256];
+    size_t  length = AX25_Utils::encodeLoRaFrame(frame.data(), frame.length(), data, sizeof(data), framing);
+    return std::string((const char*)data, length);
+}
+
+// What a receiver hands on: binary frames as "\x3c\xff\x01" + TNC2, anything else as it came
+static std::string received(const std::string& air) {
+    char    frame[AX25_MAX_FRAME_LENGTH];
+    size_t  length = AX25_Utils::decodeLoRaFrame((const uint8_t*)air.data(), air.length(), frame, sizeof(frame));
+    return length > 0 ? std::string(frame, length) : air;
+}
+
+static std::string text(const std::string& frame) {
+    return std::string("\x3c\xff\x01") + frame;
+}
+
+// Semtech time on air, explicit header, CRC, 8 symbol preamble, CR 4/5, 125 kHz, low data rate optimisation at SF11/12
+static double timeOnAir(size_t length, int spreadingFactor) {
+    double symbol       = (double)(1 << spreadingFactor) / 125000.0 * 1000.0;
+    int lowDataRate     = spreadingFactor >= 11 ? 1 : 0;
+    int numerator       = 8 * (int)length - 4 * spreadingFactor + 28 + 16;
+    int symbols         = (int)ceil((double)numerator / (4 * (spreadingFactor - 2 * lowDataRate))) * 5;
+    return (8 + 4.25) * symbol + (8 + (symbols > 0 ? symbols : 0)) * symbol;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_binary_round_trip() {
+    for (int n = 0; n < 20000; n++) {
+        std::string frame = randomFrame();
+        for (bool packed : {false, true}) {
+            uint8_t data[256];
+            char    decoded[AX25_MAX_FRAME_LENGTH];
+            size_t  length = AX25_Utils::encodeBinary(frame.data(), frame.length(), data, sizeof(data), packed);
+            TEST_ASSERT_TRUE_MESSAGE(length > 0, frame.c_str());
+            size_t  decodedLength = AX25_Utils::decodeBinary(data, length, decoded, sizeof(decoded), packed);
+            TEST_ASSERT_TRUE_MESSAGE(std::string(decoded, decodedLength) == frame, frame.c_str());
+        }
+    }
+}
+
+void test_every_framing_reads_back_as_text() {
+    for (int n = 0; n < 20000; n++) {
+        std::string frame = randomFrame();
+        for (uint8_t framing : {LORA_FRAMING_TEXT, LORA_FRAMING_AX25, LORA_FRAMING_PACKED}) {
+            std::string air = onAir(frame, framing);
+            TEST_ASSERT_TRUE_MESSAGE(received(air) == text(frame), frame.c_str());
+            TEST_ASSERT_TRUE(air.length() <= text(frame).length());
+            if (framing == LORA_FRAMING_TEXT) TEST_ASSERT_EQUAL(0x01, (uint8_t)air[2]);
+        }
+    }
+}
+
+void test_address_fields() {
+    const char* frames[] = {
+        "CA2RXU-15>APLRT1:ssid 15",
+        "CA2RXU-10>APLRT1-1,WIDE1-1:ssid 10",
+        "A>B:single character calls",
+        "SQ2CPA-9>APLRT1,DIGI-1*,WIDE2-1:digipeated hop",
+        "SQ2CPA-9>APLRT1,DIGI-1*,DIGI-2*,DIGI-3*,DIGI-4*,DIGI-5*,DIGI-6*,DIGI-7*,WIDE2*:eight digipeaters",
+        "SQ2CPA-9>APLRT1:",
+    };
+    for (const char* frame : frames) {
+        for (bool packed : {false, true}) {
+            uint8_t data[256];
+            char    decoded[AX25_MAX_FRAME_LENGTH];
+            size_t  length = AX25_Utils::encodeBinary(frame, strlen(frame), data, sizeof(data), packed);
+            TEST_ASSERT_TRUE_MESSAGE(length > 0, frame);
+            // last address flag only on the final address
+            int addressSize = packed ? 5 : 7;
+            int addresses   = 1;
+            for (const char* c = frame; *c != ':'; c++) if (*c == ',' || *c == '>') addresses++;
+            for (int i = 0; i < addresses; i++) {
+                uint8_t flags   = data[i * addressSize + addressSize - 1];
+                bool    last    = packed ? (flags & 0x80) : (flags & 0x01);
+                TEST_ASSERT_EQUAL_MESSAGE(i == addresses - 1, last, frame);
+            }
+            size_t decodedLength = AX25_Utils::decodeBinary(data, length, decoded, sizeof(decoded), packed);
+            TEST_ASSERT_TRUE_MESSAGE(std::string(decoded, decodedLength) == frame, frame);
+        }
+    }
+}
+
+void test_frames_binary_cannot_carry_stay_text() {
+    const char* frames[] = {
+        "ca2rxu-7>APLRT1,WIDE1-1:lower case only fits AX.25 addresses",
+        "SQ2CPA-9>APLRT1,A,B,C,D,E,F,G,H,I:nine digipeaters",
+        "TOOLONG1>APLRT1:callsign over 6",
+        "SQ2CPA-16>APLRT1:ssid over 15",
+        "SQ2CPA-9>APLRT1 no payload",
+        "A>B:x",                                        // shorter as text
+    };
+    for (const char* frame : frames) {
+        std::string air = onAir(frame, LORA_FRAMING_PACKED);
+        TEST_ASSERT_EQUAL_MESSAGE(0x01, (uint8_t)air[2], frame);
+        TEST_ASSERT_TRUE_MESSAGE(air == text(frame), frame);
+    }
+    TEST_ASSERT_EQUAL(0x03, (uint8_t)onAir(frames[0], LORA_FRAMING_AX25)[2]);
+
+    std::string longFrame = "SQ2CPA-9>APLRT1:" + std::string(300, 'x');    // cut to the radio buffer like any text frame
+    std::string air = onAir(longFrame, LORA_FRAMING_AX25);
+    TEST_ASSERT_EQUAL(256, air.length());
+    TEST_ASSERT_TRUE(air == text(longFrame).substr(0, 256));
+}
+
+void test_malformed_binary_is_not_decoded() {
+    std::string air = onAir("SQ2CPA-9>APLRT1,WIDE1-1:>status text", LORA_FRAMING_PACKED);
+    TEST_ASSERT_EQUAL(0x04, (uint8_t)air[2]);
+    char frame[AX25_MAX_FRAME_LENGTH];
+
+    std::string truncated = air.substr(0, 3 + 5 + 2);
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeLoRaFrame((const uint8_t*)truncated.data(), truncated.length(), frame, sizeof(frame)));
+    std::string overflow = air;
+    overflow[3] = (char)0xff;                           // base 40 value past ZZZZZZ
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeLoRaFrame((const uint8_t*)overflow.data(), overflow.length(), frame, sizeof(frame)));
+    std::string reserved = air;
+    reserved[3 + 4] |= 0x30;                            // reserved SSID bits
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeLoRaFrame((const uint8_t*)reserved.data(), reserved.length(), frame, sizeof(frame)));
+    std::string fec = air;
+    fec[2] = 0x02;                                      // FEC frames are unwrapped before they get here
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeLoRaFrame((const uint8_t*)fec.data(), fec.length(), frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeLoRaFrame((const uint8_t*)air.data(), air.length(), frame, 12));
+
+    std::string ax25 = onAir("SQ2CPA-9>APLRT1,WIDE1-1:>status text", LORA_FRAMING_AX25);
+    ax25[3] |= 0x01;                                    // extension bit inside the callsign
+    TEST_ASSERT_EQUAL(0, AX25_Utils::decodeLoRaFrame((const uint8_t*)ax25.data(), ax25.length(), frame, sizeof(frame)));
+}
+
+void test_airtime_of_tracker_frames() {
+    struct Case {
+        const char* name;
+        const char* frame;
+    } cases[] = {
+        {"beacon",  "CA2RXU-7>APLRT1,WIDE1-1:!/4Ea+P>r8>GQ [Mobile"},
+        {"mic-e",   "CA2RXU-7>S32U6T,WIDE1-1:`(_fn\"Oj/]"},
+        {"message", "CA2RXU-7>APLRT1,WIDE1-1::SQ2CPA-9 :QRV on 438.775{12"},
+        {"status",  "CA2RXU-7>APLRT1,WIDE1-1:>https://github.com/richonguzman"},
+    };
+    for (const Case& c : cases) {
+        double airtime[3];
+        for (uint8_t framing : {LORA_FRAMING_TEXT, LORA_FRAMING_AX25, LORA_FRAMING_PACKED}) {
+            airtime[framing] = timeOnAir(onAir(c.frame, framing).length(), 12);
+        }
+        char message[128];
+        snprintf(message, sizeof(message), "%-8s SF12: text %.0f ms, AX.25 %.0f ms, packed %.0f ms", c.name, airtime[0], airtime[1], airtime[2]);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_TRUE(airtime[LORA_FRAMING_AX25] <= airtime[LORA_FRAMING_TEXT]);
+        TEST_ASSERT_TRUE(airtime[LORA_FRAMING_PACKED] < airtime[LORA_FRAMING_TEXT]);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_binary_round_trip);
+    RUN_TEST(test_every_framing_reads_back_as_text);
+    RUN_TEST(test_address_fields);
+    RUN_TEST(test_frames_binary_cannot_carry_stay_text);
+    RUN_TEST(test_malformed_binary_is_not_decoded);
+    RUN_TEST(test_airtime_of_tracker_frames);
+    return UNITY_END();
+}
@@ -0,0 +1,159 @@
+#include <unity.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "geo_utils.h"
+
+// Error bounds of GEO_Utils against the double precision TinyGPSPlus formulas it replaced, and the time per call
+// of both. On the host the FPU does double in hardware, so the benchmark only shows the float code is not slower;
+// the gain on the ESP32 comes from skipping soft-float.
+
+static double radians(double degrees) {
+    return degrees * M_PI / 180.0;
+}
+
+static double referenceDistance(double lat1, double long1, double lat2, double long2) {
+    double delta    = radians(long1 - long2);
+    double sdlong   = sin(delta);
+    double cdlong   = cos(delta);
+    lat1 = radians(lat1);
+    lat2 = radians(lat2);
+    double slat1 = sin(lat1), clat1 = cos(lat1), slat2 = sin(lat2), clat2 = cos(lat2);
+    delta = (clat1 * slat2) - (slat1 * clat2 * cdlong);
+    delta = sqrt(delta * delta + (clat2 * sdlong) * (clat2 * sdlong));
+    double denom = (slat1 * slat2) + (clat1 * clat2 * cdlong);
+    return atan2(delta, denom) * 6372795;
+}
+
+static double referenceCourse(double lat1, double long1, double lat2, double long2) {
+    double dlon = radians(long2 - long1);
+    lat1 = radians(lat1);
+    lat2 = radians(lat2);
+    double a1 = sin(dlon) * cos(lat2);
+    double a2 = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dlon);
+    a2 = atan2(a1, a2);
+    if (a2 < 0.0) a2 += 2 * M_PI;
+    return a2 * 180.0 / M_PI;
+}
+
+struct Pair {
+    double lat1, lon1, lat2, lon2;
+};
+
+// Own position anywhere below 80 deg, the other station from 1 m to a few thousand km away
+static std::vector<Pair> randomPairs(int count) {
+    std::mt19937 generator(31);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Pair> pairs;
+    while ((int)pairs.size() < count) {
+        Pair pair;
+        pair.lat1 = unit(generator) * 160.0 - 80.0;
+        pair.lon1 = unit(generator) * 360.0 - 180.0;
+        double scale = pow(10.0, unit(generator) * 5.5 - 5.0);
+        pair.lat2 = pair.lat1 + (unit(generator) * 2.0 - 1.0) * scale * 0.3;
+        pair.lon2 = pair.lon1 + (unit(generator) * 2.0 - 1.0) * scale;
+        if (pair.lat2 > 89.0 || pair.lat2 < -89.0) continue;
+        if (pair.lon2 > 180.0) pair.lon2 -= 360.0;
+        if (pair.lon2 < -180.0) pair.lon2 += 360.0;
+        pairs.push_back(pair);
+    }
+    return pairs;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_distance_error_bounds() {
+    double worstShort = 0, worstLong = 0;
+    for (const Pair& p : randomPairs(200000)) {
+        double reference    = referenceDistance(p.lat1, p.lon1, p.lat2, p.lon2);
+        double distance     = GEO_Utils::distanceBetween(p.lat1, p.lon1, p.lat2, p.lon2);
+        double error        = fabs(distance - reference);
+        if (reference < GEO_EQUIRECTANGULAR_LIMIT) {
+            error -= 0.00002 * reference;                           // 0.002% or 0.3 m, whichever is larger
+            if (error > worstShort) worstShort = error;
+        } else if (error / reference > worstLong) {
+            worstLong = error / reference;
+        }
+    }
+    char message[96];
+    snprintf(message, sizeof(message), "short range excess %.3f m, long range %.2e relative", worstShort, worstLong);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(worstShort <= 0.3);
+    TEST_ASSERT_TRUE(worstLong <= 0.000001);
+}
+
+void test_course_error_bound() {
+    double worst = 0;
+    for (const Pair& p : randomPairs(200000)) {
+        if (referenceDistance(p.lat1, p.lon1, p.lat2, p.lon2) < 50.0) continue;     // a few cm of float jitter turn the bearing
+        double error = fabs(GEO_Utils::courseTo(p.lat1, p.lon1, p.lat2, p.lon2) - referenceCourse(p.lat1, p.lon1, p.lat2, p.lon2));
+        if (error > 180.0) error = 360.0 - error;
+        if (error > worst) worst = error;
+    }
+    char message[64];
+    snprintf(message, sizeof(message), "course %.5f deg", worst);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(worst <= 0.001);
+}
+
+void test_known_distances() {
+    TEST_ASSERT_FLOAT_WITHIN(1.0, 0.0, GEO_Utils::distanceBetween(52.2297, 21.0122, 52.2297, 21.0122));
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 111.2, GEO_Utils::distanceBetween(0.0, 0.0, 0.001, 0.0));
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 90.0, GEO_Utils::courseTo(0.0, 0.0, 0.0, 0.01));
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 90.0, GEO_Utils::courseTo(0.0, 179.999, 0.0, -179.999));     // east across the date line
+    TEST_ASSERT_FLOAT_WITHIN(5.0, 222.4, GEO_Utils::distanceBetween(0.0, 179.999, 0.0, -179.999));
+}
+
+void test_locator() {
+    TEST_ASSERT_EQUAL_STRING("KO02MF", GEO_Utils::getMaidenheadLocator(52.2297, 21.0122, 6));
+    TEST_ASSERT_EQUAL_STRING("FF46PN", GEO_Utils::getMaidenheadLocator(-33.4489, -70.6693, 6));
+    TEST_ASSERT_EQUAL_STRING("KO02", GEO_Utils::getMaidenheadLocator(52.2297, 21.0122, 4));
+    TEST_ASSERT_EQUAL_STRING("AA00AA", GEO_Utils::getMaidenheadLocator(-90.0, -180.0, 6));
+    TEST_ASSERT_EQUAL_STRING("RR99XX", GEO_Utils::getMaidenheadLocator(90.0, 180.0, 6));
+
+    // Every pair against floor() of the exact position in double
+    const double lonSizes[5] = {20.0, 2.0, 2.0 / 24, 2.0 / 240, 2.0 / 5760};
+    const double latSizes[5] = {10.0, 1.0, 1.0 / 24, 1.0 / 240, 1.0 / 5760};
+    const int    bases[5]    = {18, 10, 24, 10, 24};
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (int n = 0; n < 100000; n++) {
+        double lat = unit(generator) * 180.0 - 90.0;
+        double lon = unit(generator) * 360.0 - 180.0;
+        char expected[11];
+        for (int i = 0; i < 5; i++) {
+            char base = (i % 2 == 1) ? '0' : 'A';
+            expected[i * 2]     = base + (int)fmod(floor((lon + 180.0) / lonSizes[i]), bases[i]);
+            expected[i * 2 + 1] = base + (int)fmod(floor((lat + 90.0) / latSizes[i]), bases[i]);
+        }
+        expected[10] = 0;
+        TEST_ASSERT_EQUAL_STRING(expected, GEO_Utils::getMaidenheadLocator(lat, lon, 10));
+    }
+}
+
+void test_benchmark() {
+    std::vector<Pair> pairs = randomPairs(100000);
+    volatile double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Pair& p : pairs) sink = sink + referenceDistance(p.lat1, p.lon1, p.lat2, p.lon2) + referenceCourse(p.lat1, p.lon1, p.lat2, p.lon2);
+    auto middle = std::chrono::steady_clock::now();
+    for (const Pair& p : pairs) sink = sink + GEO_Utils::distanceBetween(p.lat1, p.lon1, p.lat2, p.lon2) + GEO_Utils::courseTo(p.lat1, p.lon1, p.lat2, p.lon2);
+    auto end = std::chrono::steady_clock::now();
+
+    double referenceNs  = std::chrono::duration<double, std::nano>(middle - start).count() / pairs.size();
+    double floatNs      = std::chrono::duration<double, std::nano>(end - middle).count() / pairs.size();
+    char message[96];
+    snprintf(message, sizeof(message), "distance + course: double %.1f ns, float %.1f ns per pair", referenceNs, floatNs);
+    TEST_MESSAGE(message);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_distance_error_bounds);
+    RUN_TEST(test_course_error_bound);
+    RUN_TEST(test_known_distances);
+    RUN_TEST(test_locator);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
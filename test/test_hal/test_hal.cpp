@@ -0,0 +1,71 @@
+#include <unity.h>
+#include <vector>
+#include "hal_utils.h"
+
+
+void setUp() {}
+void tearDown() {}
+
+void test_clock_moves_only_when_told() {
+    uint32_t start = HAL::now();
+    TEST_ASSERT_EQUAL_UINT32(start, HAL::now());
+    HAL::delay(250);
+    TEST_ASSERT_EQUAL_UINT32(start + 250, HAL::now());
+    HAL::advance(1000);
+    TEST_ASSERT_EQUAL_UINT32(start + 1250, HAL::now());
+}
+
+void test_elapsed_time_survives_wraparound() {
+    HAL::advance(0xFFFFFFFF - HAL::now() - 500);
+    uint32_t before = HAL::now();
+    HAL::advance(2000);
+    TEST_ASSERT_LESS_THAN_UINT32(before, HAL::now());
+    TEST_ASSERT_EQUAL_UINT32(2000, HAL::now() - before);
+}
+
+void test_storage_round_trip() {
+    String line;
+    TEST_ASSERT_FALSE(HAL::readLine("/missing.txt", line));
+    TEST_ASSERT_TRUE(HAL::writeLine("/index.txt", "2"));
+    TEST_ASSERT_TRUE(HAL::readLine("/index.txt", line));
+    TEST_ASSERT_EQUAL_STRING("2", line.c_str());
+    TEST_ASSERT_TRUE(HAL::writeLine("/index.txt", "0"));
+    TEST_ASSERT_TRUE(HAL::readLine("/index.txt", line));
+    TEST_ASSERT_EQUAL_STRING("0", line.c_str());
+}
+
+void test_message_files() {
+    std::vector<String> lines;
+    TEST_ASSERT_FALSE(HAL::readLines("/aprsMessages.txt", lines));
+    TEST_ASSERT_TRUE(HAL::appendLine("/aprsMessages.txt", "SQ2CPA-9,hello"));
+    TEST_ASSERT_TRUE(HAL::appendLine("/aprsMessages.txt", "SQ2CPA-9,second"));
+    TEST_ASSERT_TRUE(HAL::readLines("/aprsMessages.txt", lines));
+    TEST_ASSERT_EQUAL(2, lines.size());
+    TEST_ASSERT_EQUAL_STRING("SQ2CPA-9,second", lines[1].c_str());
+    TEST_ASSERT_TRUE(HAL::removeFile("/aprsMessages.txt"));
+    TEST_ASSERT_FALSE(HAL::removeFile("/aprsMessages.txt"));
+    TEST_ASSERT_FALSE(HAL::readLines("/aprsMessages.txt", lines));
+}
+
+void test_gps_feed_keeps_unread_bytes() {
+    while (HAL::gpsAvailable() > 0) HAL::gpsRead();
+    TEST_ASSERT_EQUAL(-1, HAL::gpsRead());
+    HAL::gpsFeed("$GPGGA");
+    TEST_ASSERT_EQUAL(6, HAL::gpsAvailable());
+    TEST_ASSERT_EQUAL('$', HAL::gpsRead());
+    TEST_ASSERT_EQUAL('G', HAL::gpsRead());
+    HAL::gpsFeed(",1*");
+    String rest;
+    while (HAL::gpsAvailable() > 0) rest += (char)HAL::gpsRead();
+    TEST_ASSERT_EQUAL_STRING("PGGA,1*", rest.c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clock_moves_only_when_told);
+    RUN_TEST(test_elapsed_time_survives_wraparound);
+    RUN_TEST(test_storage_round_trip);
+    RUN_TEST(test_message_files);
+    RUN_TEST(test_gps_feed_keeps_unread_bytes);
+    return UNITY_END();
+}
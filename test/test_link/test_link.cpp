@@ -0,0 +1,124 @@
+#include <unity.h>
+#include <random>
+#include <logger.h>
+#include "hal_utils.h"
+
+// link_utils.cpp reads the firmware globals below, so it is built into this test instead of the shared native sources
+#include "link_utils.cpp"
+
+Configuration       Config;
+logging::Logger     logger;
+LoraType            loraType        = {433775000, 12, 125000, 5, 20};
+LoraType            *currentLoRaType = &loraType;
+
+Configuration::Configuration() {}
+
+// Simulated channel: an igate heard at some SNR that hears us back at the same SNR at the same power, minus
+// whatever power the controller takes off. Airtime from the Semtech time-on-air formula (explicit header, CRC,
+// 8 symbol preamble, low data rate optimisation at SF11/12).
+
+static double timeOnAir(int length, int spreadingFactor) {
+    double symbol       = (double)(1 << spreadingFactor) / loraType.signalBandwidth * 1000.0;
+    int lowDataRate     = spreadingFactor >= 11 ? 1 : 0;
+    int numerator       = 8 * length - 4 * spreadingFactor + 28 + 16;
+    int symbols         = (int)ceil((double)numerator / (4 * (spreadingFactor - 2 * lowDataRate))) * (loraType.codingRate4);
+    return (8 + 4.25) * symbol + (8 + (symbols > 0 ? symbols : 0)) * symbol;
+}
+
+static float uplinkMargin(float snr, const LinkSettings& settings) {
+    return snr - (loraType.power - settings.power) - LINK_Utils::getRequiredSnr(settings.spreadingFactor);
+}
+
+static void hearIgate(float snr) {
+    String frame = "SQ2CPA-9>APLRT1,IGATE-10*:>status";
+    LINK_Utils::processPacket(frame, FRAME_Utils::classify(frame), -110, snr);
+}
+
+void setUp() {
+    Config.linkAdaptation = {true, 8, 3, 2, 9};
+    LINK_Utils::reset();
+    HAL::advance(1000);         // a station heard at time 0 would look like an empty slot
+}
+
+void tearDown() {}
+
+void test_control_law_limits() {
+    LinkSettings base = LINK_Utils::getBaseSettings();
+    LinkSettings next = LINK_Utils::decide(20.0, base, base, Config.linkAdaptation);
+    TEST_ASSERT_EQUAL(9, next.spreadingFactor);                 // never below the configured minimum
+    TEST_ASSERT_EQUAL(2, next.power);                           // nor below the minimum power
+    next = LINK_Utils::decide(-30.0, base, base, Config.linkAdaptation);
+    TEST_ASSERT_EQUAL(base.spreadingFactor, next.spreadingFactor);
+    TEST_ASSERT_EQUAL(base.power, next.power);
+
+    Config.linkAdaptation.minSpreadingFactor = 0;               // 0 keeps the LoRa type spreading factor
+    next = LINK_Utils::decide(20.0, base, base, Config.linkAdaptation);
+    TEST_ASSERT_EQUAL(base.spreadingFactor, next.spreadingFactor);
+    TEST_ASSERT_TRUE(next.power < base.power);
+}
+
+void test_hysteresis_on_spreading_factor_steps() {
+    LinkSettings base       = LINK_Utils::getBaseSettings();
+    LinkSettings current    = base;
+    float stepDown          = LINK_Utils::getRequiredSnr(11) + Config.linkAdaptation.targetMargin;
+    // Going faster needs the hysteresis on top of the target margin
+    current = LINK_Utils::decide(stepDown + 0.5, current, base, Config.linkAdaptation);
+    TEST_ASSERT_EQUAL(12, current.spreadingFactor);
+    current = LINK_Utils::decide(stepDown + Config.linkAdaptation.hysteresis, current, base, Config.linkAdaptation);
+    TEST_ASSERT_EQUAL(11, current.spreadingFactor);
+    // and it stays there until the target margin itself is gone
+    current = LINK_Utils::decide(stepDown + 0.5, current, base, Config.linkAdaptation);
+    TEST_ASSERT_EQUAL(11, current.spreadingFactor);
+    current = LINK_Utils::decide(stepDown - 0.5, current, base, Config.linkAdaptation);
+    TEST_ASSERT_EQUAL(12, current.spreadingFactor);
+}
+
+void test_falls_back_when_igate_goes_quiet() {
+    hearIgate(10.0);
+    TEST_ASSERT_TRUE(LINK_Utils::getTxSettings().spreadingFactor < 12);
+    HAL::advance(LINK_STALE_TIME * 1000UL);
+    LinkSettings settings = LINK_Utils::getTxSettings();
+    TEST_ASSERT_EQUAL(12, settings.spreadingFactor);
+    TEST_ASSERT_EQUAL(20, settings.power);
+}
+
+void test_simulated_drive() {
+    // Four hours of a beacon a minute, driving away from the igate and back, with 2 dB of fading on every frame
+    std::mt19937 generator(35);
+    std::normal_distribution<float> fading(0.0f, 2.0f);
+    double fixedAirtime = 0, adaptedAirtime = 0;
+    int delivered = 0, fixedDelivered = 0, changes = 0, beacons = 0;
+    LinkSettings base       = LINK_Utils::getBaseSettings();
+    LinkSettings previous   = base;
+    for (int minute = 0; minute < 240; minute++) {
+        float meanSnr = 12.0f - 30.0f * (float)(minute < 120 ? minute : 240 - minute) / 120.0f;      // +12 dB down to -18 dB
+        hearIgate(meanSnr + fading(generator));
+        HAL::advance(60000);
+
+        LinkSettings settings = LINK_Utils::getTxSettings();
+        float snr = meanSnr + fading(generator);
+        beacons++;
+        if (uplinkMargin(snr, settings) >= 0) delivered++;
+        if (uplinkMargin(snr, base) >= 0) fixedDelivered++;
+        adaptedAirtime  += timeOnAir(60, settings.spreadingFactor);
+        fixedAirtime    += timeOnAir(60, base.spreadingFactor);
+        if (settings.spreadingFactor != previous.spreadingFactor || settings.power != previous.power) changes++;
+        previous = settings;
+    }
+    char message[128];
+    snprintf(message, sizeof(message), "delivered %d/%d (fixed %d), airtime %.0f s instead of %.0f s, %d changes",
+                delivered, beacons, fixedDelivered, adaptedAirtime / 1000, fixedAirtime / 1000, changes);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(delivered >= fixedDelivered - 2);              // a fade right after stepping down may cost a beacon
+    TEST_ASSERT_TRUE(adaptedAirtime < 0.7 * fixedAirtime);
+    TEST_ASSERT_TRUE(changes < 50);                                 // about 100 without the hysteresis
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_control_law_limits);
+    RUN_TEST(test_hysteresis_on_spreading_factor_steps);
+    RUN_TEST(test_falls_back_when_igate_goes_quiet);
+    RUN_TEST(test_simulated_drive);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+#include <unity.h>
+#include <chrono>
+#include <vector>
+
+// msg_queue.cpp reads the firmware globals below and sends through sendMessage(), so it is built into this test
+// instead of the shared native sources, with a sendMessage() that records what would have gone on air
+#include "msg_queue.cpp"
+
+uint32_t            lastTxTime          = 0;
+uint8_t             winlinkStatus       = 0;
+int                 ackRequestNumber    = 0;
+
+struct SentMessage {
+    uint32_t    time;
+    String      station;
+    String      message;
+};
+std::vector<SentMessage>    sentMessages;
+
+namespace MSG_Utils {
+    void sendMessage(const String& station, const String& textMessage) {
+        sentMessages.push_back({HAL::now(), station, textMessage});
+    }
+}
+
+namespace SLEEP_Utils {
+    void wakeBy(uint32_t deadline) {}
+}
+
+// loop() runs processOutputBuffer() at least once a second, the light sleep deadline it registers
+static void runFor(uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += 1000) {
+        HAL::advance(1000);
+        MSG_Utils::processOutputBuffer();
+    }
+}
+
+void setUp() {
+    outputMessagesBuffer.clear();
+    outputAckRequestBuffer.clear();
+    ackRequestState = false;
+    winlinkStatus   = 0;
+    sentMessages.clear();
+    HAL::advance(10000);            // clear of the gaps after the previous test's traffic
+}
+
+void tearDown() {}
+
+void test_retry_ladder_without_ack() {
+    MSG_Utils::addToOutputBuffer(1, "SQ2CPA-9", "hello");
+    int number = ackRequestNumber;
+    runFor(15 * 60 * 1000);
+    TEST_ASSERT_EQUAL(6, sentMessages.size());
+    TEST_ASSERT_EQUAL(number, ackRequestNumber);                // giving up must not restart the message numbers
+    for (const SentMessage& sent : sentMessages) {
+        TEST_ASSERT_EQUAL_STRING("SQ2CPA-9", sent.station.c_str());
+        TEST_ASSERT_EQUAL_STRING(("hello{" + String(ackRequestNumber)).c_str(), sent.message.c_str());
+    }
+    // First try at once, then after 30, 60, 120, 120 and 120 s; checks run once a second so each gap is one more
+    const uint32_t gaps[5] = {31000, 61000, 121000, 121000, 121000};
+    for (int i = 0; i < 5; i++) TEST_ASSERT_EQUAL_UINT32(gaps[i], sentMessages[i + 1].time - sentMessages[i].time);
+    TEST_ASSERT_TRUE(outputAckRequestBuffer.empty());
+    TEST_ASSERT_TRUE(MSG_Utils::checkOutputBufferEmpty());
+}
+
+void test_ack_stops_the_retries() {
+    MSG_Utils::addToOutputBuffer(1, "SQ2CPA-9", "hello");
+    runFor(40 * 1000);
+    TEST_ASSERT_EQUAL(2, sentMessages.size());
+    MSG_Utils::checkAck("SQ2CPA-9", "ack" + String(ackRequestNumber - 1));     // an older number changes nothing
+    MSG_Utils::checkAck("LU1ABC-9", "ack" + String(ackRequestNumber));         // nor the right number from someone else
+    TEST_ASSERT_FALSE(outputAckRequestBuffer.empty());
+    MSG_Utils::checkAck("SQ2CPA-9", "ack" + String(ackRequestNumber));
+    TEST_ASSERT_TRUE(outputAckRequestBuffer.empty());
+    runFor(10 * 60 * 1000);
+    TEST_ASSERT_EQUAL(2, sentMessages.size());
+}
+
+void test_heard_message_holds_the_output() {
+    MSG_Utils::holdOutputBuffer();
+    MSG_Utils::addToOutputBuffer(0, "SQ2CPA-9", "ack12");
+    MSG_Utils::addToOutputBuffer(0, "SQ2CPA-9", "ack12");        // queued once
+    runFor(5000);
+    TEST_ASSERT_EQUAL(0, sentMessages.size());
+    runFor(1000);
+    TEST_ASSERT_EQUAL(1, sentMessages.size());
+    MSG_Utils::addToOutputBuffer(0, "SQ2CPA-9", "pong, 73!");
+    runFor(3000);
+    TEST_ASSERT_EQUAL(1, sentMessages.size());                  // more than 3 s after our last Tx
+    runFor(1000);
+    TEST_ASSERT_EQUAL(2, sentMessages.size());
+    TEST_ASSERT_EQUAL_STRING("pong, 73!", sentMessages[1].message.c_str());
+}
+
+void test_unanswered_winlink_login_is_reset() {
+    winlinkStatus = 1;
+    MSG_Utils::addToOutputBuffer(1, "WLNK-1", "L");
+    runFor(15 * 60 * 1000);
+    TEST_ASSERT_EQUAL(6, sentMessages.size());
+    TEST_ASSERT_EQUAL(0, winlinkStatus);
+}
+
+void test_a_day_of_messages_runs_in_milliseconds() {
+    auto wallStart      = std::chrono::steady_clock::now();
+    uint32_t start      = HAL::now();
+    for (int i = 0; i < 96; i++) {                              // one unanswered message every 15 minutes
+        MSG_Utils::addToOutputBuffer(1, "SQ2CPA-9", "report " + String(i));
+        runFor(15 * 60 * 1000);
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    char message[96];
+    snprintf(message, sizeof(message), "%u s of retries in %.1f ms", (unsigned int)((HAL::now() - start) / 1000), wallMs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(96 * 6, sentMessages.size());
+    TEST_ASSERT_TRUE(wallMs < 1000);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_retry_ladder_without_ack);
+    RUN_TEST(test_ack_stops_the_retries);
+    RUN_TEST(test_heard_message_holds_the_output);
+    RUN_TEST(test_unanswered_winlink_login_is_reset);
+    RUN_TEST(test_a_day_of_messages_runs_in_milliseconds);
+    return UNITY_END();
+}
@@ -0,0 +1,184 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "telemetry_codec.h"
+
+// The encoder against the base91 comment telemetry spec (|ss11..55dd|, each pair (c1 - 33) * 91 + (c2 - 33)), and the
+// slot layout against what the definition frames announce: a station decoding by the PARM/UNIT/EQNS it last heard
+// must never see values in slots those frames did not describe.
+
+static int decodePair(const std::string& telemetry, int pair) {
+    return (telemetry[1 + 2 * pair] - 33) * 91 + (telemetry[2 + 2 * pair] - 33);
+}
+
+static std::string encode(uint16_t sequence, const uint16_t* analog, uint8_t analogCount, int digital) {
+    char    telemetry[TELEMETRY_MAX_LENGTH];
+    size_t  length = TELEMETRY_Utils::encode(sequence, analog, analogCount, digital, telemetry, sizeof(telemetry));
+    return std::string(telemetry, length);
+}
+
+static std::string frame(int& sequence) {
+    char    telemetry[TELEMETRY_MAX_LENGTH];
+    size_t  length = TELEMETRY_Utils::encodeFrame(sequence, telemetry, sizeof(telemetry));
+    return std::string(telemetry, length);
+}
+
+static std::string definition(uint8_t which) {
+    char    text[80];
+    size_t  length = TELEMETRY_Utils::definitionText(which, text, sizeof(text));
+    return std::string(text, length);
+}
+
+// Sends every pending definition, as checkDefinitions() does one per beacon
+static void sendDefinitions() {
+    for (uint8_t next; (next = TELEMETRY_Utils::nextDefinition()) != 0; ) TELEMETRY_Utils::definitionSent(next);
+}
+
+void setUp() {
+    TELEMETRY_Utils::reset();
+}
+
+void tearDown() {}
+
+void test_spec_vectors() {
+    const uint16_t zero[1]  = {0};
+    TEST_ASSERT_EQUAL_STRING("|!!!!|", encode(0, zero, 1, -1).c_str());
+    const uint16_t top[1]   = {8280};
+    TEST_ASSERT_EQUAL_STRING("|!\"{{|", encode(1, top, 1, -1).c_str());
+    const uint16_t mixed[2] = {91, 4095};
+    TEST_ASSERT_EQUAL_STRING("|\"!\"!N!|", encode(91, mixed, 2, -1).c_str());
+}
+
+void test_one_to_five_channels() {
+    uint16_t analog[TELEMETRY_MAX_ANALOG] = {1, 90, 91, 4000, 8280};
+    for (uint8_t count = 1; count <= TELEMETRY_MAX_ANALOG; count++) {
+        std::string telemetry = encode(123, analog, count, -1);
+        TEST_ASSERT_EQUAL(2 + 2 * (1 + count), telemetry.length());
+        TEST_ASSERT_EQUAL('|', telemetry.front());
+        TEST_ASSERT_EQUAL('|', telemetry.back());
+        TEST_ASSERT_EQUAL(123, decodePair(telemetry, 0));
+        for (uint8_t i = 0; i < count; i++) TEST_ASSERT_EQUAL(analog[i], decodePair(telemetry, 1 + i));
+    }
+    TEST_ASSERT_EQUAL(0, encode(0, analog, 0, -1).length());
+    TEST_ASSERT_EQUAL(0, encode(0, analog, 6, -1).length());
+}
+
+void test_digital_byte_takes_all_five_analog_pairs() {
+    uint16_t analog[2] = {500, 600};
+    std::string telemetry = encode(7, analog, 2, 0xA5);
+    TEST_ASSERT_EQUAL(16, telemetry.length());
+    TEST_ASSERT_EQUAL(500, decodePair(telemetry, 1));
+    TEST_ASSERT_EQUAL(600, decodePair(telemetry, 2));
+    for (int i = 3; i <= 5; i++) TEST_ASSERT_EQUAL(0, decodePair(telemetry, i));
+    TEST_ASSERT_EQUAL(0xA5, decodePair(telemetry, 6));
+    TEST_ASSERT_EQUAL(0, encode(7, analog, 2, 256).length());
+
+    char small[15];
+    TEST_ASSERT_EQUAL(0, TELEMETRY_Utils::encode(7, analog, 2, 0, small, sizeof(small)));
+}
+
+void test_clamping() {
+    uint16_t analog[1] = {9000};
+    TEST_ASSERT_EQUAL(8280, decodePair(encode(0, analog, 1, -1), 1));
+
+    TELEMETRY_Utils::publish(TELEMETRY_BATTERY, 100.0);           // 10000 steps of 0.01 V
+    TELEMETRY_Utils::publish(TELEMETRY_CURRENT, -3000.0);         // below the -2000 mA offset
+    int sequence = 0;
+    std::string telemetry = frame(sequence);
+    TEST_ASSERT_EQUAL(8280, decodePair(telemetry, 1));
+    TEST_ASSERT_EQUAL(0, decodePair(telemetry, 2));
+}
+
+void test_sequence_wraps() {
+    TELEMETRY_Utils::publish(TELEMETRY_BATTERY, 4.2);
+    int sequence = TELEMETRY_SEQUENCE_WRAP - 2;
+    TEST_ASSERT_EQUAL(TELEMETRY_SEQUENCE_WRAP - 2, decodePair(frame(sequence), 0));
+    TEST_ASSERT_EQUAL(TELEMETRY_SEQUENCE_WRAP - 1, decodePair(frame(sequence), 0));
+    TEST_ASSERT_EQUAL(0, decodePair(frame(sequence), 0));
+    TEST_ASSERT_EQUAL(1, sequence);
+}
+
+void test_values_follow_the_equations() {
+    TELEMETRY_Utils::publish(TELEMETRY_BATTERY, 4.17);
+    TELEMETRY_Utils::publish(TELEMETRY_TEMPERATURE, 21.3);
+    TELEMETRY_Utils::count(TELEMETRY_RX_PACKETS);
+    TELEMETRY_Utils::count(TELEMETRY_RX_PACKETS);
+    int sequence = 0;
+    std::string telemetry = frame(sequence);
+    TEST_ASSERT_EQUAL_STRING("PARM.V_Batt,Temp,Rx", definition(TELEMETRY_DEFINITION_PARM).c_str());
+    TEST_ASSERT_EQUAL_STRING("UNIT.VDC,C,pkt", definition(TELEMETRY_DEFINITION_UNIT).c_str());
+    TEST_ASSERT_EQUAL_STRING("EQNS.0,0.01,0,0,0.1,-50,0,1,0", definition(TELEMETRY_DEFINITION_EQNS).c_str());
+    TEST_ASSERT_EQUAL(417, decodePair(telemetry, 1));
+    TEST_ASSERT_EQUAL(713, decodePair(telemetry, 2));             // (21.3 + 50) / 0.1
+    TEST_ASSERT_EQUAL(2, decodePair(telemetry, 3));
+    TEST_ASSERT_EQUAL(0, decodePair(frame(sequence), 3));         // counters restart once sent
+}
+
+void test_layout_held_until_definitions_are_out() {
+    TELEMETRY_Utils::publish(TELEMETRY_BATTERY, 4.0);
+    TELEMETRY_Utils::publish(TELEMETRY_TEMPERATURE, 20.0);
+    int sequence = 0;
+    TEST_ASSERT_EQUAL(8, frame(sequence).length());               // nothing announced yet, the first layout is used at once
+    sendDefinitions();
+
+    // A new channel and the charging bit: frames keep the two announced slots while PARM, UNIT, EQNS and BITS go out
+    TELEMETRY_Utils::publish(TELEMETRY_HEAP, 150.0);
+    TELEMETRY_Utils::publishBit(TELEMETRY_BIT_CHARGING, true);
+    const uint8_t order[4] = {TELEMETRY_DEFINITION_PARM, TELEMETRY_DEFINITION_UNIT, TELEMETRY_DEFINITION_EQNS, TELEMETRY_DEFINITION_BITS};
+    for (uint8_t expected : order) {
+        std::string telemetry = frame(sequence);
+        TEST_ASSERT_EQUAL(8, telemetry.length());
+        TEST_ASSERT_EQUAL(400, decodePair(telemetry, 1));
+        TEST_ASSERT_EQUAL(700, decodePair(telemetry, 2));
+        TEST_ASSERT_EQUAL(expected, TELEMETRY_Utils::nextDefinition());
+        TEST_ASSERT_EQUAL(expected == TELEMETRY_DEFINITION_BITS, TELEMETRY_Utils::definitionSent(expected));
+    }
+    TEST_ASSERT_EQUAL_STRING("PARM.V_Batt,Temp,Heap,,,Chg", definition(TELEMETRY_DEFINITION_PARM).c_str());
+    std::string telemetry = frame(sequence);
+    TEST_ASSERT_EQUAL(16, telemetry.length());
+    TEST_ASSERT_EQUAL(1500, decodePair(telemetry, 3));
+    TEST_ASSERT_EQUAL(1, decodePair(telemetry, 6));
+
+    // Re-announcing an unchanged layout does not hold anything
+    TELEMETRY_Utils::announceDefinitions();
+    TEST_ASSERT_EQUAL(16, frame(sequence).length());
+}
+
+void test_slots_stay_put_when_a_channel_is_displaced() {
+    TELEMETRY_Utils::publish(TELEMETRY_BATTERY, 4.0);
+    TELEMETRY_Utils::publish(TELEMETRY_CURRENT, 0);
+    TELEMETRY_Utils::publish(TELEMETRY_TEMPERATURE, 20.0);
+    TELEMETRY_Utils::publish(TELEMETRY_PRESSURE, 1013.0);
+    TELEMETRY_Utils::publish(TELEMETRY_HEAP, 150.0);
+    int sequence = 0;
+    frame(sequence);
+    sendDefinitions();
+    TEST_ASSERT_TRUE(TELEMETRY_Utils::framesCarryWeather());      // a BMP280: temperature and pressure are all there is
+
+    TELEMETRY_Utils::publish(TELEMETRY_HUMIDITY, 55.0);           // outranks the heap, takes its slot
+    std::string held = frame(sequence);
+    TEST_ASSERT_EQUAL(1500, decodePair(held, 5));
+    TEST_ASSERT_FALSE(TELEMETRY_Utils::framesCarryWeather());     // the WX beacon still goes out meanwhile
+    sendDefinitions();
+    TEST_ASSERT_EQUAL_STRING("PARM.V_Batt,I_Batt,Temp,Pres,Hum", definition(TELEMETRY_DEFINITION_PARM).c_str());
+    std::string telemetry = frame(sequence);
+    TEST_ASSERT_EQUAL(400, decodePair(telemetry, 1));
+    TEST_ASSERT_EQUAL(2000, decodePair(telemetry, 2));
+    TEST_ASSERT_EQUAL(700, decodePair(telemetry, 3));
+    TEST_ASSERT_EQUAL(5130, decodePair(telemetry, 4));
+    TEST_ASSERT_EQUAL(550, decodePair(telemetry, 5));
+    TEST_ASSERT_TRUE(TELEMETRY_Utils::framesCarryWeather());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_spec_vectors);
+    RUN_TEST(test_one_to_five_channels);
+    RUN_TEST(test_digital_byte_takes_all_five_analog_pairs);
+    RUN_TEST(test_clamping);
+    RUN_TEST(test_sequence_wraps);
+    RUN_TEST(test_values_follow_the_equations);
+    RUN_TEST(test_layout_held_until_definitions_are_out);
+    RUN_TEST(test_slots_stay_put_when_a_channel_is_displaced);
+    return UNITY_END();
+}
@@ -0,0 +1,567 @@
+#!/usr/bin/env python3
+"""Shared-channel capacity simulator: N trackers, fixed digipeaters and igates on one LoRa frequency profile.
+
+Each tracker runs a port of the firmware's beaconing and messaging logic once per simulated second, the way
+loop() does on a 1 Hz GPS:
+  - SmartBeacon (src/smartbeacon_utils.cpp, src/gps_utils.cpp): speed dependent interval, minimum distance,
+    corner pegging, standing updates (other.standingUpdateTime)
+  - optional GPS TDMA slotting (src/tdma_utils.cpp)
+  - messages with ack and the 30/60/120/120/120 s retry ladder of MSG_Utils::processOutputBuffer
+  - WIDE1-1 fill-in digipeating with duplicate check and viscous delay (src/digi_utils.cpp) on a share of the
+    trackers; fixed digipeaters repeat WIDE1-1/WIDE2-N at once
+
+The channel models time on air per LoraType of data/tracker_conf.json, log-distance path loss with per-link
+shadowing, the demodulation floor per spreading factor, half-duplex radios, collisions and the capture effect
+(a frame survives overlap when it is CAPTURE_DB above the sum of the interferers). With --fec the trackers append
+Reed-Solomon parity (src/fec_utils.cpp): interference that only hits the payload spoils whole interleaving blocks
+of SF/2 bytes, and the frame survives while those stay within the parity/2 bytes the code corrects. Its gain
+against noise is not modelled from first principles, --fec-gain lowers the demodulation floor by an assumed margin.
+
+Movement is synthetic (random waypoints with stops) or replayed from GPX tracks. Runs are discrete-event, much
+faster than real time, and every (fleet size, seed) pair runs in its own process across all host cores.
+
+    python3 tools/channel_sim.py --trackers 10 25 50 100 --hours 2 --seeds 4
+    python3 tools/channel_sim.py --profile 1 --trackers 50 --gpx tracks/*.gpx --tdma
+    python3 tools/channel_sim.py --trackers 50 100 --fec 16
+"""
+
+import argparse
+import heapq
+import json
+import math
+import multiprocessing
+import os
+import random
+import sys
+import time
+import xml.etree.ElementTree as ElementTree
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from tdma_sim import TDMA_TX_WINDOW, fnv1a     # noqa: E402
+
+CAPTURE_DB = 6.0
+NOISE_FIGURE = 6.0
+REFERENCE_DISTANCE = 100.0
+DELIVERY_TIMEOUT = 60.0
+MSG_RETRY_LADDER = [0, 30, 60, 120, 120, 120]
+DIGI_DUPE_TIME = 30.0
+DIGI_VISCOUS_DELAY = 5.0
+
+# src/smartbeacon_utils.cpp: slowRate, slowSpeed, fastRate, fastSpeed, minTxDist, minDeltaBeacon, turnMinDeg, turnSlope
+SMARTBEACON = {
+    "runner":   (120,  3, 60, 15,  50, 20, 12, 60),
+    "bike":     (120,  5, 60, 40, 100, 12, 12, 60),
+    "car":      (120, 10, 60, 70, 100, 12, 10, 80),
+}
+SPEEDS_KMH = {"runner": (6, 12), "bike": (12, 30), "car": (30, 90)}
+
+
+def time_on_air(length, sf, bw, cr, preamble=8):
+    """Semtech AN1200.13, explicit header, CRC on, low data rate optimisation above 16 ms symbols."""
+    tsym = (2 ** sf) / bw
+    de = 1 if tsym > 0.016 else 0
+    payload = 8 + max(math.ceil((8 * length - 4 * sf + 28 + 16) / (4 * (sf - 2 * de))) * cr, 0)
+    return (preamble + 4.25) * tsym + payload * tsym
+
+
+def required_snr(sf):
+    return -7.5 - 2.5 * (sf - 7)     # same floor as src/link_utils.cpp
+
+
+def load_profiles(path):
+    with open(path, encoding="utf-8") as config_file:
+        config = json.load(config_file)
+    return config["lora"], config.get("other", {})
+
+
+def load_gpx(path):
+    """[(t, x, y)] in seconds and metres from the first point, equirectangular around the track start."""
+    root = ElementTree.parse(path).getroot()
+    points = []
+    for element in root.iter():
+        if element.tag.endswith("trkpt"):
+            lat, lon = float(element.get("lat")), float(element.get("lon"))
+            stamp = None
+            for child in element:
+                if child.tag.endswith("time") and child.text:
+                    stamp = child.text
+            points.append((stamp, lat, lon))
+    if not points:
+        return []
+    lat0, lon0 = points[0][1], points[0][2]
+    k = math.cos(math.radians(lat0))
+    track = []
+    for i, (stamp, lat, lon) in enumerate(points):
+        if stamp:
+            clock = stamp.rstrip("Z").split("T")[-1].split(":")
+            seconds = int(clock[0]) * 3600 + int(clock[1]) * 60 + float(clock[2])
+        else:
+            seconds = float(i)
+        track.append((seconds, (lon - lon0) * k * 111320.0, (lat - lat0) * 111320.0))
+    t0 = track[0][0]
+    return [(t - t0 if t >= t0 else t - t0 + 86400, x, y) for t, x, y in track]
+
+
+class Channel:
+    def __init__(self, profile, rng, exponent, shadowing, fec_gain):
+        self.sf = profile["spreadingFactor"]
+        self.bw = profile["signalBandwidth"]
+        self.cr = profile["codingRate4"]
+        tsym = (2 ** self.sf) / self.bw
+        de = 1 if tsym > 0.016 else 0
+        self.header_time = (8 + 4.25 + 8) * tsym        # preamble, sync and the 8 header symbols
+        self.block_time = self.cr * tsym                # one interleaving block of 4/cr coded symbols
+        self.block_bytes = (self.sf - 2 * de) / 2.0
+        self.fec_gain = fec_gain
+        self.recovered = 0
+        self.frequency = profile["frequency"] / 1e6
+        self.noise = -174.0 + 10 * math.log10(self.bw) + NOISE_FIGURE
+        self.floor = required_snr(self.sf)
+        self.exponent = exponent
+        self.shadowing = shadowing
+        self.rng = rng
+        self.links = {}
+        self.reference_loss = 20 * math.log10(REFERENCE_DISTANCE / 1000.0) + 20 * math.log10(self.frequency) + 32.45
+        self.active = []
+        self.busy = 0.0
+        self.busy_until = 0.0
+        self.offered = 0.0
+
+    def airtime(self, length, fec=0):
+        extra = fec + 1 if fec else 0                                   # parity and the inner format byte
+        return time_on_air(length + 3 + extra, self.sf, self.bw, self.cr)     # + "<\xff\x01"
+
+    def rx_power(self, tx, rx, power, gain):
+        key = (min(tx.id, rx.id), max(tx.id, rx.id))
+        if key not in self.links:
+            self.links[key] = self.rng.gauss(0, self.shadowing)
+        d = max(math.hypot(tx.x - rx.x, tx.y - rx.y), 1.0)
+        loss = self.reference_loss + 10 * self.exponent * math.log10(max(d, REFERENCE_DISTANCE) / REFERENCE_DISTANCE)
+        return power + gain + rx.gain - loss + self.links[key]
+
+    def start(self, transmission):
+        self.active.append(transmission)
+        self.offered += transmission.end - transmission.start
+        if transmission.start >= self.busy_until:
+            self.busy += transmission.end - transmission.start
+        elif transmission.end > self.busy_until:
+            self.busy += transmission.end - self.busy_until
+        self.busy_until = max(self.busy_until, transmission.end)
+
+    def decodes(self, transmission, receiver):
+        """Whether receiver demodulates transmission, given everything that overlapped it."""
+        if receiver is transmission.sender:
+            return False
+        fec = transmission.frame.fec
+        signal = self.rx_power(transmission.sender, receiver, transmission.power, transmission.sender.gain)
+        if signal - self.noise < self.floor - (self.fec_gain if fec else 0.0):
+            return False
+        interference = 0.0
+        overlaps = []
+        for other in self.active:
+            if other is transmission or other.end <= transmission.start or other.start >= transmission.end:
+                continue
+            if other.sender is receiver:
+                return False                                        # half duplex
+            interference += 10 ** (self.rx_power(other.sender, receiver, other.power, other.sender.gain) / 10)
+            overlaps.append((max(other.start, transmission.start), min(other.end, transmission.end)))
+        if interference == 0.0:
+            return True
+        if signal - 10 * math.log10(interference) >= CAPTURE_DB:
+            return True
+        if fec and self.corrects(transmission.start, overlaps, fec):
+            self.recovered += 1
+            return True
+        return False
+
+    def corrects(self, start, overlaps, parity):
+        payload = start + self.header_time
+        blocks = set()
+        for begin, end in overlaps:
+            if begin < payload:
+                return False                                        # preamble or header hit, nothing to decode
+            blocks.update(range(int((begin - payload) / self.block_time), int((end - payload) / self.block_time) + 1))
+        return len(blocks) * self.block_bytes <= parity // 2
+
+    def prune(self, now, horizon):
+        self.active = [t for t in self.active if t.end > now - horizon]
+
+
+class Transmission:
+    __slots__ = ("sender", "frame", "start", "end", "power")
+
+    def __init__(self, sender, frame, start, end, power):
+        self.sender, self.frame, self.start, self.end, self.power = sender, frame, start, end, power
+
+
+class Frame:
+    __slots__ = ("key", "kind", "origin", "addressee", "created", "length", "wide1", "wide2", "message", "fec")
+
+    def __init__(self, key, kind, origin, length, created, addressee=None, message=None, fec=0):
+        self.key, self.kind, self.origin, self.length, self.created = key, kind, origin, length, created
+        self.addressee, self.message, self.fec = addressee, message, fec
+        self.wide1 = True           # WIDE1-1 still unused
+        self.wide2 = 0              # WIDE2-N hops left
+
+    def repeated(self):
+        copy = Frame(self.key, self.kind, self.origin, self.length + 10, self.created, self.addressee, self.message)    # repeated without FEC
+        copy.wide1 = False
+        copy.wide2 = max(self.wide2 - 1, 0) if not self.wide1 else self.wide2
+        return copy
+
+
+class Node:
+    def __init__(self, node_id, x, y, power, gain):
+        self.id, self.x, self.y, self.power, self.gain = node_id, x, y, power, gain
+        self.queue = []
+        self.transmitting_until = 0.0
+        self.dupes = {}
+        self.pending = {}
+
+    def heard_recently(self, key, now):
+        return now - self.dupes.get(key, -1e9) < DIGI_DUPE_TIME
+
+
+class Igate(Node):
+    pass
+
+
+class Digi(Node):
+    pass
+
+
+class Tracker(Node):
+    def __init__(self, node_id, rng, args, area, track=None):
+        super().__init__(node_id, 0.0, 0.0, args.power, 0.0)
+        self.rng = rng
+        self.callsign = "SQ%dTRK-%d" % (node_id % 10, node_id // 10 % 16)
+        self.kind = rng.choices(list(SPEEDS_KMH), weights=[1, 1, 3])[0]
+        self.sb = SMARTBEACON[self.kind]
+        self.area = area
+        self.track = track
+        self.track_offset = rng.uniform(0, 3600) if track else 0.0
+        self.x, self.y = rng.uniform(-area, area), rng.uniform(-area, area)
+        self.target = (self.x, self.y)
+        self.pause_until = 0.0
+        self.speed = 0.0
+        self.heading = 0.0
+        self.digi = rng.random() < args.tracker_digis
+        self.tdma_slot = fnv1a(self.callsign) % max(1, args.tdma_frame // args.tdma_slot_length)
+        self.clock_error = rng.uniform(-args.sync_error, args.sync_error)
+        self.last_tx_time = -1e9
+        self.last_tx_x, self.last_tx_y = self.x, self.y
+        self.previous_heading = 0.0
+        self.tx_interval = self.sb[0]
+        self.send_update = True
+        self.update_since = 0.0
+        self.outbox = []        # [key, addressee, tries, next retry]
+        self.ack_due = []
+
+    def move(self, now):
+        if self.track:
+            t = (now + self.track_offset) % max(self.track[-1][0], 1.0)
+            low, high = 0, len(self.track) - 1
+            while low < high:
+                mid = (low + high) // 2
+                if self.track[mid][0] < t:
+                    low = mid + 1
+                else:
+                    high = mid
+            t1, x1, y1 = self.track[low]
+            t0, x0, y0 = self.track[max(low - 1, 0)]
+            f = (t - t0) / (t1 - t0) if t1 > t0 else 0.0
+            x, y = x0 + (x1 - x0) * f, y0 + (y1 - y0) * f
+            self.speed = math.hypot(x - self.x, y - self.y)
+            if self.speed > 0.3:
+                self.heading = math.degrees(math.atan2(x - self.x, y - self.y)) % 360
+            self.x, self.y = x, y
+            return
+        if now < self.pause_until:
+            self.speed = 0.0
+            return
+        dx, dy = self.target[0] - self.x, self.target[1] - self.y
+        distance = math.hypot(dx, dy)
+        if self.speed == 0.0:
+            self.speed = self.rng.uniform(*SPEEDS_KMH[self.kind]) / 3.6
+        if distance <= self.speed:
+            self.x, self.y = self.target
+            self.target = (self.rng.uniform(-self.area, self.area), self.rng.uniform(-self.area, self.area))
+            self.pause_until = now + self.rng.choice([0, 0, 30, 120, 600])
+            self.speed = 0.0
+            return
+        self.heading = math.degrees(math.atan2(dx, dy)) % 360
+        self.x += dx / distance * self.speed
+        self.y += dy / distance * self.speed
+
+    def smart_beacon(self, now, standing_update):
+        slow_rate, slow_speed, fast_rate, fast_speed, min_tx_dist, min_delta, turn_min, turn_slope = self.sb
+        kmh = int(self.speed * 3.6)
+        if kmh < slow_speed:
+            self.tx_interval = slow_rate
+        elif kmh > fast_speed:
+            self.tx_interval = fast_rate
+        else:
+            self.tx_interval = min(slow_rate, fast_speed * fast_rate // max(kmh, 1))
+        last_tx = now - self.last_tx_time
+        distance = math.hypot(self.x - self.last_tx_x, self.y - self.last_tx_y)
+        if not self.send_update:
+            if last_tx >= self.tx_interval and distance > min_tx_dist:
+                self.send_update = True
+            elif last_tx > min_delta:
+                turn = turn_min + turn_slope / (kmh if kmh else 1)
+                delta = abs(self.previous_heading - self.heading)
+                if delta > turn and distance > min_tx_dist:
+                    self.send_update = True
+            if last_tx >= standing_update:
+                self.send_update = True
+            if self.send_update:
+                self.update_since = now
+
+    def slot_delay(self, now, args, clock_error):
+        """Seconds into this 1 s tick at which the loop would see our slot open, None when it does not open."""
+        if not args.tdma:
+            return 0.0
+        delay = (self.tdma_slot * args.tdma_slot_length - clock_error - now) % args.tdma_frame
+        return delay if delay < 1.0 else None
+
+
+class Simulation:
+    def __init__(self, args, trackers, seed):
+        self.args = args
+        self.rng = random.Random(seed)
+        profiles, other = load_profiles(args.config)
+        self.channel = Channel(profiles[args.profile], self.rng, args.path_loss_exponent, args.shadowing, args.fec_gain)
+        self.standing_update = other.get("standingUpdateTime", 15) * 60
+        area = args.area * 1000 / 2
+        tracks = [load_gpx(path) for path in args.gpx] if args.gpx else []
+        tracks = [track for track in tracks if len(track) > 1]
+        self.trackers = [Tracker(i, self.rng, args, area, tracks[i % len(tracks)] if tracks else None) for i in range(trackers)]
+        node_id = trackers
+        self.igates = []
+        self.digis = []
+        grid = max(1, math.ceil(math.sqrt(args.igates)))
+        for i in range(args.igates):
+            x = (i % grid + 0.5) / grid * 2 * area - area
+            y = (i // grid + 0.5) / grid * 2 * area - area
+            self.igates.append(Igate(node_id, x, y, args.power, args.infra_gain))
+            node_id += 1
+        for i in range(args.digis):
+            self.digis.append(Digi(node_id, self.rng.uniform(-area, area), self.rng.uniform(-area, area), args.power, args.infra_gain))
+            node_id += 1
+        self.receivers = self.trackers + self.igates + self.digis
+        self.events = []
+        self.sequence = 0
+        self.frame_key = 0
+        self.beacons = {}
+        self.messages = {}
+        self.transmissions = 0
+        self.lost = 0
+
+    def schedule(self, when, action, *data):
+        self.sequence += 1
+        heapq.heappush(self.events, (when, self.sequence, action, data))
+
+    def new_key(self):
+        self.frame_key += 1
+        return self.frame_key
+
+    def send(self, node, frame, now):
+        # One radio per node: a frame queued behind the one on the air goes right after it, like the Tx queue
+        start = max(now, node.transmitting_until)
+        end = start + self.channel.airtime(frame.length, frame.fec)
+        node.transmitting_until = end
+        self.schedule(start, self.tx_start, node, frame, end)
+
+    def tx_start(self, now, node, frame, end):
+        transmission = Transmission(node, frame, now, end, node.power)
+        self.channel.start(transmission)
+        self.transmissions += 1
+        self.schedule(end, self.tx_end, transmission)
+
+    def tx_end(self, now, transmission):
+        frame = transmission.frame
+        heard_by_any = False
+        for receiver in self.receivers:
+            if self.channel.decodes(transmission, receiver):
+                heard_by_any = True
+                self.receive(now, receiver, frame)
+        if not heard_by_any:
+            self.lost += 1
+        self.channel.prune(now, 30.0)
+
+    def receive(self, now, node, frame):
+        if isinstance(node, Igate):
+            if frame.kind == "beacon":
+                record = self.beacons[frame.key]
+                if record[1] is None:
+                    record[1] = now
+            return
+        if frame.wide1 is False:
+            node.pending.pop(frame.key, None)       # somebody else repeated it: cancel our viscous copy
+        if isinstance(node, Digi):
+            if (frame.wide1 or frame.wide2 > 0) and not node.heard_recently(frame.key, now):
+                node.dupes[frame.key] = now
+                self.send(node, frame.repeated(), now + 0.1)
+            return
+        tracker = node
+        if tracker.digi and frame.wide1 and not tracker.heard_recently(frame.key, now):
+            tracker.dupes[frame.key] = now
+            tracker.pending[frame.key] = frame
+            self.schedule(now + DIGI_VISCOUS_DELAY, self.digi_due, tracker, frame.key)
+        if frame.kind == "message" and frame.addressee is tracker:
+            record = self.messages[frame.message]
+            if record[1] is None:
+                record[1] = now
+            tracker.ack_due.append((now + 6.0, frame.origin, frame.message))
+        elif frame.kind == "ack" and frame.addressee is tracker:
+            record = self.messages[frame.message]
+            if record[2] is None:
+                record[2] = now
+            tracker.outbox = [entry for entry in tracker.outbox if entry[0] != frame.message]
+
+    def digi_due(self, now, tracker, key):
+        frame = tracker.pending.pop(key, None)
+        if frame is not None:
+            self.send(tracker, frame.repeated(), now)
+
+    def tick(self, now):
+        args = self.args
+        for tracker in self.trackers:
+            tracker.move(now)
+            tracker.smart_beacon(now, self.standing_update)
+            delay = tracker.slot_delay(now, args, tracker.clock_error) if tracker.send_update else None
+            if delay is not None:
+                key = self.new_key()
+                frame = Frame(key, "beacon", tracker, args.beacon_bytes, tracker.update_since, fec=args.fec)
+                self.beacons[key] = [tracker.update_since, None]
+                self.send(tracker, frame, now + delay)
+                tracker.send_update = False
+                tracker.last_tx_time = now
+                tracker.last_tx_x, tracker.last_tx_y = tracker.x, tracker.y
+                tracker.previous_heading = tracker.heading
+            if args.messages > 0 and self.rng.random() < args.messages / 3600.0 and len(self.trackers) > 1:
+                addressee = self.rng.choice([t for t in self.trackers if t is not tracker])
+                message = self.new_key()
+                self.messages[message] = [now, None, None]
+                tracker.outbox.append([message, addressee, 0, now])
+            for entry in tracker.outbox:
+                message, addressee, tries, due = entry
+                if now >= due and tries < len(MSG_RETRY_LADDER):
+                    frame = Frame(self.new_key(), "message", tracker, args.message_bytes, now, addressee, message, args.fec)
+                    self.send(tracker, frame, now)
+                    entry[2] = tries + 1
+                    entry[3] = now + (MSG_RETRY_LADDER[tries + 1] if tries + 1 < len(MSG_RETRY_LADDER) else 0)
+            tracker.outbox = [entry for entry in tracker.outbox if entry[2] < len(MSG_RETRY_LADDER) or now < entry[3]]
+            while tracker.ack_due and tracker.ack_due[0][0] <= now:
+                _, origin, message = tracker.ack_due.pop(0)
+                self.send(tracker, Frame(self.new_key(), "ack", tracker, args.ack_bytes, now, origin, message, args.fec), now)
+        if now + 1 < args.hours * 3600:
+            self.schedule(now + 1, self.tick)
+
+    def run(self):
+        self.schedule(0.0, self.tick)
+        while self.events:
+            when, _, action, data = heapq.heappop(self.events)
+            action(when, *data)
+        duration = self.args.hours * 3600
+        timeout = DELIVERY_TIMEOUT + (self.args.tdma_frame if self.args.tdma else 0)    # slotted beacons may wait a frame
+        settled = [record for record in self.beacons.values() if record[0] < duration - timeout]
+        delivered = [record[1] - record[0] for record in settled if record[1] is not None and record[1] - record[0] <= timeout]
+        messages = [record for record in self.messages.values() if record[0] < duration - 600]
+        return {
+            "beacons": len(settled),
+            "delivered": len(delivered),
+            "latencies": delivered,
+            "messages": len(messages),
+            "messages_delivered": sum(1 for record in messages if record[1] is not None),
+            "messages_acked": sum(1 for record in messages if record[2] is not None),
+            "utilization": self.channel.busy / duration,
+            "offered": self.channel.offered / duration,
+            "transmissions": self.transmissions,
+            "unheard": self.lost,
+            "recovered": self.channel.recovered,
+        }
+
+
+def run_one(job):
+    args, trackers, seed = job
+    started = time.time()
+    result = Simulation(args, trackers, seed).run()
+    result["trackers"] = trackers
+    result["wall"] = time.time() - started
+    return result
+
+
+def percentile(values, p):
+    if not values:
+        return float("nan")
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p / 100.0 * len(values)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser.add_argument("--config", default=os.path.join(root, "data", "tracker_conf.json"))
+    parser.add_argument("--profile", type=int, default=0, help="index into the lora array of the config")
+    parser.add_argument("--trackers", type=int, nargs="+", default=[10, 25, 50, 100])
+    parser.add_argument("--seeds", type=int, default=4)
+    parser.add_argument("--hours", type=float, default=2)
+    parser.add_argument("--area", type=float, default=20, help="square side in km")
+    parser.add_argument("--igates", type=int, default=4)
+    parser.add_argument("--digis", type=int, default=2)
+    parser.add_argument("--tracker-digis", type=float, default=0.1, help="share of trackers with WIDE1-1 fill-in")
+    parser.add_argument("--power", type=float, default=20, help="dBm")
+    parser.add_argument("--infra-gain", type=float, default=12, help="dB of antenna gain and height for igates/digis")
+    parser.add_argument("--path-loss-exponent", type=float, default=2.9)
+    parser.add_argument("--shadowing", type=float, default=6, help="dB sigma, fixed per link")
+    parser.add_argument("--beacon-bytes", type=int, default=45)
+    parser.add_argument("--message-bytes", type=int, default=50)
+    parser.add_argument("--ack-bytes", type=int, default=35)
+    parser.add_argument("--messages", type=float, default=0.5, help="messages per tracker per hour")
+    parser.add_argument("--gpx", nargs="*", default=[])
+    parser.add_argument("--tdma", action="store_true")
+    parser.add_argument("--tdma-frame", type=int, default=60)
+    parser.add_argument("--tdma-slot-length", type=int, default=5)
+    parser.add_argument("--sync-error", type=float, default=0.3)
+    parser.add_argument("--fec", type=int, default=0, help="Reed-Solomon parity bytes on tracker frames, 0 is off")
+    parser.add_argument("--fec-gain", type=float, default=1.0, help="assumed dB of FEC gain against noise")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count())
+    args = parser.parse_args()
+
+    profiles, _ = load_profiles(args.config)
+    profile = profiles[args.profile]
+    jobs = [(args, trackers, seed) for trackers in args.trackers for seed in range(args.seeds)]
+    started = time.time()
+    with multiprocessing.Pool(min(args.jobs, len(jobs))) as pool:
+        results = pool.map(run_one, jobs)
+    wall = time.time() - started
+
+    print("profile %d: %.3f MHz SF%d BW%d CR4/%d, beacon airtime %.2f s%s" % (
+        args.profile, profile["frequency"] / 1e6, profile["spreadingFactor"], profile["signalBandwidth"] / 1000,
+        profile["codingRate4"], time_on_air(args.beacon_bytes + 3, profile["spreadingFactor"], profile["signalBandwidth"], profile["codingRate4"]),
+        (", TDMA" if args.tdma else "") + (", FEC %d" % args.fec if args.fec else "")))
+    print("%8s %10s %10s %10s %10s %10s %10s %10s" % ("trackers", "delivered", "lat p50", "lat p95", "msg rx", "msg ack", "busy", "offered"))
+    for trackers in args.trackers:
+        group = [r for r in results if r["trackers"] == trackers]
+        beacons = sum(r["beacons"] for r in group)
+        latencies = [value for r in group for value in r["latencies"]]
+        messages = sum(r["messages"] for r in group)
+        print("%8d %9.1f%% %9.1fs %9.1fs %9.1f%% %9.1f%% %9.1f%% %9.1f%%" % (
+            trackers,
+            100.0 * sum(r["delivered"] for r in group) / beacons if beacons else 0,
+            percentile(latencies, 50), percentile(latencies, 95),
+            100.0 * sum(r["messages_delivered"] for r in group) / messages if messages else 0,
+            100.0 * sum(r["messages_acked"] for r in group) / messages if messages else 0,
+            100.0 * sum(r["utilization"] for r in group) / len(group),
+            100.0 * sum(r["offered"] for r in group) / len(group)))
+    if args.fec:
+        print("FEC recovered %d receptions of %d transmissions" % (
+            sum(r["recovered"] for r in results), sum(r["transmissions"] for r in results)))
+    simulated = args.hours * 3600 * len(jobs)
+    print("%d runs, %.0f simulated hours in %.1f s wall on %d processes (%.0fx real time)" % (
+        len(jobs), simulated / 3600, wall, min(args.jobs, len(jobs)), simulated / wall))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""Compression ratio of the beacon comment codec (src/comment_utils.cpp) on a corpus of real comments.
+
+The dictionary is read from src/comment_utils.cpp, so the numbers follow the table the firmware is built with, and
+every comment is expanded again to check the round trip. Input files hold one comment per line, or raw TNC2
+packets (APRS-IS or aprs.fi raw dumps, the tracker's serial log) from which the comment of position and status
+frames is cut the way sendBeacon() assembles it: after the position and its course/speed or PHG extension, without
+a base91 telemetry suffix, which stays uncompressed on air.
+
+    python3 tools/comment_ratio.py comments.txt
+    python3 tools/comment_ratio.py --tnc2 aprsis_dump.log --suggest 20
+    cat *.log | python3 tools/comment_ratio.py --tnc2 -
+"""
+
+import argparse
+import collections
+import json
+import os
+import re
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from channel_sim import time_on_air     # noqa: E402
+
+COMMENT_MARKER = 0xFF
+COMMENT_MAX_LENGTH = 128
+COMMENT_PLAIN_EVERY = 6
+
+TNC2_LINE = re.compile(r"^(?:.*?\s)?([A-Z0-9-]{1,9}>[^:\s]+):(.*)$")
+TELEMETRY = re.compile(r"\|[!-{]{4,14}\|$")
+EXTENSION = re.compile(r"^(\d{3}/\d{3}|PHG\d{4}|RNG\d{4}|DFS\d{4})")
+
+
+def load_dictionary(path):
+    with open(path, encoding="utf-8") as source:
+        text = source.read()
+    table = re.search(r"commentDictionary\[\]\s*=\s*\{(.*?)\};", text, re.S)
+    if not table:
+        sys.exit("no commentDictionary in %s" % path)
+    entries = [bytes(entry, "ascii").decode("unicode_escape").encode("latin-1")
+               for entry in re.findall(r'"((?:[^"\\]|\\.)*)"', table.group(1))]
+    if len(entries) > 127:
+        sys.exit("dictionary has %d entries, tokens 0x80..0xFE hold 127" % len(entries))
+    return entries
+
+
+def compress(text, dictionary):
+    """Same shortest-path encoding as COMMENT_Utils::compress(), None when it does not pay off."""
+    length = len(text)
+    if length == 0 or length > COMMENT_MAX_LENGTH:
+        return None
+    cost = [0] * (length + 1)
+    choice = [-1] * length
+    for i in range(length - 1, -1, -1):
+        cost[i] = cost[i + 1] + (2 if text[i] & 0x80 else 1)
+        for k, entry in enumerate(dictionary):
+            if text.startswith(entry, i) and 1 + cost[i + len(entry)] < cost[i]:
+                cost[i] = 1 + cost[i + len(entry)]
+                choice[i] = k
+    if 1 + cost[0] >= length:
+        return None
+    data = bytearray([COMMENT_MARKER])
+    i = 0
+    while i < length:
+        if choice[i] >= 0:
+            data.append(0x80 + choice[i])
+            i += len(dictionary[choice[i]])
+        else:
+            if text[i] & 0x80:
+                data.append(COMMENT_MARKER)
+            data.append(text[i])
+            i += 1
+    return bytes(data)
+
+
+def expand(data, dictionary):
+    text = bytearray()
+    i = 1
+    while i < len(data):
+        if data[i] == COMMENT_MARKER:
+            i += 1
+            text.append(data[i])
+        elif data[i] & 0x80:
+            text += dictionary[data[i] - 0x80]
+        else:
+            text.append(data[i])
+        i += 1
+    return bytes(text)
+
+
+def comment_of(payload):
+    """Comment of a TNC2 information field, None for frames that do not carry one."""
+    if not payload:
+        return None
+    kind, body = payload[0], payload[1:]
+    if kind in "@/":
+        body = body[7:]
+        kind = "!"
+    if kind in "!=":
+        if body[:1].isdigit():
+            comment = EXTENSION.sub("", body[19:], count=1)
+        else:
+            comment = body[13:]
+    elif kind in "`'":
+        comment = body[8:]
+    elif kind == ">":
+        comment = body
+    else:
+        return None
+    return TELEMETRY.sub("", comment)
+
+
+def read_corpus(paths, tnc2):
+    for path in paths:
+        corpus = sys.stdin if path == "-" else open(path, encoding="utf-8", errors="replace")
+        with corpus:
+            for line in corpus:
+                line = line.rstrip("\r\n")
+                if tnc2:
+                    match = TNC2_LINE.match(line)
+                    line = comment_of(match.group(2)) if match else None
+                if line:
+                    yield line.encode("utf-8")
+
+
+def suggest(comments, dictionary, count):
+    """Greedy candidates: the 3..12 byte substring saving most bytes, taken out of the corpus, then the next one."""
+    texts = list(comments)
+    picked = []
+    while len(picked) < count:
+        grams = collections.Counter()
+        for text in texts:
+            for size in range(3, 13):
+                for i in range(len(text) - size + 1):
+                    gram = text[i:i + size]
+                    if 0 not in gram and gram not in dictionary:
+                        grams[gram] += 1
+        if not grams:
+            break
+        gram, occurrences = max(grams.items(), key=lambda item: item[1] * (len(item[0]) - 1))
+        if occurrences < 2:
+            break
+        picked.append((gram, occurrences))
+        texts = [text.replace(gram, b"\0") for text in texts]
+    return picked
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("corpus", nargs="*", default=["-"], help="files, - for stdin")
+    parser.add_argument("--tnc2", action="store_true", help="the corpus is raw packets, not comments")
+    parser.add_argument("--source", default=os.path.join(root, "src", "comment_utils.cpp"))
+    parser.add_argument("--config", default=os.path.join(root, "data", "tracker_conf.json"))
+    parser.add_argument("--profile", type=int, default=0, help="index into the lora array of the config")
+    parser.add_argument("--frame-bytes", type=int, default=40, help="rest of the beacon around the comment")
+    parser.add_argument("--suggest", type=int, default=0, help="list this many candidate dictionary entries")
+    args = parser.parse_args()
+
+    dictionary = load_dictionary(args.source)
+    with open(args.config, encoding="utf-8") as config_file:
+        profile = json.load(config_file)["lora"][args.profile]
+    sf, bw, cr = profile["spreadingFactor"], profile["signalBandwidth"], profile["codingRate4"]
+
+    comments = list(read_corpus(args.corpus, args.tnc2))
+    if not comments:
+        sys.exit("empty corpus")
+
+    plain_bytes = sent_bytes = compressed = 0
+    plain_airtime = sent_airtime = 0.0
+    for text in comments:
+        data = compress(text, dictionary)
+        if data is not None:
+            if expand(data, dictionary) != text:
+                sys.exit("round trip failed: %r" % text)
+            compressed += 1
+        length = len(data) if data is not None else len(text)
+        plain_bytes += len(text)
+        sent_bytes += length
+        plain_airtime += time_on_air(args.frame_bytes + len(text), sf, bw, cr)
+        sent_airtime += time_on_air(args.frame_bytes + length, sf, bw, cr)
+
+    count = len(comments)
+    ratio = sent_bytes / plain_bytes
+    share = (COMMENT_PLAIN_EVERY - 1) / COMMENT_PLAIN_EVERY     # the others go out plain for stock receivers
+    saved = (plain_airtime - sent_airtime) / count * 1000
+    print("dictionary        %d entries" % len(dictionary))
+    print("comments          %d, %d compressible (%.1f%%)" % (count, compressed, 100 * compressed / count))
+    print("bytes             %d -> %d, ratio %.3f, %.1f saved per comment" % (
+        plain_bytes, sent_bytes, ratio, (plain_bytes - sent_bytes) / count))
+    print("airtime SF%d      %.0f ms saved per comment, %.0f ms with 1 in %d sent plain" % (
+        sf, saved, saved * share, COMMENT_PLAIN_EVERY))
+    print("                  beacon of %d + comment bytes, %.0f ms mean plain" % (
+        args.frame_bytes, plain_airtime / count * 1000))
+
+    if args.suggest:
+        print("\ncandidate entries (occurrences x bytes saved):")
+        for gram, occurrences in suggest(comments, set(dictionary), args.suggest):
+            print("  %-16r %6d" % (gram.decode("utf-8", "replace"), occurrences * (len(gram) - 1)))
+
+
+if __name__ == "__main__":
+    main()
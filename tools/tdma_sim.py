@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Collision rate of N trackers beaconing on free-running SmartBeacon timers versus GPS-slotted TDMA.
+
+Mirrors src/tdma_utils.cpp: slot = FNV-1a(callsign) % (frameLength / slotLength), a pending beacon goes out
+when the UTC clock enters the owned slot (within TDMA_TX_WINDOW). A frame is lost when it overlaps any other
+frame on the channel (no capture effect).
+
+    python3 tools/tdma_sim.py --trackers 4 8 12 24 --hours 6
+
+Hashed slots only pay off while the fleet is well below the slot count (birthday collisions); beyond that
+assign slot IDs in tracker_conf.json ("tdma": {"slot": n}).
+"""
+
+import argparse
+import math
+import random
+
+TDMA_TX_WINDOW = 0.5
+
+
+def fnv1a(text):
+    value = 2166136261
+    for c in text.encode():
+        value ^= c
+        value = (value * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def time_on_air(length, sf=12, bw=125000, cr=5, preamble=8):
+    """Semtech AN1200.13 LoRa time on air, explicit header, CRC on."""
+    tsym = (2 ** sf) / bw
+    de = 1 if sf >= 11 and bw == 125000 else 0
+    payload = 8 + max(math.ceil((8 * length - 4 * sf + 28 + 16) / (4 * (sf - 2 * de))) * cr, 0)
+    return (preamble + 4.25) * tsym + payload * tsym
+
+
+def beacon_times(rng, hours, slow, fast):
+    """SmartBeacon-like intervals: each tracker drifts between the fast and slow rate with its speed."""
+    t = rng.uniform(0, slow)
+    end = hours * 3600
+    while t < end:
+        yield t
+        t += rng.uniform(fast, slow) + rng.uniform(0, 1)    # GPS update and loop latency
+
+
+def simulate(trackers, hours, slotted, assigned, frame_length, slot_length, sync_error, airtime, seed):
+    rng = random.Random(seed)
+    slots = max(1, frame_length // slot_length)
+    transmissions = []
+    for n in range(trackers):
+        callsign = "SQ%dTRK-%d" % (n % 10, 7 + n // 10)
+        slot = n % slots if assigned else fnv1a(callsign) % slots
+        clock_error = rng.uniform(-sync_error, sync_error)
+        last_end = -1.0
+        for t in beacon_times(rng, hours, 120, 60):
+            if slotted:
+                # Quantize the trigger to the start of our next slot, seen through this tracker's clock error
+                slot_start = slot * slot_length
+                frame_start = math.floor((t - slot_start) / frame_length) * frame_length + slot_start
+                if t - frame_start > TDMA_TX_WINDOW:
+                    frame_start += frame_length
+                t = max(frame_start, t) + clock_error
+            if t < last_end:
+                continue                                    # still waiting for the previous slot
+            transmissions.append((t, t + airtime, n))
+            last_end = t + airtime
+    transmissions.sort()
+    collided = set()
+    for i, (start, end, _) in enumerate(transmissions):
+        j = i + 1
+        while j < len(transmissions) and transmissions[j][0] < end:
+            collided.add(i)
+            collided.add(j)
+            j += 1
+    return len(transmissions), len(collided)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--trackers", type=int, nargs="+", default=[4, 8, 12, 24])
+    parser.add_argument("--hours", type=float, default=6)
+    parser.add_argument("--frame-length", type=int, default=60)
+    parser.add_argument("--slot-length", type=int, default=5)
+    parser.add_argument("--sync-error", type=float, default=0.3, help="max GPS/NMEA clock error in seconds")
+    parser.add_argument("--length", type=int, default=60, help="frame length in bytes")
+    parser.add_argument("--sf", type=int, default=12)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    airtime = time_on_air(args.length + 3, args.sf)
+    print("airtime %.2f s, %d slots of %d s" % (airtime, args.frame_length // args.slot_length, args.slot_length))
+    if airtime + TDMA_TX_WINDOW + 2 * args.sync_error > args.slot_length:
+        print("warning: slot shorter than airtime plus window and sync error")
+    print("collision rate  free: independent timers  hashed: slot from callsign  assigned: configured slot IDs")
+    print("%8s %10s %10s %10s" % ("trackers", "free", "hashed", "assigned"))
+    for trackers in args.trackers:
+        rates = []
+        for slotted, assigned in ((False, False), (True, False), (True, True)):
+            sent, lost = simulate(trackers, args.hours, slotted, assigned, args.frame_length, args.slot_length, args.sync_error, airtime, args.seed)
+            rates.append(100 * lost / sent if sent else 0)
+        print("%8d %9.1f%% %9.1f%% %9.1f%%" % (trackers, rates[0], rates[1], rates[2]))
+
+
+if __name__ == "__main__":
+    main()